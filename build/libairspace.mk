@@ -3,6 +3,7 @@ AIRSPACE_SRC_DIR = $(SRC)/Engine/Airspace
 AIRSPACE_SOURCES = \
 	$(ENGINE_SRC_DIR)/Util/AircraftStateFilter.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspacesTerrain.cpp \
+	$(AIRSPACE_SRC_DIR)/AirspacesParallel.cpp \
 	$(AIRSPACE_SRC_DIR)/Airspace.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceAltitude.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceAircraftPerformance.cpp \
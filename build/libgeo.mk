@@ -22,6 +22,7 @@ GEO_SOURCES := \
 	$(GEO_SRC_DIR)/GeoVector.cpp \
 	$(GEO_SRC_DIR)/GeoBounds.cpp \
 	$(GEO_SRC_DIR)/GeoClip.cpp \
+	$(GEO_SRC_DIR)/EdgeBandIndex.cpp \
 	$(GEO_SRC_DIR)/SearchPoint.cpp \
 	$(GEO_SRC_DIR)/SearchPointVector.cpp \
 	$(GEO_SRC_DIR)/GeoEllipse.cpp \
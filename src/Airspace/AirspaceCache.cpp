@@ -0,0 +1,224 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+
+#include <vector>
+
+#include <assert.h>
+#include <string.h>
+#include <tchar.h>
+
+struct AirspaceCacheHeader {
+  enum {
+#ifdef FIXED_MATH
+    VERSION = 0x1,
+#else
+    VERSION = 0x2,
+#endif
+  };
+
+  unsigned version;
+  unsigned n_airspaces;
+};
+
+/**
+ * The fixed-size part of one airspace.  It is followed by the name,
+ * the radio frequency and (for polygons) the border.
+ */
+struct AirspaceCacheRecord {
+  AbstractAirspace::Shape shape;
+  AirspaceClass type;
+  AirspaceActivity days;
+  AirspaceAltitude base, top;
+
+  /** only used for circles */
+  GeoPoint center;
+  fixed radius;
+
+  unsigned name_length, radio_length;
+
+  /** the number of border vertices; only used for polygons */
+  unsigned n_points;
+
+  /** only used for polygons */
+  bool is_convex;
+};
+
+/* sanity limits for validating the cache file */
+static constexpr unsigned MAX_AIRSPACES = 1024 * 1024;
+static constexpr unsigned MAX_STRING_LENGTH = 1024;
+static constexpr unsigned MAX_POINTS = 1024 * 1024;
+
+static bool
+WriteString(FILE *file, const TCHAR *value, unsigned length)
+{
+  return fwrite(value, sizeof(*value), length, file) == length;
+}
+
+static bool
+ReadString(FILE *file, tstring &value, unsigned length)
+{
+  value.resize(length);
+  return length == 0 ||
+    fread(&value[0], sizeof(value[0]), length, file) == length;
+}
+
+static bool
+SaveAirspace(FILE *file, const AbstractAirspace &airspace)
+{
+  const tstring radio = airspace.GetRadioText();
+
+  AirspaceCacheRecord record;
+
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset((void *)&record, 0, sizeof(record));
+
+  record.shape = airspace.GetShape();
+  record.type = airspace.GetType();
+  record.days = airspace.GetDays();
+  record.base = airspace.GetBase();
+  record.top = airspace.GetTop();
+  record.name_length = _tcslen(airspace.GetName());
+  record.radio_length = radio.length();
+
+  std::vector<GeoPoint> points;
+  if (record.shape == AbstractAirspace::Shape::CIRCLE) {
+    const AirspaceCircle &circle = (const AirspaceCircle &)airspace;
+    record.center = circle.GetCenter();
+    record.radius = circle.GetRadius();
+  } else {
+    const SearchPointVector &border = airspace.GetPoints();
+    points.reserve(border.size());
+    for (const SearchPoint &p : border)
+      points.push_back(p.GetLocation());
+    record.n_points = points.size();
+    record.is_convex = airspace.IsConvex();
+  }
+
+  return fwrite(&record, sizeof(record), 1, file) == 1 &&
+    WriteString(file, airspace.GetName(), record.name_length) &&
+    WriteString(file, radio.c_str(), record.radio_length) &&
+    fwrite(points.data(), sizeof(points[0]), points.size(),
+           file) == points.size();
+}
+
+static AbstractAirspace *
+LoadAirspace(FILE *file, tstring &name, tstring &radio,
+             std::vector<GeoPoint> &points)
+{
+  AirspaceCacheRecord record;
+  if (fread(&record, sizeof(record), 1, file) != 1 ||
+      record.name_length > MAX_STRING_LENGTH ||
+      record.radio_length > MAX_STRING_LENGTH ||
+      record.n_points > MAX_POINTS ||
+      record.type >= AIRSPACECLASSCOUNT ||
+      !ReadString(file, name, record.name_length) ||
+      !ReadString(file, radio, record.radio_length))
+    return nullptr;
+
+  AbstractAirspace *airspace;
+  switch (record.shape) {
+  case AbstractAirspace::Shape::CIRCLE:
+    airspace = new AirspaceCircle(record.center, record.radius);
+    break;
+
+  case AbstractAirspace::Shape::POLYGON:
+    points.resize(record.n_points);
+    if (fread(points.data(), sizeof(points[0]), points.size(),
+              file) != points.size())
+      return nullptr;
+
+    airspace = new AirspacePolygon(ConstBuffer<GeoPoint>(points.data(),
+                                                         points.size()),
+                                   record.is_convex);
+    break;
+
+  default:
+    return nullptr;
+  }
+
+  airspace->SetProperties(name, record.type, record.base, record.top);
+  airspace->SetRadio(radio);
+  airspace->SetDays(record.days);
+  return airspace;
+}
+
+bool
+SaveAirspaceCache(FILE *file, const Airspaces &airspaces,
+                  unsigned first_pending)
+{
+  const auto &pending = airspaces.GetPending();
+  assert(first_pending <= pending.size());
+
+  AirspaceCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.version = AirspaceCacheHeader::VERSION;
+  header.n_airspaces = pending.size() - first_pending;
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1)
+    return false;
+
+  for (auto i = pending.begin() + first_pending; i != pending.end(); ++i)
+    if (!SaveAirspace(file, **i))
+      return false;
+
+  return true;
+}
+
+bool
+LoadAirspaceCache(FILE *file, Airspaces &airspaces)
+{
+  AirspaceCacheHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      header.version != AirspaceCacheHeader::VERSION ||
+      header.n_airspaces > MAX_AIRSPACES)
+    return false;
+
+  /* load everything before adding anything to the Airspaces object,
+     so a truncated file does not leave a partial airspace set
+     behind */
+  std::vector<AbstractAirspace *> loaded;
+  loaded.reserve(header.n_airspaces);
+
+  tstring name, radio;
+  std::vector<GeoPoint> points;
+  for (unsigned i = 0; i < header.n_airspaces; ++i) {
+    AbstractAirspace *airspace = LoadAirspace(file, name, radio, points);
+    if (airspace == nullptr) {
+      for (AbstractAirspace *as : loaded)
+        delete as;
+      return false;
+    }
+
+    loaded.push_back(airspace);
+  }
+
+  for (AbstractAirspace *as : loaded)
+    airspaces.Add(as);
+
+  return true;
+}
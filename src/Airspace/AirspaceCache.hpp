@@ -0,0 +1,55 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_CACHE_HPP
+#define XCSOAR_AIRSPACE_CACHE_HPP
+
+#include <stdio.h>
+
+class Airspaces;
+
+/**
+ * Write the airspaces which were added to the #Airspaces object after
+ * the first #first_pending ones (since the last Optimise() call) to a
+ * binary cache file, e.g. one opened with FileCache::Save().
+ *
+ * This must be called before SetFlightLevels() and SetGroundLevels(),
+ * because the altitudes are stored as they were parsed.
+ *
+ * @return true on success
+ */
+bool
+SaveAirspaceCache(FILE *file, const Airspaces &airspaces,
+                  unsigned first_pending=0);
+
+/**
+ * Load airspaces from a binary cache file written by
+ * SaveAirspaceCache(), and add them to the #Airspaces object.  Nothing
+ * is added if the file is malformed or has an incompatible version.
+ *
+ * @return true on success
+ */
+bool
+LoadAirspaceCache(FILE *file, Airspaces &airspaces);
+
+#endif
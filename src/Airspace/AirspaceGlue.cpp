@@ -23,13 +23,16 @@ Copyright_License {
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Profile/ProfileKeys.hpp"
 #include "Operation/Operation.hpp"
 #include "Language/Language.hpp"
 #include "LogFile.hpp"
 #include "IO/TextFile.hpp"
+#include "IO/FileCache.hpp"
 #include "Profile/Profile.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #include <windef.h> /* for MAX_PATH */
 #include <memory>
@@ -52,9 +55,52 @@ ParseAirspaceFile(AirspaceParser &parser, const TCHAR *path,
   return true;
 }
 
+/**
+ * Load the airspace file from the cache, or parse it and save the
+ * result in the cache.
+ *
+ * @param source_path the file which the cache entry is validated
+ * against (path, size and modification time); differs from #path if
+ * the airspace file is inside an archive
+ */
+static bool
+LoadAirspaceFile(Airspaces &airspaces, AirspaceParser &parser,
+                 FileCache *cache, const TCHAR *cache_name,
+                 const TCHAR *path, const TCHAR *source_path,
+                 OperationEnvironment &operation)
+{
+  if (cache == nullptr)
+    return ParseAirspaceFile(parser, path, operation);
+
+  FILE *file = cache->Load(cache_name, source_path);
+  if (file != nullptr) {
+    const bool loaded = LoadAirspaceCache(file, airspaces);
+    fclose(file);
+    if (loaded)
+      return true;
+
+    cache->Flush(cache_name);
+  }
+
+  const unsigned first_pending = airspaces.GetPending().size();
+  if (!ParseAirspaceFile(parser, path, operation))
+    return false;
+
+  file = cache->Save(cache_name, source_path);
+  if (file != nullptr) {
+    if (SaveAirspaceCache(file, airspaces, first_pending))
+      cache->Commit(cache_name, file);
+    else
+      cache->Cancel(cache_name, file);
+  }
+
+  return true;
+}
+
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
+             FileCache *cache,
              const AtmosphericPressure &press,
              OperationEnvironment &operation)
 {
@@ -63,23 +109,34 @@ ReadAirspace(Airspaces &airspaces,
 
   bool airspace_ok = false;
 
+  WorkerPool worker_pool(WorkerPool::GetDefaultThreadCount());
+
   AirspaceParser parser(airspaces);
+  parser.SetWorkerPool(&worker_pool);
 
   // Read the airspace filenames from the registry
   TCHAR path[MAX_PATH];
   if (Profile::GetPath(ProfileKeys::AirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(airspaces, parser, cache,
+                                    _T("airspace"), path, path, operation);
 
   if (Profile::GetPath(ProfileKeys::AdditionalAirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(airspaces, parser, cache,
+                                    _T("airspace2"), path, path, operation);
 
   if (Profile::GetPath(ProfileKeys::MapFile, path)) {
+    /* the airspace file is inside the map archive; the cache entry
+       is keyed on the map file itself */
+    TCHAR map_path[MAX_PATH];
+    _tcscpy(map_path, path);
     _tcscat(path, _T("/airspace.txt"));
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(airspaces, parser, cache,
+                                    _T("airspace-map"), path, map_path,
+                                    operation);
   }
 
   if (airspace_ok) {
-    airspaces.Optimise();
+    airspaces.Optimise(worker_pool);
     airspaces.SetFlightLevels(press);
 
     if (terrain != NULL)
@@ -25,16 +25,22 @@ Copyright_License {
 #define XCSOAR_AIRSPACE_GLUE_HPP
 
 class RasterTerrain;
+class FileCache;
 class AtmosphericPressure;
 class Airspaces;
 class OperationEnvironment;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, then parsed airspace files are stored
+ * in this cache, and loaded from it as long as the source file is
+ * unchanged
  */
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
+             FileCache *cache,
              const AtmosphericPressure &press,
              OperationEnvironment &operation);
 
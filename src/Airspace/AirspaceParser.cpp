@@ -38,6 +38,10 @@ Copyright_License {
 #include "Geo/GeoVector.hpp"
 #include "Engine/Airspace/AirspaceClass.hpp"
 #include "Util/StaticString.hpp"
+#include "Thread/WorkerPool.hpp"
+
+#include <vector>
+#include <algorithm>
 
 #include <tchar.h>
 #include <stdio.h>
@@ -112,6 +116,8 @@ static constexpr AirspaceClassStringCouple airspace_tnp_type_strings[] = {
   { _T("RMZ"), RMZ },
 };
 
+typedef std::vector<AbstractAirspace *> AirspaceList;
+
 // this can now be called multiple times to load several airspaces.
 
 struct TempAirspaceType
@@ -164,23 +170,23 @@ struct TempAirspaceType
   }
 
   void
-  AddPolygon(Airspaces &airspace_database)
+  AddPolygon(AirspaceList &airspace_list)
   {
     AbstractAirspace *as = new AirspacePolygon(points);
     as->SetProperties(name, type, base, top);
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
-    airspace_database.Add(as);
+    airspace_list.push_back(as);
   }
 
   void
-  AddCircle(Airspaces &airspace_database)
+  AddCircle(AirspaceList &airspace_list)
   {
     AbstractAirspace *as = new AirspaceCircle(center, radius);
     as->SetProperties(name, type, base, top);
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
-    airspace_database.Add(as);
+    airspace_list.push_back(as);
   }
 
   static int
@@ -539,7 +545,7 @@ SkipSpaces(const TCHAR *p)
 }
 
 static bool
-ParseLine(Airspaces &airspace_database, TCHAR *line,
+ParseLine(AirspaceList &airspace_list, TCHAR *line,
           TempAirspaceType &temp_area)
 {
   const TCHAR *value;
@@ -573,7 +579,7 @@ ParseLine(Airspaces &airspace_database, TCHAR *line,
     case _T('c'):
       temp_area.radius = Units::ToSysUnit(fixed(ParseDouble(&line[2])),
                                           Unit::NAUTICAL_MILES);
-      temp_area.AddCircle(airspace_database);
+      temp_area.AddCircle(airspace_list);
       temp_area.Reset();
       break;
 
@@ -614,7 +620,7 @@ ParseLine(Airspaces &airspace_database, TCHAR *line,
         break;
 
       if (!temp_area.points.empty())
-        temp_area.AddPolygon(airspace_database);
+        temp_area.AddPolygon(airspace_list);
 
       temp_area.Reset();
 
@@ -788,7 +794,7 @@ ParseCircleTNP(const TCHAR *buffer, TempAirspaceType &temp_area)
 }
 
 static bool
-ParseLineTNP(Airspaces &airspace_database, TCHAR *line,
+ParseLineTNP(AirspaceList &airspace_list, TCHAR *line,
              TempAirspaceType &temp_area, bool &ignore)
 {
   // Strip comments
@@ -820,7 +826,7 @@ ParseLineTNP(Airspaces &airspace_database, TCHAR *line,
     if (!ParseCircleTNP(parameter, temp_area))
       return false;
 
-    temp_area.AddCircle(airspace_database);
+    temp_area.AddCircle(airspace_list);
     temp_area.ResetTNP();
   } else if ((parameter =
       StringAfterPrefixCI(line, _T("CLOCKWISE "))) != NULL) {
@@ -834,14 +840,14 @@ ParseLineTNP(Airspaces &airspace_database, TCHAR *line,
       return false;
   } else if ((parameter = StringAfterPrefixCI(line, _T("TITLE="))) != NULL) {
     if (!temp_area.points.empty())
-      temp_area.AddPolygon(airspace_database);
+      temp_area.AddPolygon(airspace_list);
 
     temp_area.ResetTNP();
 
     temp_area.name = parameter;
   } else if ((parameter = StringAfterPrefixCI(line, _T("TYPE="))) != NULL) {
     if (!temp_area.points.empty())
-      temp_area.AddPolygon(airspace_database);
+      temp_area.AddPolygon(airspace_list);
 
     temp_area.ResetTNP();
 
@@ -881,6 +887,176 @@ DetectFileType(const TCHAR *line)
   return AFT_UNKNOWN;
 }
 
+static void
+AddAirspaces(Airspaces &airspaces, AirspaceList &list)
+{
+  for (AbstractAirspace *as : list)
+    airspaces.Add(as);
+
+  list.clear();
+}
+
+/**
+ * Does this OpenAir line start a new airspace?  These are the "AC"
+ * records which make ParseLine() reset its state.
+ */
+gcc_pure
+static bool
+IsOpenAirStart(const TCHAR *line)
+{
+  return (line[0] == _T('A') || line[0] == _T('a')) &&
+    (line[1] == _T('C') || line[1] == _T('c')) &&
+    ValueAfterSpace(line + 2) != NULL;
+}
+
+struct OpenAirLine {
+  unsigned number;
+  tstring text;
+
+  OpenAirLine(unsigned _number, const TCHAR *_text)
+    :number(_number), text(_text) {}
+};
+
+/**
+ * A range of OpenAir lines which describes one airspace.  It can be
+ * parsed independently of all other blocks.
+ */
+struct OpenAirBlock {
+  unsigned begin, end;
+
+  /**
+   * The name and altitudes which were set before this block.
+   * TempAirspaceType::Reset() does not clear them, therefore they
+   * are inherited by airspaces which do not specify their own.
+   */
+  tstring name;
+  AirspaceAltitude base, top;
+
+  AirspaceList result;
+
+  /**
+   * The index of the line which failed to parse, or #end.
+   */
+  unsigned error;
+};
+
+static void
+ParseOpenAirBlock(std::vector<OpenAirLine> &lines, OpenAirBlock &block,
+                  TempAirspaceType &temp_area)
+{
+  temp_area.Reset();
+  temp_area.name = block.name;
+  temp_area.base = block.base;
+  temp_area.top = block.top;
+
+  for (unsigned i = block.begin; i < block.end; ++i) {
+    if (!ParseLine(block.result, &lines[i].text[0], temp_area)) {
+      block.error = i;
+      return;
+    }
+  }
+
+  if (!temp_area.points.empty())
+    temp_area.AddPolygon(block.result);
+}
+
+/**
+ * Parse the OpenAir file which has been read into memory.  The file
+ * is split into airspace blocks, which are parsed in parallel and
+ * then added to #airspaces in file order.
+ */
+static bool
+ParseOpenAir(std::vector<OpenAirLine> &lines, Airspaces &airspaces,
+             WorkerPool &pool, OperationEnvironment &operation)
+{
+  std::vector<OpenAirBlock> blocks;
+
+  /* find the block boundaries, and keep track of the state which is
+     passed from one block to the next */
+  TempAirspaceType state;
+  for (unsigned i = 0, n = lines.size(); i < n; ++i) {
+    TCHAR *line = &lines[i].text[0];
+
+    TCHAR *comment = _tcschr(line, _T('*'));
+    if (comment != NULL)
+      *comment = _T('\0');
+
+    if (blocks.empty() || IsOpenAirStart(line)) {
+      if (!blocks.empty())
+        blocks.back().end = i;
+
+      blocks.emplace_back();
+      OpenAirBlock &block = blocks.back();
+      block.begin = i;
+      block.name = state.name;
+      block.base = state.base;
+      block.top = state.top;
+    }
+
+    if ((line[0] != _T('A') && line[0] != _T('a')) || line[1] == _T('\0'))
+      continue;
+
+    const TCHAR *value = ValueAfterSpace(line + 2);
+    if (value == NULL)
+      continue;
+
+    switch (line[1]) {
+    case _T('N'):
+    case _T('n'):
+      state.name = value;
+      break;
+
+    case _T('L'):
+    case _T('l'):
+      ReadAltitude(value, state.base);
+      break;
+
+    case _T('H'):
+    case _T('h'):
+      ReadAltitude(value, state.top);
+      break;
+    }
+  }
+
+  if (blocks.empty())
+    return true;
+
+  blocks.back().end = lines.size();
+  for (auto &block : blocks)
+    block.error = block.end;
+
+  static constexpr unsigned CHUNK_SIZE = 32;
+  const unsigned n_blocks = blocks.size();
+  const unsigned n_chunks = (n_blocks + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  pool.Run(n_chunks, [&lines, &blocks, n_blocks](unsigned chunk) {
+      TempAirspaceType temp_area;
+      const unsigned end = std::min(n_blocks,
+                                    (chunk + 1) * unsigned(CHUNK_SIZE));
+      for (unsigned i = chunk * CHUNK_SIZE; i < end; ++i)
+        ParseOpenAirBlock(lines, blocks[i], temp_area);
+    });
+
+  /* merge the results in file order; stop at the first error, just
+     like the sequential parser does */
+  bool success = true;
+  for (auto &block : blocks) {
+    if (!success) {
+      for (AbstractAirspace *as : block.result)
+        delete as;
+      continue;
+    }
+
+    AddAirspaces(airspaces, block.result);
+
+    if (block.error != block.end) {
+      const OpenAirLine &line = lines[block.error];
+      success = ShowParseWarning(line.number, line.text.c_str(), operation);
+    }
+  }
+
+  return success;
+}
+
 bool
 AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
 {
@@ -893,6 +1069,15 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
 
   TempAirspaceType temp_area;
   AirspaceFileType filetype = AFT_UNKNOWN;
+  AirspaceList airspace_list;
+
+  /* buffering the file only pays off if there are threads which can
+     share the work */
+  WorkerPool *const pool = worker_pool != nullptr &&
+    worker_pool->GetThreadCount() > 0
+    ? worker_pool
+    : nullptr;
+  std::vector<OpenAirLine> openair_lines;
 
   TCHAR *line;
 
@@ -909,15 +1094,23 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
     }
 
     // Parse the line
-    if (filetype == AFT_OPENAIR)
-      if (!ParseLine(airspaces, line, temp_area) &&
-          !ShowParseWarning(line_num, line, operation))
+    if (filetype == AFT_OPENAIR) {
+      if (pool != nullptr)
+        /* parse later, in parallel */
+        openair_lines.emplace_back(line_num, line);
+      else if (!ParseLine(airspace_list, line, temp_area) &&
+               !ShowParseWarning(line_num, line, operation)) {
+        AddAirspaces(airspaces, airspace_list);
         return false;
+      }
+    }
 
     if (filetype == AFT_TNP)
-      if (!ParseLineTNP(airspaces, line, temp_area, ignore) &&
-          !ShowParseWarning(line_num, line, operation))
+      if (!ParseLineTNP(airspace_list, line, temp_area, ignore) &&
+          !ShowParseWarning(line_num, line, operation)) {
+        AddAirspaces(airspaces, airspace_list);
         return false;
+      }
 
     // Update the ProgressDialog
     if ((line_num & 0xff) == 0)
@@ -929,9 +1122,13 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
     return false;
   }
 
+  if (pool != nullptr && filetype == AFT_OPENAIR)
+    return ParseOpenAir(openair_lines, airspaces, *pool, operation);
+
   // Process final area (if any)
   if (!temp_area.points.empty())
-    temp_area.AddPolygon(airspaces);
+    temp_area.AddPolygon(airspace_list);
 
+  AddAirspaces(airspaces, airspace_list);
   return true;
 }
@@ -27,13 +27,33 @@ Copyright_License {
 class Airspaces;
 class TLineReader;
 class OperationEnvironment;
+class WorkerPool;
 
 class AirspaceParser
 {
   Airspaces &airspaces;
 
+  /**
+   * If set, the airspaces of OpenAir files are parsed in parallel on
+   * this pool.
+   */
+  WorkerPool *worker_pool;
+
 public:
-  AirspaceParser(Airspaces &_airspaces): airspaces(_airspaces) {}
+  AirspaceParser(Airspaces &_airspaces)
+    :airspaces(_airspaces), worker_pool(nullptr) {}
+
+  /**
+   * Parse OpenAir files in parallel on the given #WorkerPool.  The
+   * file is read into memory first and then split into airspace
+   * blocks, which are parsed independently and added in file order.
+   * Pass nullptr to parse sequentially (the default).
+   *
+   * The pool must remain valid while Parse() is running.
+   */
+  void SetWorkerPool(WorkerPool *_worker_pool) {
+    worker_pool = _worker_pool;
+  }
 
   bool Parse(TLineReader &reader, OperationEnvironment &operation);
 };
@@ -75,6 +75,7 @@ Copyright_License {
 #define gcc_visibility_default __attribute__((visibility("default")))
 
 #define gcc_always_inline __attribute__((always_inline))
+#define gcc_noinline __attribute__((noinline))
 
 #else /* ! GCC_VERSION >= 30000 */
 
@@ -104,6 +105,7 @@ Copyright_License {
 #define gcc_visibility_default
 
 #define gcc_always_inline inline
+#define gcc_noinline
 
 #endif /* ! GCC_VERSION >= 30000 */
 
@@ -24,12 +24,16 @@ Copyright_License {
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
 
+#include <algorithm>
+
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
                                  const Trace &trace_sprint)
-  :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
+  :worker_pool(std::min(WorkerPool::GetDefaultThreadCount(), 1u)),
+   contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+  contest_manager.SetWorkerPool(&worker_pool);
 }
 
 void
@@ -25,12 +25,20 @@ Copyright_License {
 #define XCSOAR_CONTEST_COMPUTER_HPP
 
 #include "Engine/Contest/ContestManager.hpp"
+#include "Thread/WorkerPool.hpp"
 
 struct ContestSettings;
 struct ContestStatistics;
 class Trace;
 
 class ContestComputer {
+  /**
+   * Runs independent contest solvers in parallel on multi-core
+   * machines.  A contest has at most two independent solvers, and the
+   * calculation thread runs one of them itself.
+   */
+  WorkerPool worker_pool;
+
   ContestManager contest_manager;
 
 public:
@@ -43,7 +43,8 @@ GlideComputer::GlideComputer(const Waypoints &_way_points,
   task_computer(task, _airspace_database, &warning_computer.GetManager()),
   waypoints(_way_points),
   retrospective(_way_points),
-  team_code_ref_id(-1)
+  team_code_ref_id(-1),
+  profiler(nullptr)
 {
   events.SetComputer(*this);
   idle_clock.Update();
@@ -175,8 +176,12 @@ GlideComputer::ProcessIdle(bool exhaustive)
   task_computer.ProcessIdle(basic, calculated, GetComputerSettings(),
                             exhaustive);
 
-  warning_computer.Update(GetComputerSettings(), basic,
-                          calculated, calculated.airspace_warnings);
+  {
+    ComputerProfiler::Scope scope(profiler,
+                                  ComputerProfiler::Section::WARNINGS);
+    warning_computer.Update(GetComputerSettings(), basic,
+                            calculated, calculated.airspace_warnings);
+  }
 
   // Calculate summary of flight
   if (basic.location_available)
@@ -63,6 +63,8 @@ class GlideComputer : public GlideComputerBlackboard
   GeoPoint team_code_ref_location;
 
   PeriodClock idle_clock;
+
+  ComputerProfiler *profiler;
   VegaVoice vegavoice;
 
   /**
@@ -83,6 +85,17 @@ public:
     log_computer.SetLogger(logger);
   }
 
+  /**
+   * Attach a profiler which gets notified about the expensive
+   * sections of ProcessGPS() and ProcessIdle().  Pass nullptr to
+   * detach it.
+   */
+  void SetProfiler(ComputerProfiler *_profiler) {
+    profiler = _profiler;
+    air_data_computer.SetProfiler(_profiler);
+    task_computer.SetProfiler(_profiler);
+  }
+
   void ResetFlight(const bool full=true);
   void Initialise();
 
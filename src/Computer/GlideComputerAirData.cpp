@@ -36,7 +36,7 @@ static constexpr fixed THERMAL_TIME_MIN(45);
 
 GlideComputerAirData::GlideComputerAirData(const Waypoints &_way_points)
   :waypoints(_way_points),
-   terrain(NULL)
+   terrain(NULL), profiler(nullptr)
 {
   // JMW TODO enhancement: seed initial wind store with start conditions
   // SetWindEstimate(Calculated().WindSpeed, Calculated().WindBearing, 1);
@@ -95,10 +95,13 @@ GlideComputerAirData::ProcessVertical(const MoreData &basic,
                              calculated.flight);
   Turning(basic, calculated, settings);
 
-  wind_computer.Compute(settings.wind, settings.polar.glide_polar_task,
-                        basic, calculated);
-  wind_computer.Select(settings.wind, basic, calculated);
-  wind_computer.ComputeHeadWind(basic, calculated);
+  {
+    ComputerProfiler::Scope scope(profiler, ComputerProfiler::Section::WIND);
+    wind_computer.Compute(settings.wind, settings.polar.glide_polar_task,
+                          basic, calculated);
+    wind_computer.Select(settings.wind, basic, calculated);
+    wind_computer.ComputeHeadWind(basic, calculated);
+  }
 
   thermallocator.Process(calculated.circling,
                          basic.time, basic.location,
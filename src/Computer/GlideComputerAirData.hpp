@@ -33,6 +33,7 @@ Copyright_License {
 #include "LiftDatabaseComputer.hpp"
 #include "AverageVarioComputer.hpp"
 #include "ThermalLocator.hpp"
+#include "Profiler.hpp"
 
 struct VarioInfo;
 struct OneClimbInfo;
@@ -50,6 +51,8 @@ class GlideComputerAirData {
   const Waypoints &waypoints;
   const RasterTerrain *terrain;
 
+  ComputerProfiler *profiler;
+
   AutoQNH auto_qnh;
 
   GlideRatioComputer gr_computer;
@@ -76,6 +79,10 @@ public:
     terrain = _terrain;
   }
 
+  void SetProfiler(ComputerProfiler *_profiler) {
+    profiler = _profiler;
+  }
+
   const WindStore &GetWindStore() const {
     return wind_computer.GetWindStore();
   }
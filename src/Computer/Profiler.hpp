@@ -0,0 +1,98 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_COMPUTER_PROFILER_HPP
+#define XCSOAR_COMPUTER_PROFILER_HPP
+
+/**
+ * Receives the boundaries of the expensive sections of the
+ * GlideComputer, to let a benchmark measure how much time (and
+ * memory) each of them costs per fix.  The sections never overlap.
+ * Without a profiler (the default), each section costs just one
+ * pointer check.
+ */
+class ComputerProfiler {
+public:
+  enum class Section : unsigned {
+    /**
+     * TaskManager::Update() and the auto MacCready calculation.
+     */
+    TASK,
+
+    /**
+     * TaskManager::UpdateIdle(), i.e. the task optimisers.
+     */
+    TASK_IDLE,
+
+    /**
+     * The route planner and the reach calculation.
+     */
+    ROUTE,
+
+    /**
+     * The contest solvers.
+     */
+    CONTEST,
+
+    /**
+     * The airspace warning manager.
+     */
+    WARNINGS,
+
+    /**
+     * The wind estimators.
+     */
+    WIND,
+
+    COUNT
+  };
+
+  virtual void BeginSection(Section section) = 0;
+  virtual void EndSection(Section section) = 0;
+
+  /**
+   * Measures the lifetime of this object as one call of the given
+   * section.  The profiler may be nullptr.
+   */
+  class Scope {
+    ComputerProfiler *const profiler;
+    const Section section;
+
+  public:
+    Scope(ComputerProfiler *_profiler, Section _section)
+      :profiler(_profiler), section(_section) {
+      if (profiler != nullptr)
+        profiler->BeginSection(section);
+    }
+
+    ~Scope() {
+      if (profiler != nullptr)
+        profiler->EndSection(section);
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+};
+
+#endif
@@ -33,11 +33,14 @@ Copyright_License {
 
 RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
-  :protected_route_planner(route_planner, airspace_database, warnings),
+  :worker_pool(std::min(WorkerPool::GetDefaultThreadCount(), 1u)),
+   protected_route_planner(route_planner, airspace_database, warnings),
    route_clock(fixed(5)),
    reach_clock(fixed(5)),
    terrain(NULL)
-{}
+{
+  route_planner.SetWorkerPool(&worker_pool);
+}
 
 void
 RouteComputer::ResetFlight()
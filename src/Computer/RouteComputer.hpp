@@ -28,6 +28,7 @@ Copyright_License {
 #include "Engine/Task/TaskType.hpp"
 #include "Engine/Route/RoutePlanner.hpp"
 #include "Time/GPSClock.hpp"
+#include "Thread/WorkerPool.hpp"
 
 struct MoreData;
 struct DerivedInfo;
@@ -38,6 +39,11 @@ class RasterTerrain;
 class GlidePolar;
 
 class RouteComputer {
+  /**
+   * Expands the turning reach in parallel.
+   */
+  WorkerPool worker_pool;
+
   RoutePlannerGlue route_planner;
   ProtectedRoutePlanner protected_route_planner;
 
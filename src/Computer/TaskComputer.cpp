@@ -41,10 +41,13 @@ TaskComputer::TaskComputer(ProtectedTaskManager &_task,
                            const Airspaces &airspace_database,
                            const ProtectedAirspaceWarningManager *warnings)
   :task(_task),
+   worker_pool(std::min(WorkerPool::GetDefaultThreadCount(), 1u)),
    route(airspace_database, warnings),
-   contest(trace.GetFull(), trace.GetContest(), trace.GetSprint())
+   contest(trace.GetFull(), trace.GetContest(), trace.GetSprint()),
+   profiler(nullptr)
 {
   task.SetRoutePlanner(&route.GetRoutePlanner());
+  task.SetWorkerPool(&worker_pool);
 }
 
 void
@@ -69,6 +72,7 @@ TaskComputer::ProcessBasicTask(const MoreData &basic,
 {
   trace.Update(settings_computer, basic, calculated);
 
+  ComputerProfiler::Scope scope(profiler, ComputerProfiler::Section::TASK);
   ProtectedTaskManager::ExclusiveLease _task(task);
 
   _task->SetTaskBehaviour(settings_computer.task);
@@ -108,10 +112,13 @@ TaskComputer::ProcessMoreTask(const MoreData &basic,
   const GlidePolar &glide_polar = settings_computer.polar.glide_polar_task;
   const GlidePolar &safety_polar = calculated.glide_polar_safety;
 
-  route.ProcessRoute(basic, calculated,
-                     settings_computer.task.glide,
-                     settings_computer.task.route_planner,
-                     glide_polar, safety_polar);
+  {
+    ComputerProfiler::Scope scope(profiler, ComputerProfiler::Section::ROUTE);
+    route.ProcessRoute(basic, calculated,
+                       settings_computer.task.glide,
+                       settings_computer.task.route_planner,
+                       glide_polar, safety_polar);
+  }
 
   if (settings_computer.features.block_stf_enabled)
     calculated.V_stf = calculated.common_stats.V_block;
@@ -152,14 +159,20 @@ TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
   contest.SetPredicted(Predicted(settings_computer.contest, basic,
                                  calculated.task_stats.current_leg));
 
-  if (exhaustive)
-    contest.SolveExhaustive(settings_computer.contest,
-                            calculated.contest_stats);
-  else
-    contest.Solve(settings_computer.contest, calculated.contest_stats);
+  {
+    ComputerProfiler::Scope scope(profiler,
+                                  ComputerProfiler::Section::CONTEST);
+    if (exhaustive)
+      contest.SolveExhaustive(settings_computer.contest,
+                              calculated.contest_stats);
+    else
+      contest.Solve(settings_computer.contest, calculated.contest_stats);
+  }
 
   const AircraftState as = ToAircraftState(basic, calculated);
 
+  ComputerProfiler::Scope scope(profiler,
+                                ComputerProfiler::Section::TASK_IDLE);
   ProtectedTaskManager::ExclusiveLease _task(task);
   _task->UpdateIdle(as);
 }
@@ -29,6 +29,8 @@ Copyright_License {
 #include "ContestComputer.hpp"
 #include "Engine/Navigation/Aircraft.hpp"
 #include "NMEA/Validity.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "Profiler.hpp"
 
 struct NMEAInfo;
 class ProtectedTaskManager;
@@ -38,6 +40,11 @@ class TaskComputer
 {
   ProtectedTaskManager &task;
 
+  /**
+   * Evaluates the landable waypoints of the abort task.
+   */
+  WorkerPool worker_pool;
+
   RouteComputer route;
 
   TraceComputer trace;
@@ -51,6 +58,8 @@ class TaskComputer
 
   Validity last_location_available;
 
+  ComputerProfiler *profiler;
+
 public:
   TaskComputer(ProtectedTaskManager &_task,
                const Airspaces &airspace_database,
@@ -92,6 +101,10 @@ public:
     contest.SetIncremental(incremental);
   }
 
+  void SetProfiler(ComputerProfiler *_profiler) {
+    profiler = _profiler;
+  }
+
   /**
    * Auto-create a task on takeoff that leads back home.
    */
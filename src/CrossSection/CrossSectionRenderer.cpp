@@ -110,13 +110,14 @@ CrossSectionRenderer::UpdateTerrain(short *elevations) const
 
   const GeoPoint point_diff = vec.EndPoint(start) - start;
 
-  RasterTerrain::Lease map(*terrain);
+  GeoPoint slice_points[NUM_SLICES];
   for (unsigned i = 0; i < NUM_SLICES; ++i) {
     const fixed slice_distance_factor = fixed(i) / (NUM_SLICES - 1);
-    const GeoPoint slice_point = start + point_diff * slice_distance_factor;
-
-    elevations[i] = map->GetHeight(slice_point);
+    slice_points[i] = start + point_diff * slice_distance_factor;
   }
+
+  RasterTerrain::Lease map(*terrain);
+  map->GetHeights(slice_points, elevations, NUM_SLICES);
 }
 
 void
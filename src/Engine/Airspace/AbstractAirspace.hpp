@@ -223,6 +223,10 @@ public:
     days_of_operation = mask;
   }
 
+  AirspaceActivity GetDays() const {
+    return days_of_operation;
+  }
+
   /** 
    * Get type of airspace
    * 
@@ -241,6 +245,13 @@ public:
     return altitude_base.IsTerrain();
   }
 
+  /**
+   * Is the border convex?
+   */
+  bool IsConvex() const {
+    return m_is_convex;
+  }
+
   const AirspaceAltitude &GetBase() const { return altitude_base; }
   const AirspaceAltitude &GetTop() const { return altitude_top; }
 
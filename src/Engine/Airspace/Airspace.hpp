@@ -65,6 +65,13 @@ public:
   Airspace(AbstractAirspace& airspace,
            const TaskProjection& tp);
 
+  /**
+   * Constructor for actual airspaces whose bounding box has already
+   * been calculated (see AbstractAirspace::GetBoundingBox()).
+   */
+  Airspace(AbstractAirspace &_airspace, const FlatBoundingBox &bb)
+    :FlatBoundingBox(bb), airspace(&_airspace) {}
+
   /** 
    * Constructor for virtual airspaces for use in range-based
    * intersection queries
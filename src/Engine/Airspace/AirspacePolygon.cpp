@@ -25,6 +25,14 @@
 #include "Geo/Flat/FlatRay.hpp"
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
+#include "Geo/ConvexHull/PolygonInterior.hpp"
+
+#include <algorithm>
+
+/**
+ * Borders with fewer vertices are searched linearly.
+ */
+static constexpr unsigned MIN_INDEX_VERTICES = 32;
 
 AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
                                  const bool prune)
@@ -52,9 +60,38 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
     } else {
       m_is_convex = m_border.IsConvex();
     }
+
+    BuildEdgeIndex();
   }
 }
 
+AirspacePolygon::AirspacePolygon(ConstBuffer<GeoPoint> border,
+                                 bool is_convex)
+  :AbstractAirspace(Shape::POLYGON)
+{
+  m_is_convex = is_convex;
+
+  m_border.reserve(border.size);
+  for (const GeoPoint &pt : border)
+    m_border.emplace_back(pt);
+
+  BuildEdgeIndex();
+}
+
+void
+AirspacePolygon::BuildEdgeIndex()
+{
+  if (m_border.size() < MIN_INDEX_VERTICES)
+    return;
+
+  std::vector<double> latitudes;
+  latitudes.reserve(m_border.size());
+  for (const SearchPoint &p : m_border)
+    latitudes.push_back(p.GetLocation().latitude.Native());
+
+  edge_index.Build(latitudes.data(), latitudes.size());
+}
+
 const GeoPoint 
 AirspacePolygon::GetCenter() const
 {
@@ -67,7 +104,15 @@ AirspacePolygon::GetCenter() const
 bool 
 AirspacePolygon::Inside(const GeoPoint &loc) const
 {
-  return m_border.IsInside(loc);
+  if (!edge_index.IsDefined())
+    return m_border.IsInside(loc);
+
+  const double latitude = loc.latitude.Native();
+  if (edge_index.IsOutside(latitude))
+    return false;
+
+  return PolygonInterior(loc, m_border,
+                         edge_index.GetEdges(edge_index.GetBand(latitude)));
 }
 
 AirspaceIntersectionVector
@@ -79,12 +124,49 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
-  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
+  if (!edge_index.IsDefined()) {
+    for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
 
-    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
-    fixed t = ray.DistinctIntersection(r_seg);
-    if (!negative(t))
-      sorter.add(t, projection.Unproject(ray.Parametric(t)));
+      const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+      fixed t = ray.DistinctIntersection(r_seg);
+      if (!negative(t))
+        sorter.add(t, projection.Unproject(ray.Parametric(t)));
+    }
+
+    return sorter.all();
+  }
+
+  /* the flat coordinates are rounded; widen the latitude range by
+     two flat units to catch all edges which may intersect the ray */
+  const double tolerance =
+    2 * fabs(double((projection.Unproject(FlatGeoPoint(0, 1)).latitude -
+                     projection.Unproject(FlatGeoPoint(0, 0)).latitude)
+                    .Native()));
+  const double lo = double(std::min(start.latitude, end.latitude).Native())
+    - tolerance;
+  const double hi = double(std::max(start.latitude, end.latitude).Native())
+    + tolerance;
+  if (edge_index.IsOutside(lo, hi))
+    return sorter.all();
+
+  const unsigned first_band = edge_index.GetBand(lo);
+  const unsigned last_band = edge_index.GetBand(hi);
+  for (unsigned band = first_band; band <= last_band; ++band) {
+    for (unsigned i : edge_index.GetEdges(band)) {
+      const SearchPoint &a = m_border[i], &b = m_border[i + 1];
+
+      /* an edge spanning several bands is examined only once */
+      const unsigned edge_band =
+        edge_index.GetBand(std::min(a.GetLocation().latitude,
+                                    b.GetLocation().latitude).Native());
+      if (std::max(edge_band, first_band) != band)
+        continue;
+
+      const FlatRay r_seg(a.GetFlatLocation(), b.GetFlatLocation());
+      fixed t = ray.DistinctIntersection(r_seg);
+      if (!negative(t))
+        sorter.add(t, projection.Unproject(ray.Parametric(t)));
+    }
   }
 
   return sorter.all();
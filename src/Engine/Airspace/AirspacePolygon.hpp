@@ -24,6 +24,9 @@
 #define AIRSPACEPOLYGON_HPP
 
 #include "AbstractAirspace.hpp"
+#include "Geo/EdgeBandIndex.hpp"
+#include "Util/ConstBuffer.hpp"
+
 #include <vector>
 
 #ifdef DO_PRINT
@@ -34,6 +37,13 @@
 class AirspacePolygon: 
   public AbstractAirspace 
 {
+  /**
+   * Index of the border edges by latitude, to avoid walking the
+   * whole border in Inside() and Intersects().  Only built for
+   * borders with many vertices.
+   */
+  EdgeBandIndex edge_index;
+
 public:
   /** 
    * Constructor.  For testing, pts vector is a cloud of points,
@@ -46,6 +56,20 @@ public:
    */
   AirspacePolygon(const std::vector<GeoPoint> &pts, const bool prune = false);
 
+  /**
+   * Constructor for a border which was copied from another
+   * AirspacePolygon (e.g. loaded from a cache file).  It must be
+   * closed already, and its convexity is not calculated again.
+   *
+   * @param border the closed border
+   * @param is_convex the result of IsConvex() of the original
+   */
+  AirspacePolygon(ConstBuffer<GeoPoint> border, bool is_convex);
+
+private:
+  void BuildEdgeIndex();
+
+public:
   /**
    * Get arbitrary center or reference point for use in determining
    * overall center location of all airspaces
@@ -56,7 +80,8 @@ public:
 
   /** 
    * Checks whether an aircraft is inside the airspace.
-   * This is slow because it uses geodesic calculations
+   * Only the border edges crossing the latitude of the location
+   * are examined.
    * 
    * @param loc State about which to test inclusion
    * 
@@ -31,6 +31,21 @@
 
 #include <functional>
 
+/**
+ * Convert a bounding box to the R-tree search rectangle, enlarged by
+ * the specified range.
+ */
+gcc_pure
+static Airspaces::AirspaceTree::Rectangle
+ToRectangle(const FlatBoundingBox &box, int range=0)
+{
+  const FlatGeoPoint &ll = box.GetLowerLeft(), &ur = box.GetUpperRight();
+  return Airspaces::AirspaceTree::Rectangle(ll.longitude - range,
+                                            ll.latitude - range,
+                                            ur.longitude + range,
+                                            ur.latitude + range);
+}
+
 #ifdef INSTRUMENT_TASK
 extern unsigned n_queries;
 extern long count_intersections;
@@ -64,7 +79,8 @@ Airspaces::VisitWithinRange(const GeoPoint &location, fixed range,
   Airspace bb_target(location, task_projection);
   int projected_range = task_projection.ProjectRangeInteger(location, range);
   AirspacePredicateVisitorAdapter adapter(predicate, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  airspace_tree.VisitOverlapping(ToRectangle(bb_target, projected_range),
+                                 adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -105,7 +121,8 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
   Airspace bb_target(c, task_projection);
   int projected_range = task_projection.ProjectRangeInteger(c, loc.Distance(end) / 2);
   IntersectingAirspaceVisitorAdapter adapter(loc, end, task_projection, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  airspace_tree.VisitOverlapping(ToRectangle(bb_target, projected_range),
+                                 adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -136,11 +153,8 @@ Airspaces::FindNearest(const GeoPoint &location,
   const int projected_range =
     task_projection.ProjectRangeInteger(location, fixed(30000));
   const AirspacePredicateAdapter predicate(condition);
-  std::pair<AirspaceTree::const_iterator, AirspaceTree::distance_type> found =
-    airspace_tree.find_nearest_if(bb_target, BBDist(0, projected_range),
-                                  predicate);
-
-  return found.first != airspace_tree.end() ? &*found.first : NULL;
+  return airspace_tree.FindNearestIf(ToRectangle(bb_target), projected_range,
+                                     predicate);
 }
 
 const Airspaces::AirspaceVector
@@ -168,7 +182,8 @@ Airspaces::ScanRange(const GeoPoint &location, fixed range,
       res.push_back(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, -projected_range, visitor);
+  airspace_tree.VisitOverlapping(ToRectangle(bb_target, projected_range),
+                                 visitor);
 
   return res;
 }
@@ -197,13 +212,13 @@ Airspaces::FindInside(const AircraftState &state,
       vectors.push_back(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, 0, visitor);
+  airspace_tree.VisitOverlapping(ToRectangle(bb_target), visitor);
 
   return vectors;
 }
 
-void
-Airspaces::Optimise()
+bool
+Airspaces::UpdateProjection()
 {
   if (!owns_children || task_projection.Update()) {
     // dont update task_projection if not owner!
@@ -217,14 +232,40 @@ Airspaces::Optimise()
     airspace_tree.clear();
   }
 
-  if (!tmp_as.empty()) {
-    while (!tmp_as.empty()) {
-      Airspace as(*tmp_as.front(), task_projection);
-      airspace_tree.insert(as);
-      tmp_as.pop_front();
-    }
-    airspace_tree.optimise();
+  return !tmp_as.empty();
+}
+
+void
+Airspaces::InsertEnvelopes(AirspaceVector &&envelopes)
+{
+  assert(envelopes.size() == tmp_as.size());
+
+  if (envelopes.size() >= airspace_tree.size()) {
+    /* many new airspaces: bulk-load a new tree, which is quicker and
+       yields a better tree than inserting them one by one */
+    envelopes.insert(envelopes.end(),
+                     airspace_tree.begin(), airspace_tree.end());
+    airspace_tree.Load(envelopes.begin(), envelopes.end());
+  } else {
+    for (auto &as : envelopes)
+      airspace_tree.Add(std::move(as));
   }
+
+  tmp_as.clear();
+}
+
+void
+Airspaces::Optimise()
+{
+  if (!UpdateProjection())
+    return;
+
+  AirspaceVector envelopes;
+  envelopes.reserve(tmp_as.size());
+  for (AbstractAirspace *as : tmp_as)
+    envelopes.emplace_back(*as, task_projection);
+
+  InsertEnvelopes(std::move(envelopes));
 }
 
 void
@@ -285,7 +326,7 @@ Airspaces::GetSize() const
 bool
 Airspaces::IsEmpty() const
 {
-  return airspace_tree.empty() && tmp_as.empty();
+  return airspace_tree.IsEmpty() && tmp_as.empty();
 }
 
 void
@@ -331,7 +372,8 @@ Airspaces::SynchroniseInRange(const Airspaces& master,
   bool changed = false;
   const AirspaceVector contents_master = master.ScanRange(location, range, condition);
   AirspaceVector contents_self;
-  contents_self.reserve(std::max(airspace_tree.size(), contents_master.size()));
+  contents_self.reserve(std::max(size_t(airspace_tree.size()),
+                                contents_master.size()));
 
   task_projection = master.task_projection; // ensure these are up to date
 
@@ -360,18 +402,7 @@ Airspaces::SynchroniseInRange(const Airspaces& master,
   // anything left in the self list are items that were not in the query,
   // so delete them --- including the clearances!
   for (auto v = contents_self.begin(); v != contents_self.end();) {
-    gcc_unused bool found = false;
-    for (auto t = airspace_tree.begin(); t != airspace_tree.end(); ) {
-      if (t->GetAirspace() == v->GetAirspace()) {
-        AirspaceTree::const_iterator new_t = t;
-        ++new_t;
-        airspace_tree.erase_exact(*t);
-        t = new_t;
-        found = true;
-      } else {
-        ++t;
-      }
-    }
+    gcc_unused const bool found = airspace_tree.Remove(*v);
     assert(found);
     v->ClearClearance();
     v = contents_self.erase(v);
@@ -398,5 +429,5 @@ Airspaces::VisitInside(const GeoPoint &loc,
       visitor.Visit(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, 0, visitor2);
+  airspace_tree.VisitOverlapping(ToRectangle(bb_target), visitor2);
 }
@@ -34,25 +34,26 @@
 #include <deque>
 
 class RasterTerrain;
+class WorkerPool;
 class AirspaceVisitor;
 class AirspaceIntersectionVisitor;
 
 /**
- * Container for airspaces using kd-tree representation internally for
- * fast geospatial lookups.
+ * Container for airspaces using an R-tree of bounding boxes
+ * internally for fast geospatial lookups.
  *
- * Complexity analysis (with kdtree):
+ * Complexity analysis (with R-tree):
  *
- *    Find within range (k points found):
- *     O(n^(3/4) + k)
+ *    Find within range (k airspaces found):
+ *     O(log(n) + k) typical
  *
  *    Find intersecting:
- *     O(n^(3/4) + k)
+ *     O(log(n) + k) typical
  *
  *    Find nearest:
- *     O(log(n))
+ *     O(log(n)) typical
  *
- *  Without kd-tree:
+ *  Without R-tree:
  *
  *    Find within range:
  *     O(n)
@@ -107,9 +108,18 @@ public:
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
    * any searches, but can be done once after a batch insert/delete.
+   *
+   * A large batch is bulk-loaded into a new tree, while a few new
+   * airspaces are inserted into the existing one.
    */
   void Optimise();
 
+  /**
+   * Same as Optimise(), but projects the new airspaces and calculates
+   * their bounds in parallel.
+   */
+  void Optimise(WorkerPool &pool);
+
   /**
    * Clear the airspace store, deleting airspace objects if m_owner is true
    */
@@ -124,6 +134,14 @@ public:
   gcc_pure
   unsigned GetSize() const;
 
+  /**
+   * Returns the airspaces which were added since the last call to
+   * Optimise(), in the order they were added.
+   */
+  const std::deque<AbstractAirspace *> &GetPending() const {
+    return tmp_as;
+  }
+
   /**
    * Whether airspace store is empty
    *
@@ -265,6 +283,22 @@ public:
                           const GeoPoint &location, fixed range,
                           const AirspacePredicate &condition =
                                 AirspacePredicate::always_true);
+
+private:
+  /**
+   * Update the task projection.  If it has changed, all airspaces are
+   * moved from the tree back to #tmp_as, because their envelopes
+   * need to be rebuilt.
+   *
+   * @return true if there are airspaces in #tmp_as
+   */
+  bool UpdateProjection();
+
+  /**
+   * Insert the envelopes of all airspaces in #tmp_as into the tree,
+   * and clear #tmp_as.
+   */
+  void InsertEnvelopes(AirspaceVector &&envelopes);
 };
 
 #endif
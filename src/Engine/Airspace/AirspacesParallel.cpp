@@ -0,0 +1,56 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspaces.hpp"
+#include "AbstractAirspace.hpp"
+#include "Thread/WorkerPool.hpp"
+
+#include <algorithm>
+
+void
+Airspaces::Optimise(WorkerPool &pool)
+{
+  if (!UpdateProjection())
+    return;
+
+  /* projecting a polygon only modifies the AbstractAirspace object
+     itself, therefore disjoint ranges can be handled concurrently */
+  const std::vector<AbstractAirspace *> source(tmp_as.begin(), tmp_as.end());
+  const unsigned n = source.size();
+  std::vector<FlatBoundingBox> boxes(n);
+
+  static constexpr unsigned CHUNK_SIZE = 64;
+  const unsigned n_chunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  pool.Run(n_chunks, [this, &source, &boxes, n](unsigned chunk) {
+      const unsigned end = std::min(n, (chunk + 1) * unsigned(CHUNK_SIZE));
+      for (unsigned i = chunk * CHUNK_SIZE; i < end; ++i)
+        boxes[i] = source[i]->GetBoundingBox(task_projection);
+    });
+
+  AirspaceVector envelopes;
+  envelopes.reserve(n);
+  for (unsigned i = 0; i < n; ++i)
+    envelopes.emplace_back(*source[i], boxes[i]);
+
+  InsertEnvelopes(std::move(envelopes));
+}
@@ -22,6 +22,7 @@
 
 #include "ContestManager.hpp"
 #include "Trace/Trace.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Time/PeriodClock.hpp"
 #include "LogFile.hpp"
 #include <tchar.h>
@@ -44,7 +45,8 @@ ContestManager::ContestManager(const Contest _contest,
    dhv_xc_triangle(trace_triangle, predict_triangle, true),
    sis_at(trace_full),
    net_coupe(trace_full),
-   discontinue_calculations(false)
+   discontinue_calculations(false),
+   worker_pool(nullptr)
 {
   Reset();
 }
@@ -121,6 +123,32 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+bool
+ContestManager::RunContestPair(AbstractContest &a, AbstractContest &b,
+                               bool exhaustive)
+{
+  if (worker_pool == nullptr) {
+    bool retval = RunContest(a, stats.result[0],
+                             stats.solution[0], exhaustive);
+    retval |= RunContest(b, stats.result[1],
+                         stats.solution[1], exhaustive);
+    return retval;
+  }
+
+  /* each solver works on its own copy of the trace and writes to its
+     own result slot, so they can run concurrently; the master traces
+     are not modified while UpdateIdle() runs */
+  AbstractContest *const contests[2] = { &a, &b };
+  bool retval[2];
+
+  worker_pool->Run(2, [&](unsigned i) {
+      retval[i] = RunContest(*contests[i], stats.result[i],
+                             stats.solution[i], exhaustive);
+    });
+
+  return retval[0] || retval[1];
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive)
 {
@@ -163,11 +191,7 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContestPair(olc_classic, olc_fai, exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -185,17 +209,11 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContestPair(xcontest_free, xcontest_triangle, exhaustive);
     break;
 
   case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContestPair(dhv_xc_free, dhv_xc_triangle, exhaustive);
     break;
 
   case Contest::SIS_AT:
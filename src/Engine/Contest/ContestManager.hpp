@@ -37,6 +37,7 @@
 #include "ContestStatistics.hpp"
 
 class Trace;
+class WorkerPool;
 
 /**
  * Special task holder for Online Contest calculations
@@ -70,6 +71,12 @@ class ContestManager
    */
   bool discontinue_calculations;
 
+  /**
+   * If set, solvers which do not depend on each other are run in
+   * parallel on this pool.
+   */
+  WorkerPool *worker_pool;
+
 public:
   /**
    * Base constructor.
@@ -104,6 +111,20 @@ public:
 
   void SetHandicap(unsigned handicap);
 
+  /**
+   * Run the independent solvers of the selected contest (e.g. the
+   * free and the triangle part of XContest) in parallel on the given
+   * #WorkerPool.  The results are merged into the #ContestStatistics
+   * after all of them have finished.  Pass nullptr to solve
+   * sequentially (the default).
+   *
+   * The pool must remain valid until it is cleared or this object is
+   * destroyed.
+   */
+  void SetWorkerPool(WorkerPool *_worker_pool) {
+    worker_pool = _worker_pool;
+  }
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
@@ -126,6 +147,16 @@ public:
   const ContestStatistics &GetStats() const {
     return stats;
   }
+
+private:
+  /**
+   * Run two solvers which do not depend on each other, storing their
+   * results in slot 0 and 1 of #stats.
+   *
+   * @return true if at least one of them has found a new solution
+   */
+  bool RunContestPair(AbstractContest &a, AbstractContest &b,
+                      bool exhaustive);
 };
 
 #endif
@@ -23,9 +23,9 @@
 #include "OLCTriangle.hpp"
 #include "Cast.hpp"
 #include "Trace/Trace.hpp"
-#include "Util/QuadTree.hpp"
 
 #include <limits>
+#include <vector>
 
 /*
  @todo potential to use 3d convex hull to speed search
@@ -63,6 +63,7 @@ OLCTriangle::OLCTriangle(const Trace &_trace,
   : AbstractContest(_finish_alt_diff),
    TraceManager(_trace),
    is_fai(_is_fai), predict(_predict),
+   incremental(false),
    is_closed(false),
    is_complete(false)
 {
@@ -80,6 +81,8 @@ OLCTriangle::Reset()
   tick_iterations = 1000;
 
   closing_pairs.clear();
+  explored_pairs.clear();
+  search_point_tree.Clear();
   ClearTrace();
 
   ResetBranchAndBound();
@@ -117,16 +120,19 @@ OLCTriangle::UpdateTrace(bool force)
 
     is_complete = false;
 
-    best_d = 0;
+    ResetBestDistance();
 
     closing_pairs.clear();
     is_closed = FindClosingPairs(0);
 
-   } else if (is_complete && incremental) {
+   } else if (incremental) {
+    /* only points were appended; the indices of the old points
+       remain valid, and so do #best_d and #explored_pairs */
     const unsigned old_size = n_points;
     if (UpdateTraceTail()) {
       is_complete = false;
-      is_closed = FindClosingPairs(old_size);
+      if (FindClosingPairs(old_size))
+        is_closed = true;
     }
   }
 
@@ -205,7 +211,7 @@ OLCTriangle::SolveTriangle(bool exhaustive)
            relaxed->first <= closing_pair->first + relax &&
            relaxed->second <= closing_pair->second + relax;
            ++relaxed)
-        relax_last = relaxed->second;
+        relax_last = std::max(relax_last, relaxed->second);
 
       relaxed_pairs.insert(ClosingPair(relax_first, relax_last));
     }
@@ -214,11 +220,20 @@ OLCTriangle::SolveTriangle(bool exhaustive)
 
     ClosingPairs close_look;
 
+    /* the best (possibly open) triangle found in each relaxed pair */
+    std::vector<std::pair<ClosingPair, unsigned>> relaxed_best;
+
     for (const auto relaxed_pair : relaxed_pairs.closing_pairs) {
+      const unsigned unexplored = GetUnexploredStart(relaxed_pair);
+      if (unexplored > relaxed_pair.second)
+        // nothing new inside this pair since the last search
+        continue;
 
       std::tuple<unsigned, unsigned, unsigned, unsigned> triangle;
 
-      triangle = RunBranchAndBound(relaxed_pair.first, relaxed_pair.second, best_d, exhaustive);
+      triangle = RunBranchAndBound(relaxed_pair.first, relaxed_pair.second,
+                                   unexplored, best_d, exhaustive);
+      relaxed_best.emplace_back(relaxed_pair, std::get<3>(triangle));
 
       if (std::get<3>(triangle) > best_d) {
         // solution is better than best_d
@@ -251,6 +266,7 @@ OLCTriangle::SolveTriangle(bool exhaustive)
 
       triangle = RunBranchAndBound(close_look_pair.first,
                                    close_look_pair.second,
+                                   close_look_pair.first,
                                    best_d, exhaustive);
 
       if (std::get<3>(triangle) > best_d) {
@@ -266,30 +282,48 @@ OLCTriangle::SolveTriangle(bool exhaustive)
       }
     }
 
+    /* remember the searches which have finished without leaving a
+       triangle better than #best_d behind; an open triangle may be
+       closed by a point appended later, so a pair containing one
+       needs to be searched again completely */
+    for (const auto &i : relaxed_best)
+      if (i.second <= best_d)
+        explored_pairs.insert(i.first);
+
   } else {
     /**
      * We're currently running in predictive, non-exhaustive mode, so we use
      * one closing pair only (0 -> n_points-1) which allows us to suspend the
      * solver...
      */
-    std::tuple<unsigned, unsigned, unsigned, unsigned> triangle;
+    const ClosingPair pair(0, n_points - 1);
+    const unsigned unexplored = GetUnexploredStart(pair);
+
+    if (running || unexplored <= pair.second) {
+      std::tuple<unsigned, unsigned, unsigned, unsigned> triangle;
+
+      triangle = RunBranchAndBound(0, n_points - 1, unexplored, best_d, false);
 
-    triangle = RunBranchAndBound(0, n_points - 1, best_d, false);
+      if (std::get<3>(triangle) > best_d) {
+        // solution is better than best_d
 
-    if (std::get<3>(triangle) > best_d) {
-      // solution is better than best_d
+        start = 0;
+        tp1 = std::get<0>(triangle);
+        tp2 = std::get<1>(triangle);
+        tp3 = std::get<2>(triangle);
+        finish = n_points - 1;
 
-      start = 0;
-      tp1 = std::get<0>(triangle);
-      tp2 = std::get<1>(triangle);
-      tp3 = std::get<2>(triangle);
-      finish = n_points - 1;
+        best_d = std::get<3>(triangle);
+      }
 
-      best_d = std::get<3>(triangle);
+      if (!running)
+        explored_pairs.insert(pair);
     }
   }
 
-  if (best_d > 0) {
+  if (finish > 0) {
+    /* a better triangle was found; otherwise keep the solution of a
+       previous (incremental) run */
     solution.resize(5);
 
     solution[0] = TraceManager::GetPoint(start);
@@ -297,14 +331,34 @@ OLCTriangle::SolveTriangle(bool exhaustive)
     solution[2] = TraceManager::GetPoint(tp2);
     solution[3] = TraceManager::GetPoint(tp3);
     solution[4] = TraceManager::GetPoint(finish);
+  }
 
+  if (best_d > 0)
     is_complete = true;
-  }
 }
 
 
+unsigned
+OLCTriangle::GetUnexploredStart(const ClosingPair &pair) const
+{
+  const auto explored = explored_pairs.findRange(pair);
+  if (explored.first != 0 || explored.second != 0)
+    return pair.second + 1;
+
+  /* a pair with the same start which has grown since it was
+     explored: all triangles inside the old pair have been examined
+     already */
+  const auto same_start = explored_pairs.closing_pairs.find(pair.first);
+  if (same_start != explored_pairs.closing_pairs.end() &&
+      same_start->second < pair.second)
+    return same_start->second + 1;
+
+  return pair.first;
+}
+
 std::tuple<unsigned, unsigned, unsigned, unsigned>
-OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, bool exhaustive)
+OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned unexplored,
+                               unsigned worst_d, bool exhaustive)
 {
   /* Some general information about the branch and bound method can be found here:
    * http://eaton.math.rpi.edu/faculty/Mitchell/papers/leeejem.html
@@ -329,8 +383,13 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
     // initiate algorithm. otherwise continue unfinished run
     running = true;
 
-    // initialize bound-and-branch tree with root node (note: Candidate set interval is [min, max))
-    CandidateSet root_candidates(this, from, to + 1);
+    /* initialize bound-and-branch tree with root node (note:
+       Candidate set interval is [min, max)).  Only triangles with
+       tp1 <= tp2 <= tp3 are searched, so triangles touching the
+       unexplored points are all found by limiting tp3 to those */
+    CandidateSet root_candidates(TurnPointRange(this, from, to + 1),
+                                 TurnPointRange(this, from, to + 1),
+                                 TurnPointRange(this, unexplored, to + 1));
     if (root_candidates.isFeasible(is_fai, large_triangle_check) && root_candidates.df_max >= worst_d)
       branch_and_bound.insert(std::pair<unsigned, CandidateSet>(root_candidates.df_max, root_candidates));
   }
@@ -387,65 +446,63 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
     } else {
       // split largest bounding box of node and create child nodes
 
-      const unsigned tp1_diag = node->second.tp1.diagonal();
-      const unsigned tp2_diag = node->second.tp2.diagonal();
-      const unsigned tp3_diag = node->second.tp3.diagonal();
+      const unsigned tp1_diag = node->second.tp1.size() != 1
+        ? node->second.tp1.diagonal() : 0;
+      const unsigned tp2_diag = node->second.tp2.size() != 1
+        ? node->second.tp2.diagonal() : 0;
+      const unsigned tp3_diag = node->second.tp3.size() != 1
+        ? node->second.tp3.diagonal() : 0;
 
       const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
 
       CandidateSet left, right;
-      bool add = false;
+      bool add = true;
 
-      if (tp1_diag == max_diag && node->second.tp1.size() != 1) {
+      if (node->second.tp1.size() != 1 && tp1_diag == max_diag) {
         // split tp1 range
         const unsigned split = (node->second.tp1.index_min + node->second.tp1.index_max) / 2;
 
-        if (split <= node->second.tp2.index_max) {
-          add = true;
+        left = CandidateSet(TurnPointRange(this, node->second.tp1.index_min, split),
+                            node->second.tp2, node->second.tp3);
 
-          left = CandidateSet(TurnPointRange(this, node->second.tp1.index_min, split),
-                              node->second.tp2, node->second.tp3);
-
-          right = CandidateSet(TurnPointRange(this, split, node->second.tp1.index_max),
-                               node->second.tp2, node->second.tp3);
-        }
-      } else if (tp2_diag == max_diag && node->second.tp2.size() != 1) {
+        right = CandidateSet(TurnPointRange(this, split, node->second.tp1.index_max),
+                             node->second.tp2, node->second.tp3);
+      } else if (node->second.tp2.size() != 1 && tp2_diag == max_diag) {
         // split tp2 range
         const unsigned split = (node->second.tp2.index_min + node->second.tp2.index_max) / 2;
 
-        if (split <= node->second.tp3.index_max && split >= node->second.tp1.index_min) {
-          add = true;
+        left = CandidateSet(node->second.tp1,
+                            TurnPointRange(this, node->second.tp2.index_min, split),
+                            node->second.tp3);
 
-          left = CandidateSet(node->second.tp1,
-                              TurnPointRange(this, node->second.tp2.index_min, split),
-                              node->second.tp3);
-
-          right = CandidateSet(node->second.tp1,
-                               TurnPointRange(this, split, node->second.tp2.index_max),
-                               node->second.tp3);
-        }
+        right = CandidateSet(node->second.tp1,
+                             TurnPointRange(this, split, node->second.tp2.index_max),
+                             node->second.tp3);
       } else if (node->second.tp3.size() != 1) {
         // split tp3 range
         const unsigned split = (node->second.tp3.index_min + node->second.tp3.index_max) / 2;
 
-        if (split >= node->second.tp2.index_min) {
-          add = true;
+        left = CandidateSet(node->second.tp1, node->second.tp2,
+                            TurnPointRange(this, node->second.tp3.index_min, split));
 
-          left = CandidateSet(node->second.tp1, node->second.tp2,
-                              TurnPointRange(this, node->second.tp3.index_min, split));
-
-          right = CandidateSet(node->second.tp1, node->second.tp2,
-                               TurnPointRange(this, split, node->second.tp3.index_max));
-        }
-      }
+        right = CandidateSet(node->second.tp1, node->second.tp2,
+                             TurnPointRange(this, split, node->second.tp3.index_max));
+      } else
+        /* all ranges are single points, but not a valid triangle */
+        add = false;
 
       if (add) {
-        // add the new candidate set only if it it's feasible and has d_min >= worst_d
-        if (left.df_max >= worst_d && left.isFeasible(is_fai, large_triangle_check)) {
+        /* add the new candidate set only if it it's feasible, has
+           d_min >= worst_d and contains at least one triangle with
+           ordered turn points; dropping only those keeps the search
+           exhaustive, which the incremental search relies on */
+        if (left.df_max >= worst_d && left.isOrdered() &&
+            left.isFeasible(is_fai, large_triangle_check)) {
           branch_and_bound.insert(std::pair<unsigned, CandidateSet>(left.df_max, left));
         }
 
-        if (right.df_max >= worst_d && right.isFeasible(is_fai, large_triangle_check)) {
+        if (right.df_max >= worst_d && right.isOrdered() &&
+            right.isFeasible(is_fai, large_triangle_check)) {
           branch_and_bound.insert(std::pair<unsigned, CandidateSet>(right.df_max, right));
         }
       }
@@ -491,29 +548,24 @@ OLCTriangle::FindClosingPairs(unsigned old_size)
     return closing_pairs.insert(ClosingPair(0, n_points-1));
   }
 
-  struct TracePointNodeAccessor {
-    gcc_pure
-    int GetX(const TracePointNode &node) const {
-      return node.point->GetFlatLocation().longitude;
-    }
-
-    gcc_pure
-    int GetY(const TracePointNode &node) const {
-      return node.point->GetFlatLocation().latitude;
-    }
-  };
-
-  QuadTree<TracePointNode, TracePointNodeAccessor> search_point_tree;
+  if (old_size == 0)
+    search_point_tree.Clear();
 
+  /* the tree contains all points, because new points may close a
+     loop with old ones; only the new points need to be added and
+     queried below */
   for (unsigned i = old_size; i < n_points; ++i) {
     TracePointNode node;
     node.point = &GetPoint(i);
     node.index = i;
 
-    search_point_tree.insert(node);
+    search_point_tree.Add(node);
   }
 
-  search_point_tree.Optimise();
+  /* points outside of the old bounds leave the tree flat and
+     unbounded; only then it needs to be rebuilt */
+  if (!search_point_tree.HaveBounds())
+    search_point_tree.Optimise();
 
   bool new_pair = false;
 
@@ -529,7 +581,11 @@ OLCTriangle::FindClosingPairs(unsigned old_size)
     const int min_altitude = GetMinimumFinishAltitude(GetPoint(i));
     const int max_altitude = GetMaximumStartAltitude(GetPoint(i));
 
-    unsigned last = 0, first = i;
+    /* the earliest point which point i closes as last point, and the
+       latest point which closes point i as first point; both are
+       tracked separately, so the result does not depend on the order
+       in which the tree visits the points */
+    unsigned first = i, last = i;
 
     const auto visitor = [this, i, start,
                           min_altitude, max_altitude,
@@ -542,19 +598,20 @@ OLCTriangle::FindClosingPairs(unsigned old_size)
           start.Distance(dest.GetLocation()) <= max_distance) {
         // point i is last point
         first = std::min(node.index, first);
-        last = i;
       } else if (node.index > i + 2 &&
                  GetPoint(node.index).GetIntegerAltitude() >= min_altitude &&
                  start.Distance(dest.GetLocation()) <= max_distance) {
         // point i is first point
-        first = i;
         last = std::max(node.index, last);
       }
     };
 
     search_point_tree.VisitWithinRange(point, max_range, visitor);
 
-    if (last != 0 && closing_pairs.insert(ClosingPair(first, last)))
+    if (first != i && closing_pairs.insert(ClosingPair(first, i)))
+      new_pair = true;
+
+    if (last != i && closing_pairs.insert(ClosingPair(i, last)))
       new_pair = true;
   }
 
@@ -27,6 +27,7 @@
 #include "TraceManager.hpp"
 #include "Trace/Point.hpp"
 #include "LogFile.hpp"
+#include "Util/QuadTree.hpp"
 
 #include <map>
 #include <cstdlib>
@@ -110,10 +111,13 @@ private:
       return ClosingPair(0, 0);
     }
 
+    /**
+     * Remove all pairs within [first, last].
+     */
     void removeRange(unsigned first, unsigned last) {
       auto it = closing_pairs.begin();
       while (it != closing_pairs.end()) {
-        if (it->first > first && it->second < last)
+        if (it->first >= first && it->second <= last)
           it = closing_pairs.erase(it);
         else
           it++;
@@ -127,6 +131,15 @@ private:
 
   ClosingPairs closing_pairs;
 
+  /**
+   * Closing pairs whose branch and bound search has finished with the
+   * current trace.  No triangle inside such a pair can be better than
+   * #best_d, therefore after the trace has been extended, only
+   * triangles touching the new points need to be searched.  This is
+   * cleared whenever the trace is rebuilt from scratch.
+   */
+  ClosingPairs explored_pairs;
+
 
   /**
    * kd-tree node of a trace point. Used for nearest search to find
@@ -150,6 +163,27 @@ private:
     }
   };
 
+  struct TracePointNodeAccessor {
+    gcc_pure
+    int GetX(const TracePointNode &node) const {
+      return node.point->GetFlatLocation().longitude;
+    }
+
+    gcc_pure
+    int GetY(const TracePointNode &node) const {
+      return node.point->GetFlatLocation().latitude;
+    }
+  };
+
+  /**
+   * All points of the working trace, used by FindClosingPairs().  It
+   * is kept across trace updates: when points are only appended, just
+   * these are added, and the tree is rebuilt only when the trace is
+   * replaced (the #TracePointNode::point pointers become invalid
+   * then).
+   */
+  QuadTree<TracePointNode, TracePointNodeAccessor> search_point_tree;
+
   /**
    * A bounding box around a range of trace points.
    */
@@ -284,6 +318,14 @@ private:
       return (tp1 == other.tp1 && tp2 == other.tp2 && tp3 == other.tp3);
     }
 
+    /* Checks if this candidate set contains at least one triangle
+     * with ordered turn points (tp1 <= tp2 <= tp3).
+     */
+    bool isOrdered() const {
+      return tp1.index_min < tp2.index_max &&
+        std::max(tp1.index_min, tp2.index_min) < tp3.index_max;
+    }
+
     /* Calculates if this candidate set is feasible
      * (i.e. it might contain a feasible triangle).
      * Use relaxed checks to ensure distance errors due to the flat projection
@@ -381,12 +423,38 @@ protected:
   bool FindClosingPairs(unsigned old_size);
   void SolveTriangle(bool exhaustive);
 
+  /**
+   * Determine the first trace point which needs to be considered as
+   * a turn point of a triangle inside the given closing pair; earlier
+   * points have been covered by a previous search (see
+   * #explored_pairs).
+   *
+   * @return the point index; greater than pair.second if the whole
+   * pair has been explored already
+   */
+  gcc_pure
+  unsigned GetUnexploredStart(const ClosingPair &pair) const;
+
+  /**
+   * Search the best triangle with all turn points in [from, to] and
+   * at least one turn point in [unexplored, to].
+   */
   std::tuple<unsigned, unsigned, unsigned, unsigned>
-  RunBranchAndBound(unsigned from, unsigned to, unsigned best_d, bool exhaustive);
+  RunBranchAndBound(unsigned from, unsigned to, unsigned unexplored,
+                    unsigned best_d, bool exhaustive);
 
   void UpdateTrace(bool force);
   void ResetBranchAndBound();
 
+  /**
+   * Forget the best distance found so far.  This invalidates
+   * #explored_pairs, because their searches were bounded by it.
+   */
+  void ResetBestDistance() {
+    best_d = 0;
+    explored_pairs.clear();
+  }
+
 public:
   /* virtual methods from AbstractContest */
   virtual void Reset() override;
@@ -62,7 +62,7 @@ XContestTriangle::Solve(bool exhaustive)
 {
   SolverResult result = OLCTriangle::Solve(exhaustive);
   if (result != SolverResult::FAILED)
-    best_d = 0; // reset heuristic
+    ResetBestDistance(); // reset heuristic
 
   return result;
 }
@@ -249,6 +249,7 @@ GlidePolar::UpdateSMin()
 #endif
 
   UpdateBestLD();
+  UpdateSpeedToFlyTable();
 }
 
 bool 
@@ -273,7 +274,7 @@ GlidePolar::IsGlidePossible(const GlideState &task) const
  */
 class GlidePolarSpeedToFly final : public ZeroFinder {
   const GlidePolar &polar;
-  const fixed m_net_sink_rate;
+  const fixed m_sink_rate;
   const fixed m_head_wind;
 
 public:
@@ -281,20 +282,21 @@ public:
    * Constructor.
    *
    * @param _polar Glide polar to optimise
-   * @param net_sink_rate Instantaneous netto sink rate (m/s), positive down
+   * @param sink_rate MacCready setting plus instantaneous netto sink
+   * rate (m/s), positive down
    * @param head_wind Head wind component (m/s)
    * @param vmin Minimum speed to search (m/s)
    * @param vmax Maximum speed to search (m/s)
    *
    * @return Initialised object (no search yet)
    */
-  GlidePolarSpeedToFly(const GlidePolar &_polar, const fixed net_sink_rate,
+  GlidePolarSpeedToFly(const GlidePolar &_polar, const fixed sink_rate,
                        const fixed head_wind, const fixed vmin,
                        const fixed vmax) :
     ZeroFinder(std::max(fixed(1), vmin - head_wind), vmax - head_wind,
                fixed(TOLERANCE_POLAR_DOLPHIN)),
     polar(_polar),
-    m_net_sink_rate(net_sink_rate),
+    m_sink_rate(sink_rate),
     m_head_wind(head_wind)
   {
   }
@@ -309,7 +311,7 @@ public:
   fixed
   f(const fixed V)
   {
-    return (polar.MSinkRate(V + m_head_wind) + m_net_sink_rate) / V;
+    return (polar.SinkRate(V + m_head_wind) + m_sink_rate) / V;
   }
 
   /**
@@ -327,6 +329,49 @@ public:
   }
 };
 
+/** Step of the still air speed-to-fly table (m/s) */
+static constexpr double STF_TABLE_STEP = 0.125;
+
+fixed
+GlidePolar::SolveSpeedToFly(const fixed sink_rate, const fixed head_wind,
+                            const fixed v_start) const
+{
+  GlidePolarSpeedToFly gp_stf(*this, sink_rate, head_wind, Vmin, Vmax);
+  return gp_stf.solve(v_start);
+}
+
+void
+GlidePolar::UpdateSpeedToFlyTable()
+{
+  if (!IsValid())
+    return;
+
+  /* the search is not limited to Vmax here, so that the table stays
+     smooth and interpolates well up to the point where
+     LookupSpeedToFly() clamps it; the speed to fly grows with the sink
+     rate, so each entry starts its search at the previous one */
+  const fixed v_limit = Vmax * 2;
+  fixed v = Vmin;
+  for (unsigned i = 0; i < STF_TABLE_SIZE; ++i) {
+    GlidePolarSpeedToFly gp_stf(*this, fixed(STF_TABLE_STEP * i) - Smin,
+                                fixed(0), Vmin, v_limit);
+    v = gp_stf.solve(v);
+    stf_table[i] = v;
+  }
+}
+
+fixed
+GlidePolar::LookupSpeedToFly(const fixed sink_rate) const
+{
+  const fixed x = (sink_rate + Smin) * fixed(1. / STF_TABLE_STEP);
+  if (negative(x) || !(x < fixed(STF_TABLE_SIZE - 1)))
+    return fixed(-1);
+
+  const unsigned i = (unsigned)x;
+  const fixed v0 = stf_table[i];
+  return std::min(Vmax, v0 + (x - fixed(i)) * (stf_table[i + 1] - v0));
+}
+
 fixed
 GlidePolar::SpeedToFly(const AircraftState &state,
     const GlideResult &solution, const bool block_stf) const
@@ -345,8 +390,11 @@ GlidePolar::SpeedToFly(const AircraftState &state,
                           : fixed(0));
     const fixed stf_sink_rate (block_stf ? fixed(0) : -state.netto_vario);
 
-    GlidePolarSpeedToFly gp_stf(*this, stf_sink_rate, head_wind, Vmin, Vmax);
-    V_stf = gp_stf.solve(Vmax);
+    V_stf = head_wind == fixed(0)
+      ? LookupSpeedToFly(mc + stf_sink_rate)
+      : fixed(-1);
+    if (negative(V_stf))
+      V_stf = SolveSpeedToFly(mc + stf_sink_rate, head_wind, Vmax);
   }
 
   return std::max(Vmin, V_stf * g_scaling);
@@ -56,6 +56,9 @@ struct SpeedVector;
  */
 class GlidePolar
 {
+  /** Number of entries in the still air speed-to-fly table */
+  static constexpr unsigned STF_TABLE_SIZE = 64;
+
   /** MacCready ring setting (m/s) */
   fixed mc;
   /** Inverse of MC setting (s/m) */
@@ -99,6 +102,13 @@ class GlidePolar
   /** Reference wing area, m^2 */
   fixed wing_area;
 
+  /**
+   * Still air speed to fly (m/s), sampled in equal steps of MacCready
+   * setting plus netto sink rate, starting at -Smin.  Not clamped to
+   * Vmax.  Depends only on the polar, and is rebuilt by UpdateSMin().
+   */
+  fixed stf_table[STF_TABLE_SIZE];
+
   friend class GlidePolarTest;
 
 public:
@@ -583,6 +593,34 @@ private:
 
   /** Solve for min sink rate at current bugs/ballast setting. */
   void UpdateSMin();
+
+  /** Fill #stf_table for the current bugs/ballast setting. */
+  void UpdateSpeedToFlyTable();
+
+  /**
+   * Solve for the still air speed to fly at the given MacCready
+   * setting plus netto sink rate.
+   *
+   * @param sink_rate MacCready setting plus netto sink rate (m/s)
+   * @param head_wind Head wind component (m/s)
+   * @param v_start Initial search speed (m/s)
+   *
+   * @return Speed to fly (m/s)
+   */
+  gcc_pure
+  fixed SolveSpeedToFly(fixed sink_rate, fixed head_wind,
+                        fixed v_start) const;
+
+  /**
+   * Interpolate the still air speed to fly from #stf_table.
+   *
+   * @param sink_rate MacCready setting plus netto sink rate (m/s)
+   *
+   * @return Speed to fly (m/s), or a negative value if sink_rate is
+   * outside the table
+   */
+  gcc_pure
+  fixed LookupSpeedToFly(fixed sink_rate) const;
 };
 
 static_assert(std::is_trivial<GlidePolar>::value, "type is not trivial");
@@ -69,6 +69,7 @@ MacCready::SolveVertical(const GlideState &task) const
     result.height_climb = fixed(0);
     result.height_glide = fixed(0);
     result.time_elapsed = fixed(0);
+    result.time_virtual = fixed(0);
     result.validity = GlideResult::Validity::OK;
     return result;
   }
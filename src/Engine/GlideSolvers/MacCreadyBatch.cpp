@@ -0,0 +1,266 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#include "MacCreadyBatch.hpp"
+#include "GlideState.hpp"
+#include "GlidePolar.hpp"
+#include "GlideResult.hpp"
+#include "Math/Quadratic.hpp"
+
+#include <algorithm>
+
+/**
+ * The average speed over ground; this is the same quadratic equation
+ * as in GlideState::CalcAverageSpeed(), written without branches.
+ */
+static inline fixed
+CalcAverageSpeed(fixed double_head_wind, fixed wind_speed_squared,
+                 bool has_wind, fixed v_eff)
+{
+  const fixed b = double_head_wind;
+  const fixed denom = sqr(b) - Quadruple(wind_speed_squared - sqr(v_eff));
+  const fixed solution = (-b + sqrt(std::max(denom, fixed(0)))) / 2;
+  const fixed wind_speed = negative(denom) ? fixed(-1) : solution;
+  return has_wind ? wind_speed : v_eff;
+}
+
+MacCreadyBatch::MacCreadyBatch(const GlideSettings &settings,
+                               const GlidePolar &_glide_polar)
+  :glide_polar(_glide_polar),
+   mac_cready(settings, _glide_polar),
+   v_set(glide_polar.IsValid() ? glide_polar.GetVBestLD() : fixed(0)),
+   sink_rate(glide_polar.IsValid() ? glide_polar.SinkRate(v_set) : fixed(0)),
+   v_eff(v_set * glide_polar.GetCruiseEfficiency()),
+   inv_mc(glide_polar.GetInvMC()),
+   rho(glide_polar.GetSBestLD() * inv_mc),
+   inv_rho_plus_one(fixed(1) / (fixed(1) + rho)),
+   cruise_v_eff(v_eff * inv_rho_plus_one) {}
+
+bool
+MacCreadyBatch::HasFastPath() const
+{
+  /* without MacCready, the glide speed is optimised for each task
+     (MacCready::OptimiseGlide()) */
+  return glide_polar.IsValid() && positive(glide_polar.GetMC()) &&
+    positive(sink_rate);
+}
+
+void
+MacCreadyBatch::Solve(const GlideState *tasks, GlideResult *results,
+                      unsigned n) const
+{
+  if (!HasFastPath()) {
+    for (unsigned i = 0; i < n; ++i)
+      results[i] = mac_cready.Solve(tasks[i]);
+    return;
+  }
+
+  for (unsigned i = 0; i < n; i += BLOCK_SIZE)
+    SolveBlock(tasks + i, results + i, std::min(n - i, unsigned(BLOCK_SIZE)));
+}
+
+void
+MacCreadyBatch::SolveBlock(const GlideState *tasks, GlideResult *results,
+                           unsigned n) const
+{
+  fixed distance[BLOCK_SIZE], altitude_difference[BLOCK_SIZE];
+  fixed double_head_wind[BLOCK_SIZE], wind_speed_squared[BLOCK_SIZE];
+  bool has_wind[BLOCK_SIZE];
+
+  for (unsigned i = 0; i < n; ++i) {
+    const GlideState &task = tasks[i];
+    distance[i] = task.vector.distance;
+    altitude_difference[i] = task.altitude_difference;
+    double_head_wind[i] = Double(task.head_wind);
+    wind_speed_squared[i] = sqr(task.wind.norm);
+    has_wind[i] = task.wind.IsNonZero();
+  }
+
+  /* the direction of the wind drift; usually all tasks share the
+     same wind, so this is calculated only once */
+  std::pair<fixed, fixed> sc_wind[BLOCK_SIZE];
+  for (unsigned i = 0; i < n; ++i) {
+    if (i > 0 && tasks[i].wind.bearing == tasks[i - 1].wind.bearing)
+      sc_wind[i] = sc_wind[i - 1];
+    else
+      sc_wind[i] = tasks[i].wind.bearing.Reciprocal().SinCos();
+  }
+
+  fixed glide_speed[BLOCK_SIZE], cruise_speed[BLOCK_SIZE];
+  for (unsigned i = 0; i < n; ++i) {
+    glide_speed[i] = CalcAverageSpeed(double_head_wind[i],
+                                      wind_speed_squared[i], has_wind[i],
+                                      v_eff);
+    cruise_speed[i] = CalcAverageSpeed(double_head_wind[i],
+                                       wind_speed_squared[i], has_wind[i],
+                                       cruise_v_eff);
+  }
+
+  /* the distance which can be covered in final glide; see
+     MacCready::SolveGlide() with allow_partial=true */
+  fixed glide_distance[BLOCK_SIZE];
+  for (unsigned i = 0; i < n; ++i) {
+    const fixed vndh = glide_speed[i] * altitude_difference[i];
+    glide_distance[i] = sink_rate * distance[i] > vndh
+      ? vndh / sink_rate
+      : distance[i];
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    const GlideState &task = tasks[i];
+
+    if (!positive(distance[i]) ||
+        (!negative(altitude_difference[i]) && !positive(glide_speed[i]))) {
+      /* no distance to travel, or too much wind to glide */
+      results[i] = mac_cready.Solve(task);
+      continue;
+    }
+
+    if (negative(altitude_difference[i])) {
+      // whole task climb-cruise
+      results[i] = SolveCruise(task, cruise_speed[i], sc_wind[i]);
+      continue;
+    }
+
+    // calc first final glide part
+    GlideResult &result = results[i];
+    result = GlideResult(task, v_set);
+    result.validity = GlideResult::Validity::OK;
+    result.vector.distance = glide_distance[i];
+
+    const fixed time_cruise = result.vector.distance / glide_speed[i];
+    result.time_elapsed = time_cruise;
+    result.height_climb = fixed(0);
+    result.height_glide = time_cruise * sink_rate;
+    result.pure_glide_height = result.height_glide;
+    result.altitude_difference -= result.height_glide;
+    result.pure_glide_altitude_difference -= result.pure_glide_height;
+
+    if (positive(inv_mc))
+      // equivalent time to gain the height that was used
+      result.time_virtual = result.height_glide * inv_mc;
+    else
+      result.time_virtual = fixed(0);
+
+    if (!positive(distance[i] - result.vector.distance))
+      // whole task final glided
+      continue;
+
+    // climb-cruise remainder of way
+
+    GlideState sub_task = task;
+    sub_task.vector.distance -= result.vector.distance;
+    sub_task.altitude_difference -= result.height_glide;
+
+    result.Add(SolveCruise(sub_task, cruise_speed[i], sc_wind[i]));
+  }
+}
+
+fixed
+MacCreadyBatch::DriftedDistance(const GlideState &task, const fixed time,
+                                const std::pair<fixed, fixed> sc_wind)
+{
+  if (task.wind.IsZero())
+    return task.vector.distance;
+
+  const fixed distance_wind = task.wind.norm * time;
+  const fixed sin_wind = sc_wind.first, cos_wind = sc_wind.second;
+
+  const fixed distance_task = task.vector.distance;
+  const auto sc_task = task.vector.bearing.SinCos();
+  const fixed sin_task = sc_task.first, cos_task = sc_task.second;
+
+  const fixed dx = distance_task * sin_task - distance_wind * sin_wind;
+  const fixed dy = distance_task * cos_task - distance_wind * cos_wind;
+
+  return MediumHypot(dx, dy);
+}
+
+fixed
+MacCreadyBatch::GetLDOverGround(const GlideState &task) const
+{
+  if (task.wind.IsZero())
+    return glide_polar.GetBestLD();
+
+  /* this is the same angle as in GlidePolar::GetLDOverGround():
+     GlideState::CalcSpeedups() subtracts the task bearing from the
+     reciprocal wind bearing */
+  const fixed c_theta = task.effective_wind_angle.cos();
+
+  const fixed wind_ld = task.wind.norm / glide_polar.GetSBestLD();
+
+  Quadratic q(- Double(wind_ld * c_theta),
+              sqr(wind_ld) - sqr(glide_polar.GetBestLD()));
+
+  if (q.Check())
+    return std::max(fixed(0), q.SolutionMax());
+
+  return fixed(0);
+}
+
+GlideResult
+MacCreadyBatch::SolveCruise(const GlideState &task,
+                            const fixed estimated_speed,
+                            const std::pair<fixed, fixed> sc_wind) const
+{
+  GlideResult result(task, v_set);
+
+  if (!positive(estimated_speed)) {
+    result.validity = GlideResult::Validity::WIND_EXCESSIVE;
+    result.vector.distance = fixed(0);
+    return result;
+  }
+
+  const fixed mc = glide_polar.GetMC();
+
+  fixed time_climb_drift = fixed(0);
+  fixed distance_with_climb_drift = task.vector.distance;
+
+  // Calculate additional distance_with_climb_drift/time due to wind drift while circling
+  if (negative(task.altitude_difference)) {
+    time_climb_drift = -task.altitude_difference * inv_mc;
+    distance_with_climb_drift = DriftedDistance(task, time_climb_drift,
+                                                sc_wind);
+  }
+
+  // Estimated time to finish the task
+  const fixed estimated_time = distance_with_climb_drift / estimated_speed;
+  // Estimated time in cruise
+  const fixed time_cruise = estimated_time * inv_rho_plus_one;
+  // Estimated time in climb (including wind drift while circling)
+  const fixed time_climb = time_cruise * rho + time_climb_drift;
+
+  const fixed sink_glide = time_cruise * glide_polar.GetSBestLD();
+
+  result.time_elapsed = estimated_time + time_climb_drift;
+  result.time_virtual = fixed(0);
+  result.height_climb = time_climb * mc;
+  result.height_glide = sink_glide;
+  result.altitude_difference -= sink_glide;
+  result.effective_wind_speed *= fixed(1) + rho;
+
+  result.validity = GlideResult::Validity::OK;
+  result.pure_glide_height = task.vector.distance / GetLDOverGround(task);
+  result.pure_glide_altitude_difference -= result.pure_glide_height;
+
+  return result;
+}
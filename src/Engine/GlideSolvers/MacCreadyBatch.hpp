@@ -0,0 +1,116 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#ifndef XCSOAR_MACCREADY_BATCH_HPP
+#define XCSOAR_MACCREADY_BATCH_HPP
+
+#include "MacCready.hpp"
+
+#include <utility>
+
+/**
+ * Solves many independent glides with the same #GlidePolar and
+ * #GlideSettings, e.g. to all landable waypoints in range.  The
+ * results are the same as calling MacCready::Solve() for each
+ * #GlideState, apart from rounding.
+ *
+ * The glides are processed in blocks: the average speeds and the
+ * final glide distances are copied into arrays and calculated in
+ * loops without branches, which the compiler can vectorise; the
+ * values which depend only on the polar are calculated once.  Glides
+ * with zero MacCready, no distance or excessive wind are passed to
+ * the scalar MacCready solver.
+ */
+class MacCreadyBatch {
+  /** The number of glides per block */
+  static constexpr unsigned BLOCK_SIZE = 64;
+
+  const GlidePolar &glide_polar;
+  const MacCready mac_cready;
+
+  /** Cruise speed at current MC (m/s) */
+  const fixed v_set;
+
+  /** Sink rate at #v_set (m/s) */
+  const fixed sink_rate;
+
+  /** #v_set multiplied with the cruise efficiency (m/s) */
+  const fixed v_eff;
+
+  /** Inverse MC value (s/m) */
+  const fixed inv_mc;
+
+  /** Sink rate divided by MC value, see MacCready::SolveCruise() */
+  const fixed rho;
+
+  /** Quotient of resulting speed over cruise speed (0 .. 1) */
+  const fixed inv_rho_plus_one;
+
+  /** The cruise speed in climb-cruise before applying the wind (m/s) */
+  const fixed cruise_v_eff;
+
+public:
+  MacCreadyBatch(const GlideSettings &settings,
+                 const GlidePolar &glide_polar);
+
+  /**
+   * Solve the glides.
+   *
+   * @param tasks an array of #n tasks
+   * @param results an array of #n results
+   */
+  void Solve(const GlideState *tasks, GlideResult *results,
+             unsigned n) const;
+
+private:
+  gcc_pure
+  bool HasFastPath() const;
+
+  void SolveBlock(const GlideState *tasks, GlideResult *results,
+                  unsigned n) const;
+
+  /**
+   * Same as MacCready::SolveCruise(), with the average speed over
+   * ground and the direction of the wind drift calculated by the
+   * caller.
+   */
+  gcc_pure
+  GlideResult SolveCruise(const GlideState &task, fixed estimated_speed,
+                          std::pair<fixed, fixed> sc_wind) const;
+
+  /**
+   * Same as GlideState::DriftedDistance(), with the sine and cosine
+   * of the wind drift direction calculated by the caller.
+   */
+  gcc_pure
+  static fixed DriftedDistance(const GlideState &task, fixed time,
+                               std::pair<fixed, fixed> sc_wind);
+
+  /**
+   * Same as GlidePolar::GetLDOverGround(), but uses the effective
+   * wind angle of the #GlideState.
+   */
+  gcc_pure
+  fixed GetLDOverGround(const GlideState &task) const;
+};
+
+#endif
@@ -235,7 +235,7 @@ AirspaceRoute::Synchronise(const Airspaces &master,
                                      Half(origin.Distance(destination)),
                                      condition)) {
     if (!m_airspaces.IsEmpty())
-      dirty = true;
+      ClearSolution();
   }
 }
 
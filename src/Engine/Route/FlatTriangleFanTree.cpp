@@ -25,6 +25,7 @@
 #include "ReachFanParms.hpp"
 #include "Util/GlobalSliceAllocator.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #define REACH_BUFFER 1
 #define REACH_SWEEP (ROUTEPOLAR_Q1-REACH_BUFFER)
@@ -104,9 +105,14 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
 
   FillReach(origin, 0, ROUTEPOLAR_POINTS + 1, parms);
 
+  const bool parallel = parms.worker_pool != nullptr &&
+    parms.worker_pool->GetThreadCount() > 0;
+
   for (parms.set_depth = 0; parms.set_depth < REACH_MAX_DEPTH;
       ++parms.set_depth)
-    if (!FillDepth(origin, parms))
+    if (!(parallel
+          ? FillDepthParallel(origin, parms)
+          : FillDepth(origin, parms)))
       // stop searching
       break;
 
@@ -114,6 +120,87 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
   CalcBB();
 }
 
+void
+FlatTriangleFanTree::CollectDepth(unsigned char _depth,
+                                  std::vector<FlatTriangleFanTree *> &result)
+{
+  if (depth == _depth)
+    result.push_back(this);
+  else if (depth < _depth)
+    for (auto &child : children)
+      child.CollectDepth(_depth, result);
+}
+
+bool
+FlatTriangleFanTree::FillDepthParallel(const AFlatGeoPoint &origin,
+                                       ReachFanParms &parms)
+{
+  std::vector<FlatTriangleFanTree *> nodes;
+  CollectDepth(parms.set_depth, nodes);
+
+  /* enumerating the gaps is cheap; do it here, so each gap becomes a
+     work item */
+  struct Gap {
+    unsigned node;
+    const std::pair<RouteLink, RouteLink> *edges;
+    FlatTriangleFanTree child;
+    bool filled;
+
+    Gap(unsigned _node, const std::pair<RouteLink, RouteLink> &_edges,
+        unsigned char child_depth)
+      :node(_node), edges(&_edges), child(child_depth), filled(false) {}
+  };
+
+  std::vector<GapVector> node_gaps(nodes.size());
+  for (unsigned i = 0; i < nodes.size(); ++i)
+    if (!nodes[i]->gaps_filled)
+      nodes[i]->FindGaps(origin, parms, node_gaps[i]);
+
+  std::vector<Gap> gaps;
+  for (unsigned i = 0; i < nodes.size(); ++i)
+    for (const auto &edges : node_gaps[i])
+      gaps.emplace_back(i, edges, nodes[i]->depth + 1);
+
+  /* CheckGap() only reads the tree, the terrain and the polars, and
+     each work item writes only to its own child, which is not yet
+     part of the tree */
+  parms.worker_pool->Run(gaps.size(),
+                         [&nodes, &gaps, &origin, &parms](unsigned i) {
+      Gap &gap = gaps[i];
+      ReachFanParms local(parms);
+      gap.filled = nodes[gap.node]->CheckGap(origin, gap.edges->first,
+                                             gap.edges->second,
+                                             gap.child, local);
+    });
+
+  /* merge the children in tree order, applying the limits of
+     FillDepth(); the children are moved into the tree (which uses the
+     global slice allocator) by this thread only */
+  auto gap = gaps.begin();
+  for (unsigned i = 0; i < nodes.size(); ++i) {
+    FlatTriangleFanTree &node = *nodes[i];
+    if (node.gaps_filled)
+      continue;
+    node.gaps_filled = true;
+
+    if (parms.vertex_counter > REACH_MAX_VERTICES)
+      return false;
+    if (parms.fan_counter > REACH_MAX_FANS)
+      return false;
+
+    for (; gap != gaps.end() && gap->node == i; ++gap) {
+      if (!gap->filled)
+        continue;
+
+      parms.vertex_counter += gap->child.vs.size();
+      parms.fan_counter++;
+      node.children.push_back(std::move(gap->child));
+    }
+  }
+
+  return true;
+}
+
 void
 FlatTriangleFanTree::DummyReach(const AFlatGeoPoint &ao)
 {
@@ -178,7 +265,9 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
 }
 
 void
-FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
+FlatTriangleFanTree::FindGaps(const AFlatGeoPoint &origin,
+                              const ReachFanParms &parms,
+                              GapVector &gaps) const
 {
   // worth checking for gaps?
   if (vs.size() > 2 && parms.rpolars.IsTurningReachEnabled()) {
@@ -193,14 +282,33 @@ FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
         continue;
 
       const RouteLink e(RoutePoint(*x, RoughAltitude(0)), o, parms.task_proj);
-      // check if children need to be added
-      CheckGap(origin, e_last, e, parms);
+      gaps.emplace_back(e_last, e);
 
       e_last = e;
     }
   }
 }
 
+void
+FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
+{
+  GapVector gaps;
+  FindGaps(origin, parms, gaps);
+
+  for (const auto &edges : gaps) {
+    // check if children need to be added
+    children.emplace_back(depth + 1);
+    FlatTriangleFanTree &child = children.back();
+
+    if (CheckGap(origin, edges.first, edges.second, child, parms)) {
+      parms.vertex_counter += child.vs.size();
+      parms.fan_counter++;
+    } else
+      // don't need the child
+      children.pop_back();
+  }
+}
+
 void
 FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint &o,
                                        ReachFanParms &parms)
@@ -210,17 +318,31 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint &o,
     return;
   }
 
-  for (const auto &x : vs) {
-    const FlatGeoPoint av = (o + x) * fixed(0.5);
-    const GeoPoint p = parms.task_proj.Unproject(av);
-    short h = parms.terrain->GetHeight(p);
-
-    if (RasterBuffer::IsWater(h))
-      /* water: assume 0m MSL */
-      parms.terrain_counter++;
-    else if (!RasterBuffer::IsInvalid(h)) {
-      parms.terrain_counter++;
-      parms.terrain_base += h;
+  /* look up the terrain heights in chunks, which is faster than one
+     by one */
+  constexpr unsigned CHUNK = 64;
+  GeoPoint points[CHUNK];
+  short heights[CHUNK];
+
+  for (auto i = vs.begin(), end = vs.end(); i != end;) {
+    unsigned n = 0;
+    for (; i != end && n < CHUNK; ++i, ++n) {
+      const FlatGeoPoint av = (o + *i) * fixed(0.5);
+      points[n] = parms.task_proj.Unproject(av);
+    }
+
+    parms.terrain->GetHeights(points, heights, n);
+
+    for (unsigned j = 0; j < n; ++j) {
+      const short h = heights[j];
+
+      if (RasterBuffer::IsWater(h))
+        /* water: assume 0m MSL */
+        parms.terrain_counter++;
+      else if (!RasterBuffer::IsInvalid(h)) {
+        parms.terrain_counter++;
+        parms.terrain_base += h;
+      }
     }
   }
 
@@ -230,7 +352,8 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint &o,
 
 bool
 FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                              const RouteLink &e_2, ReachFanParms &parms)
+                              const RouteLink &e_2, FlatTriangleFanTree &child,
+                              ReachFanParms &parms) const
 {
   const bool side = (e_1.d > e_2.d);
   const RouteLink &e_long = (side ? e_1 : e_2);
@@ -259,9 +382,6 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     index_right = e_long.polar_index + REACH_SWEEP;
   }
 
-  children.emplace_back(depth + 1);
-  FlatTriangleFanTree &child = children.back();
-
   for (fixed f = f0; f < fixed(0.9); f += fixed(0.1)) {
     // find corner point
     const FlatGeoPoint px = (dp * f + n);
@@ -274,18 +394,12 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     child.FillReach(x, index_left, index_right, parms);
 
     // prune child if empty or single spike
-    if (child.vs.size() > 3) {
-      parms.vertex_counter += child.vs.size();
-      parms.fan_counter++;
+    if (child.vs.size() > 3)
       return true;
-    }
 
     child.vs.clear();
   }
 
-  // don't need the child
-  children.pop_back();
-
   return false;
 }
 
@@ -28,6 +28,8 @@
 #include "FlatTriangleFan.hpp"
 
 #include <list>
+#include <vector>
+#include <utility>
 
 class TaskProjection;
 struct GeoPoint;
@@ -51,6 +53,11 @@ public:
   typedef std::list<FlatTriangleFanTree,
                     GlobalSliceAllocator<FlatTriangleFanTree, 128u> > LeafVector;
 
+  /**
+   * A list of pairs of neighbouring edges, see CheckGap().
+   */
+  typedef std::vector<std::pair<RouteLink, RouteLink>> GapVector;
+
 protected:
   FlatBoundingBox bb_children;
   LeafVector children;
@@ -97,8 +104,16 @@ public:
   bool FillDepth(const AFlatGeoPoint &origin, ReachFanParms &parms);
   void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms);
 
+  /**
+   * Check the gap between two neighbouring edges, and try to fill it
+   * with a child fan.
+   *
+   * @param child an empty fan which receives the result
+   * @return true if the gap was filled
+   */
   bool CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                const RouteLink &e_2, ReachFanParms &parms);
+                const RouteLink &e_2, FlatTriangleFanTree &child,
+                ReachFanParms &parms) const;
 
   bool FindPositiveArrival(const FlatGeoPoint &n,
                            const ReachFanParms &parms,
@@ -110,6 +125,22 @@ public:
 
   void UpdateTerrainBase(const FlatGeoPoint &origin, ReachFanParms &parms);
 
+private:
+  /**
+   * Parallel version of FillDepth() for the root of the tree: the
+   * gaps of all fans at the current depth are checked on the
+   * #WorkerPool, and the new children are merged in the same order
+   * and with the same limits as FillDepth() would add them.
+   */
+  bool FillDepthParallel(const AFlatGeoPoint &origin, ReachFanParms &parms);
+
+  void CollectDepth(unsigned char _depth,
+                    std::vector<FlatTriangleFanTree *> &result);
+  void FindGaps(const AFlatGeoPoint &origin, const ReachFanParms &parms,
+                GapVector &gaps) const;
+
+public:
+
   gcc_pure
   RoughAltitude DirectArrival(const FlatGeoPoint &dest,
                               const ReachFanParms &parms) const;
@@ -49,6 +49,7 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
   const RoughAltitude h2(RasterBuffer::IsSpecial(h) ? 0 : h);
 
   ReachFanParms parms(rpolars, task_proj, (int)terrain_base, terrain);
+  parms.worker_pool = worker_pool;
   const AFlatGeoPoint ao(task_proj.ProjectInteger(origin), origin.altitude);
 
   if (!RasterBuffer::IsInvalid(h) &&
@@ -31,6 +31,7 @@ class RoutePolars;
 class RasterMap;
 class GeoBounds;
 struct ReachResult;
+class WorkerPool;
 
 class ReachFan
 {
@@ -38,8 +39,10 @@ class ReachFan
   FlatTriangleFanTree root;
   RoughAltitude terrain_base;
 
+  WorkerPool *worker_pool;
+
 public:
-  ReachFan():terrain_base(0) {}
+  ReachFan():terrain_base(0), worker_pool(nullptr) {}
 
   friend class PrintHelper;
 
@@ -49,6 +52,15 @@ public:
 
   void Reset();
 
+  /**
+   * Expand the turning reach on the given #WorkerPool.  The result is
+   * the same as without it.  Pass nullptr to calculate it in the
+   * calling thread (the default).
+   */
+  void SetWorkerPool(WorkerPool *_worker_pool) {
+    worker_pool = _worker_pool;
+  }
+
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
              const RasterMap *terrain, const bool do_solve = true);
 
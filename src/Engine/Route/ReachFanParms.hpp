@@ -27,6 +27,7 @@
 
 class TaskProjection;
 class RasterMap;
+class WorkerPool;
 
 struct ReachFanParms {
   const RoutePolars &rpolars;
@@ -38,6 +39,12 @@ struct ReachFanParms {
   unsigned vertex_counter;
   unsigned char set_depth;
 
+  /**
+   * If set, the child fans of each depth are calculated in parallel
+   * on this pool.
+   */
+  WorkerPool *worker_pool;
+
   ReachFanParms(const RoutePolars& _rpolars,
                 const TaskProjection& _task_proj,
                 const short _terrain_base,
@@ -47,7 +54,8 @@ struct ReachFanParms {
     terrain_counter(0),
     fan_counter(0),
     vertex_counter(0),
-    set_depth(0) {};
+    set_depth(0),
+    worker_pool(nullptr) {};
 
   FlatGeoPoint reach_intercept(const int index, const AGeoPoint& ao) const {
     return rpolars.ReachIntercept(index, ao, terrain, task_proj);
@@ -46,6 +46,7 @@ RoutePlanner::Reset()
   destination_last = AFlatGeoPoint(0, 0, RoughAltitude(0));
   dirty = true;
   solution_route.clear();
+  solution_nodes.clear();
   planner.Clear();
   unique_links.clear();
   h_min = RoughAltitude(-1);
@@ -86,6 +87,9 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
     if (IsTrivial())
       return false;
 
+    if (!(s_origin == origin_last))
+      solution_nodes.clear();
+
     dirty = false;
     origin_last = s_origin;
     destination_last = s_destination;
@@ -113,6 +117,13 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   if (!rpolars_route.IsAchievable(e_test))
     return false;
 
+  if (ReuseSolution()) {
+    CorrectRounding(origin, destination);
+    return true;
+  }
+
+  solution_nodes.clear();
+
   count_dij = 0;
   count_airspace = 0;
   count_terrain = 0;
@@ -139,10 +150,13 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
     if (is_final) // @todo: allow fallback if failed
     { // copy improving solutions
       Route this_solution;
-      unsigned d = FindSolution(node, this_solution);
+      RouteNodeVector this_nodes;
+      unsigned d = FindSolution(node, this_solution, this_nodes);
       if (d < best_d) {
         best_d = d;
         solution_route = this_solution;
+        solution_nodes = this_nodes;
+        solution_center = task_projection.GetCenter();
       }
     }
 
@@ -164,17 +178,7 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   count_unique = unique_links.size();
 
   if (retval) {
-    // correct solution for rounding
-    assert(solution_route.size()>=2);
-    for (auto &i : solution_route) {
-      FlatGeoPoint p(task_projection.ProjectInteger(i));
-      if (p == origin_last) {
-        i = AGeoPoint(origin, i.altitude);
-      } else if (p == destination_last) {
-        i = AGeoPoint(destination, i.altitude);
-      }
-    }
-
+    CorrectRounding(origin, destination);
   } else {
     solution_route.clear();
     solution_route.push_back(origin);
@@ -187,28 +191,60 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   return retval;
 }
 
+void
+RoutePlanner::CorrectRounding(const AGeoPoint &origin,
+                              const AGeoPoint &destination)
+{
+  // correct solution for rounding
+  assert(solution_route.size()>=2);
+  for (auto &i : solution_route) {
+    FlatGeoPoint p(task_projection.ProjectInteger(i));
+    if (p == origin_last) {
+      i = AGeoPoint(origin, i.altitude);
+    } else if (p == destination_last) {
+      i = AGeoPoint(destination, i.altitude);
+    }
+  }
+}
+
 unsigned
 RoutePlanner::FindSolution(const RoutePoint &final_point,
-                           Route &this_route) const
+                           Route &this_route, RouteNodeVector &nodes) const
 {
   // we are iterating from goal (aircraft) backwards to start (target)
 
+  nodes.clear();
+
   RoutePoint p(final_point);
   RoutePoint p_last(p);
-  bool finished = false;
-
-  this_route.insert(this_route.begin(),
-                    AGeoPoint(task_projection.Unproject(p), p.altitude));
 
-  do {
+  nodes.push_back(p);
+  while (true) {
     p_last = p;
     p = planner.GetPredecessor(p);
+    if (p == p_last)
+      break;
 
-    if (p == p_last) {
-      finished = true;
-      continue;
-    }
+    nodes.push_back(p);
+  }
+
+  std::reverse(nodes.begin(), nodes.end());
+  BuildRoute(nodes, this_route);
+
+  return planner.GetNodeValue(final_point).h;
+}
+
+void
+RoutePlanner::BuildRoute(const RouteNodeVector &nodes, Route &this_route) const
+{
+  assert(!nodes.empty());
+
+  this_route.insert(this_route.begin(),
+                    AGeoPoint(task_projection.Unproject(nodes.back()),
+                              nodes.back().altitude));
 
+  for (auto i = nodes.rbegin() + 1; i != nodes.rend(); ++i) {
+    const RoutePoint &p = *i, &p_last = *(i - 1);
     if (p.altitude < p_last.altitude &&
         !((FlatGeoPoint)p == (FlatGeoPoint)p_last)) {
       // create intermediate point for part cruise, part glide
@@ -233,9 +269,59 @@ RoutePlanner::FindSolution(const RoutePoint &final_point,
     this_route.insert(this_route.begin(),
                       AGeoPoint(task_projection.Unproject(p), p.altitude));
     // @todo: assert check_clearance
-  } while (!finished);
+  }
+}
 
-  return planner.GetNodeValue(final_point).h;
+bool
+RoutePlanner::IsLinkValid(const RoutePoint &a, const RoutePoint &b)
+{
+  const RouteLink e(a, b, task_projection);
+  RoutePoint inx;
+  return CheckClearance(e, inx) &&
+    rpolars_route.IsAchievable(e, true) &&
+    rpolars_route.CalcTime(e) != UINT_MAX;
+}
+
+/**
+ * ReuseSolution() accepts a destination which has moved by at most
+ * this number of flat projection units (about 100m each) on both
+ * axes.
+ */
+static constexpr int ROUTE_REUSE_MAX_STEP = 10;
+
+bool
+RoutePlanner::ReuseSolution()
+{
+  if (solution_nodes.size() < 2 ||
+      !(solution_center == task_projection.GetCenter()) ||
+      !(solution_nodes.front() == origin_last))
+    return false;
+
+  const RoutePoint destination = destination_last;
+  const FlatGeoPoint delta = destination - solution_nodes.back();
+  if (std::max(abs(delta.longitude), abs(delta.latitude)) >
+      ROUTE_REUSE_MAX_STEP)
+    return false;
+
+  const unsigned n = solution_nodes.size();
+
+  /* a new search would find a shortcut */
+  for (unsigned i = 0; i + 2 < n; ++i)
+    if (IsLinkValid(solution_nodes[i], destination))
+      return false;
+
+  for (unsigned i = 0; i + 2 < n; ++i)
+    if (!IsLinkValid(solution_nodes[i], solution_nodes[i + 1]))
+      return false;
+
+  if (!IsLinkValid(solution_nodes[n - 2], destination))
+    return false;
+
+  solution_nodes.back() = destination;
+
+  solution_route.clear();
+  BuildRoute(solution_nodes, solution_route);
+  return true;
 }
 
 bool
@@ -370,7 +456,12 @@ RoutePlanner::UpdatePolar(const GlideSettings &settings,
                            const GlidePolar &safety_polar,
                            const SpeedVector &wind)
 {
+  const RoutePolars old_polars = rpolars_route;
   rpolars_route.Initialise(settings, task_polar, wind);
+  if (!rpolars_route.IsSamePerformance(old_polars))
+    /* the previous solution may not be optimal anymore */
+    solution_nodes.clear();
+
   switch (reach_polar_mode) {
   case RoutePlannerConfig::Polar::TASK:
     rpolars_reach = rpolars_route;
@@ -32,8 +32,10 @@
 
 #include <utility>
 #include <algorithm>
+#include <vector>
 
 class GlidePolar;
+class WorkerPool;
 
 // define PLANNER_SET if STL tr1 extensions are not to be used
 // (with performance penalty)
@@ -155,6 +157,18 @@ private:
   /** Result route found by solve() method */
   Route solution_route;
 
+  typedef std::vector<RoutePoint> RouteNodeVector;
+
+  /**
+   * The search nodes of the last solution found by the A* search,
+   * from the origin to the destination.  Empty if there is none.
+   * See ReuseSolution().
+   */
+  RouteNodeVector solution_nodes;
+
+  /** The projection centre which #solution_nodes refer to */
+  GeoPoint solution_center;
+
   /** Origin at last call to solve() */
   AFlatGeoPoint origin_last;
   /** Destination at last call to solve() */
@@ -191,6 +205,14 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Use the given #WorkerPool for the reach calculation, see
+   * ReachFan::SetWorkerPool().
+   */
+  void SetWorkerPool(WorkerPool *worker_pool) {
+    reach.SetWorkerPool(worker_pool);
+  }
+
   bool IsReachEmpty() const {
     return reach.IsEmpty();
   }
@@ -299,6 +321,15 @@ protected:
     return !dirty;
   }
 
+  /**
+   * Discard the previous solution, so the next Solve() call performs
+   * a full search.  Call this when the obstacles have changed.
+   */
+  void ClearSolution() {
+    dirty = true;
+    solution_nodes.clear();
+  }
+
   /**
    * Add a link to candidates for search
    *
@@ -447,11 +478,40 @@ private:
    *
    * @param final_point Final point from search to backtrack
    * @param this_route Route to copy into
+   * @param nodes receives the search nodes of the route
    *
    * @return Destination score (s)
    */
   unsigned FindSolution(const RoutePoint &final_point,
-                        Route& this_route) const;
+                        Route& this_route, RouteNodeVector &nodes) const;
+
+  /**
+   * Construct a Route from the search nodes of a solution.
+   */
+  void BuildRoute(const RouteNodeVector &nodes, Route &this_route) const;
+
+  /**
+   * Replace the end points of the solution with the exact locations.
+   */
+  void CorrectRounding(const AGeoPoint &origin, const AGeoPoint &destination);
+
+  /**
+   * Is the link from a to b clear of obstacles and achievable?
+   */
+  bool IsLinkValid(const RoutePoint &a, const RoutePoint &b);
+
+  /**
+   * Attempt to reuse the previous solution after the destination (the
+   * aircraft) has moved a short distance, while the origin, the
+   * projection and the polar are unchanged.  The last search node is
+   * moved to the new destination and all links are checked again.
+   * The previous solution is rejected if a link is obstructed now, or
+   * if a shortcut to the new destination is possible.
+   *
+   * @return true if the solution was reused, false if a new search
+   * is required
+   */
+  bool ReuseSolution();
 };
 
 #endif
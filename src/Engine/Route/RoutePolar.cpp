@@ -56,6 +56,19 @@ RoutePolar::Initialise(const GlideSettings &settings, const GlidePolar& polar,
   }
 }
 
+bool
+RoutePolar::operator==(const RoutePolar &other) const
+{
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i) {
+    const RoutePolarPoint &a = points[i], &b = other.points[i];
+    if (a.valid != b.valid ||
+        (a.valid && (a.slowness != b.slowness || a.gradient != b.gradient)))
+      return false;
+  }
+
+  return true;
+}
+
 void
 RoutePolar::IndexToDXDY(const int index, int& dx, int& dy)
 {
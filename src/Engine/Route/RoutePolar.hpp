@@ -108,6 +108,12 @@ public:
    */
   static void IndexToDXDY(const int index, int& dx, int& dy);
 
+  /**
+   * Do both objects contain the same performance data?
+   */
+  gcc_pure
+  bool operator==(const RoutePolar &other) const;
+
 private:
   GlideResult SolveTask(const GlideSettings &settings, const GlidePolar& polar,
                         const SpeedVector &wind,
@@ -68,6 +68,18 @@ public:
   void Initialise(const GlideSettings &settings, const GlidePolar& polar,
                   const SpeedVector& wind);
 
+  /**
+   * Was this object initialised with the same performance data as
+   * the other one?  The configuration set by SetConfig() is not
+   * compared.
+   */
+  gcc_pure
+  bool IsSamePerformance(const RoutePolars &other) const {
+    return polar_glide == other.polar_glide &&
+      polar_cruise == other.polar_cruise &&
+      inv_mc == other.inv_mc;
+  }
+
   /**
    * Calculate the time required to fly the link.  Returns UINT_MAX
    * if flight is impossible.  Climbs above the cruise altitude
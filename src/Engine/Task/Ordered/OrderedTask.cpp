@@ -157,6 +157,7 @@ void
 OrderedTask::UpdateGeometry()
 {
   UpdateStatsGeometry();
+  solver_caches.Invalidate();
 
   if (!HasStart() || !task_points[0])
     return;
@@ -660,6 +661,7 @@ OrderedTask::UpdateIdle(const AircraftState &state,
         TaskOptTarget tot(task_points, active_task_point, state,
                           task_behaviour.glide, glide_polar,
                           *ap, task_projection, taskpoint_start);
+        tot.SetCache(solver_caches.opt_target);
         tot.search(fixed(0.5));
       }
     }
@@ -923,6 +925,7 @@ OrderedTask::SetActiveTaskPoint(unsigned index)
   task_advance.SetArmed(false);
   active_task_point = index;
   force_full_update = true;
+  solver_caches.Invalidate();
 }
 
 TaskWaypoint*
@@ -1055,6 +1058,7 @@ OrderedTask::CalcBestMC(const AircraftState &aircraft,
   // note setting of lower limit on mc
   TaskBestMc bmc(task_points, active_task_point, aircraft,
                  task_behaviour.glide, glide_polar);
+  bmc.SetCache(solver_caches.best_mc);
   return bmc.search(glide_polar.GetMC(), best);
 }
 
@@ -1122,6 +1126,7 @@ OrderedTask::CalcMinTarget(const AircraftState &aircraft,
     TaskMinTarget bmt(task_points, active_task_point, aircraft,
                       task_behaviour.glide, glide_polar,
                       t_rem, taskpoint_start);
+    bmt.SetCache(solver_caches.min_target);
     fixed p = bmt.search(fixed(0));
     return p;
   }
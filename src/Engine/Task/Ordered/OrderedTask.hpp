@@ -28,6 +28,7 @@
 #include "SmartTaskAdvance.hpp"
 #include "Util/DereferenceIterator.hpp"
 #include "Util/StaticString.hpp"
+#include "Math/ZeroFinder.hpp"
 
 #include <assert.h>
 #include <vector>
@@ -69,6 +70,25 @@ public:
   typedef DereferenceContainerAdapter<const OrderedTaskPointVector,
                                       const OrderedTaskPoint> ConstTaskPointList;
 
+  /**
+   * The previous solutions of the iterative task solvers, from which
+   * the next cycle warm-starts them, and their convergence statistics.
+   */
+  struct SolverCaches {
+    /** TaskBestMc, see CalcBestMC() */
+    ZeroFinder::Cache best_mc;
+    /** TaskMinTarget, see CalcMinTarget() */
+    ZeroFinder::Cache min_target;
+    /** TaskOptTarget for the active AAT point, see UpdateIdle() */
+    ZeroFinder::Cache opt_target;
+
+    void Invalidate() {
+      best_mc.Invalidate();
+      min_target.Invalidate();
+      opt_target.Invalidate();
+    }
+  };
+
 private:
   OrderedTaskPointVector task_points;
   OrderedTaskPointVector optional_start_points;
@@ -90,6 +110,9 @@ private:
   /** name of task */
   StaticString<40> task_name;
 
+  /** modified by the const method CalcBestMC() */
+  mutable SolverCaches solver_caches;
+
 public:
   /**
    * Constructor.
@@ -376,6 +399,14 @@ public:
     return task_projection;
   }
 
+  /**
+   * Accessor for the warm-start state of the task solvers, for
+   * profiling their convergence.
+   */
+  const SolverCaches &GetSolverCaches() const {
+    return solver_caches;
+  }
+
   void CheckDuplicateWaypoints(Waypoints& waypoints);
 
   /**
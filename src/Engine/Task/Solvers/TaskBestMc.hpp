@@ -80,6 +80,8 @@ public:
 
   bool search(const fixed mc, fixed &result);
 
+  using ZeroFinder::SetCache;
+
 private:
 
   /**
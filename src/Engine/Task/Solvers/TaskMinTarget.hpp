@@ -91,6 +91,8 @@ public:
    */
   fixed search(const fixed p);
 
+  using ZeroFinder::SetCache;
+
 private:
   void set_range(const fixed p);
 };
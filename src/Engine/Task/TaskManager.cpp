@@ -575,6 +575,12 @@ TaskManager::SetIntersectionTest(AbortIntersectionTest *test)
   abort_task->SetIntersectionTest(test);
 }
 
+void
+TaskManager::SetWorkerPool(WorkerPool *worker_pool)
+{
+  abort_task->SetWorkerPool(worker_pool);
+}
+
 void
 TaskManager::TakeoffAutotask(const GeoPoint &loc, const fixed terrain_alt)
 {
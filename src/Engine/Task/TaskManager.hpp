@@ -42,6 +42,7 @@ class GotoTask;
 class AlternateTask;
 class AlternateList;
 class TaskWaypoint;
+class WorkerPool;
 class AbortIntersectionTest;
 struct Waypoint;
 struct RangeAndRadial;
@@ -456,6 +457,12 @@ public:
    */
   void SetIntersectionTest(AbortIntersectionTest *test);
 
+  /**
+   * Set the #WorkerPool used by the abort task to evaluate landable
+   * waypoints.  Pass nullptr to disable.
+   */
+  void SetWorkerPool(WorkerPool *worker_pool);
+
   /**
    * When called on takeoff, will create a goto task to the nearest waypoint if
    * no other task is active.
@@ -25,11 +25,15 @@
 #include "AlternateList.hpp"
 #include "Navigation/Aircraft.hpp"
 #include "Task/Visitors/TaskPointVisitor.hpp"
-#include "Task/Solvers/TaskSolution.hpp"
+#include "GlideSolvers/GlideState.hpp"
+#include "GlideSolvers/MacCreadyBatch.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "Waypoint/WaypointVisitor.hpp"
 #include "Util/ReservablePriorityQueue.hpp"
 #include "Util/Clamp.hpp"
+#include "Thread/WorkerPool.hpp"
+
+#include <algorithm>
 
 /** min search range in m */
 static constexpr fixed min_search_range = fixed(50000);
@@ -42,6 +46,7 @@ AbortTask::AbortTask(const TaskBehaviour &_task_behaviour,
   :UnorderedTask(TaskType::ABORT, _task_behaviour),
    waypoints(wps),
    intersection_test(NULL),
+   worker_pool(nullptr),
    active_waypoint(0)
 {
   task_points.reserve(32);
@@ -135,6 +140,49 @@ IsReachable(const GlideResult &result, bool final_glide)
     : result.IsAchievable();
 }
 
+/**
+ * The number of candidates solved by one #WorkerPool item; a single
+ * MacCready solution is too cheap to be worth dispatching.
+ */
+static constexpr unsigned CANDIDATES_PER_ITEM = 16;
+
+void
+AbortTask::SolveCandidates(const AircraftState &state,
+                           AlternateList &approx_waypoints,
+                           const GlidePolar &polar) const
+{
+  const unsigned n = approx_waypoints.size();
+  const MacCreadyBatch mac_cready(task_behaviour.glide, polar);
+
+  auto solve = [&](unsigned begin, unsigned end) {
+    std::vector<GlideState> tasks;
+    tasks.reserve(end - begin);
+    for (unsigned i = begin; i < end; ++i) {
+      const UnorderedTaskPoint t(approx_waypoints[i].waypoint,
+                                 task_behaviour);
+      tasks.push_back(GlideState::Remaining(t, state, fixed(0)));
+    }
+
+    std::vector<GlideResult> results(end - begin);
+    mac_cready.Solve(tasks.data(), results.data(), end - begin);
+
+    for (unsigned i = begin; i < end; ++i)
+      approx_waypoints[i].solution = results[i - begin];
+  };
+
+  if (worker_pool == nullptr || worker_pool->GetThreadCount() == 0 ||
+      n <= CANDIDATES_PER_ITEM) {
+    solve(0, n);
+    return;
+  }
+
+  const unsigned n_items = (n + CANDIDATES_PER_ITEM - 1) / CANDIDATES_PER_ITEM;
+  worker_pool->Run(n_items, [&](unsigned item) {
+      const unsigned begin = item * CANDIDATES_PER_ITEM;
+      solve(begin, std::min(begin + CANDIDATES_PER_ITEM, n));
+    });
+}
+
 bool
 AbortTask::FillReachable(const AircraftState &state,
                          AlternateList &approx_waypoints,
@@ -156,10 +204,7 @@ AbortTask::FillReachable(const AircraftState &state,
       continue;
     }
 
-    UnorderedTaskPoint t(v->waypoint, task_behaviour);
-    GlideResult result =
-        TaskSolution::GlideSolutionRemaining(t, state,
-                                             task_behaviour.glide, polar);
+    const GlideResult &result = v->solution;
 
     if (IsReachable(result, final_glide)) {
       bool intersects = false;
@@ -170,7 +215,7 @@ AbortTask::FillReachable(const AircraftState &state,
             AGeoPoint(v->waypoint.location, result.min_arrival_altitude));
 
       if (!intersects) {
-        q.push(AlternatePoint(v->waypoint, result));
+        q.push(*v);
         // remove it since it's already in the list now      
         v = approx_waypoints.erase(v);
 
@@ -267,6 +312,10 @@ AbortTask::UpdateSample(const AircraftState &state,
     return false;
   }
 
+  /* the glide solutions don't depend on the FillReachable() pass,
+     so solve all candidates once */
+  SolveCandidates(state, approx_waypoints, glide_polar);
+
   // sort by arrival time
 
   // first try with final glide only
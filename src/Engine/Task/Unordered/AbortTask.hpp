@@ -34,6 +34,7 @@
 class Waypoints;
 class AbortIntersectionTest;
 class AlternateList;
+class WorkerPool;
 
 /**
  * Abort task provides automatic management of a sorted list of task points
@@ -77,6 +78,12 @@ protected:
   /** Hook for external intersection tests */
   AbortIntersectionTest* intersection_test;
 
+  /**
+   * Solve the glide to the candidates on this pool.  nullptr means
+   * the candidates are solved sequentially.
+   */
+  WorkerPool *worker_pool;
+
 private:
   unsigned active_waypoint;
   bool reachable_landable;
@@ -155,13 +162,28 @@ protected:
   fixed GetAbortRange(const AircraftState &state_now,
                       const GlidePolar &glide_polar) const;
 
+  /**
+   * Calculate the glide solution of each candidate waypoint and
+   * store it in AlternatePoint::solution, for use by
+   * FillReachable().  The candidates are independent, so they are
+   * solved in parallel on the #WorkerPool, if one was set.
+   *
+   * @param state Aircraft state
+   * @param approx_waypoints List of candidate waypoints
+   * @param polar Polar used for tests
+   */
+  void SolveCandidates(const AircraftState &state,
+                       AlternateList &approx_waypoints,
+                       const GlidePolar &polar) const;
+
   /**
    * Fill abort task list with candidate waypoints given a list of
    * waypoints satisfying approximate range queries.  Can be used
    * to add airfields only, or landpoints.
    *
    * @param state Aircraft state
-   * @param approx_waypoints List of candidate waypoints
+   * @param approx_waypoints List of candidate waypoints, solved by
+   * SolveCandidates()
    * @param polar Polar used for tests
    * @param only_airfield If true, only add waypoints that are airfields.
    * @param final_glide Whether solution must be glide only or climb allowed
@@ -199,6 +221,15 @@ public:
     intersection_test = test;
   }
 
+  /**
+   * Solve the candidate waypoints in parallel on the given
+   * #WorkerPool.  Pass nullptr to disable.  The results are the same
+   * either way.
+   */
+  void SetWorkerPool(WorkerPool *_worker_pool) {
+    worker_pool = _worker_pool;
+  }
+
   /**
    * Accept a const task point visitor; makes the visitor visit
    * all TaskPoint in the task
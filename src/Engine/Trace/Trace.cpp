@@ -23,18 +23,20 @@ Copyright_License {
 
 #include "Trace.hpp"
 #include "Vector.hpp"
-#include "Util/GlobalSliceAllocator.hpp"
 
 #include <algorithm>
+#include <vector>
 
 Trace::Trace(const unsigned _no_thin_time, const unsigned max_time,
              const unsigned max_size)
-  :chronological_list(ListHead::empty()),
-   cached_size(0),
+  :points(max_size),
+   elim_time(max_size), elim_distance(max_size), delta_distance(max_size),
+   n_points(0),
    max_time(max_time),
    no_thin_time(_no_thin_time),
    max_size(max_size),
-   opt_size((3 * max_size) / 4)
+   opt_size((3 * max_size) / 4),
+   average_delta_time(0), average_delta_distance(0)
 {
   assert(max_size >= 4);
 }
@@ -42,18 +44,10 @@ Trace::Trace(const unsigned _no_thin_time, const unsigned max_time,
 void
 Trace::clear()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
-
   average_delta_distance = 0;
   average_delta_time = 0;
 
-  delta_list.clear();
-  chronological_list.Clear();
-  cached_size = 0;
-
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
+  n_points = 0;
 
   ++modify_serial;
   ++append_serial;
@@ -73,109 +67,175 @@ Trace::GetRecentTime(const unsigned t) const
 }
 
 void
-Trace::UpdateDelta(TraceDelta &td)
+Trace::UpdateDelta(unsigned i, unsigned previous, unsigned next)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
-
-  if (chronological_list.IsEdge(td))
-    return;
+  assert(previous < i);
+  assert(i < next);
+  assert(next < n_points);
 
-  const TraceDelta &previous = td.GetPrevious();
-  const TraceDelta &next = td.GetNext();
+  const TracePoint &p_last = points[previous];
+  const TracePoint &p = points[i];
+  const TracePoint &p_next = points[next];
 
-  TraceDelta temp_td = td;
-  temp_td.SetDisconnected();
+  elim_time[i] = TimeMetric(p_last, p, p_next);
+  elim_distance[i] = DistanceMetric(p_last, p, p_next);
+  delta_distance[i] = p.FlatDistanceTo(p_last);
 
-  td.Replace(temp_td);
-
-  // erase old one
-  auto i = delta_list.find(td);
-  assert(i != delta_list.end());
-  delta_list.erase(i);
-
-  // insert new in sorted position
-  temp_td.Update(previous.point, next.point);
-  TraceDelta &new_td = Insert(temp_td);
-  new_td.SetDisconnected();
-  temp_td.Replace(new_td);
+  assert(elim_distance[i] != null_delta);
 }
 
-void
-Trace::EraseInside(TraceDelta::iterator it)
-{
-  assert(cached_size > 0);
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
-  assert(it != delta_list.end());
-
-  const TraceDelta &td = *it;
-  assert(!td.IsEdge());
-
-  TraceDelta &previous = const_cast<TraceDelta &>(td.GetPrevious());
-  TraceDelta &next = const_cast<TraceDelta &>(td.GetNext());
-
-  // now delete the item
-  td.RemoveConst();
-  delta_list.erase(it);
-  --cached_size;
+/**
+ * A thinning candidate in the heap built by Trace::EraseDelta().  It
+ * contains a copy of the ranking metrics at the time it was pushed;
+ * it is stale if the point has been updated since.
+ */
+struct DeltaCandidate {
+  unsigned elim_distance, elim_time, time;
+  unsigned index;
+
+  /**
+   * Ranking is primarily by distance delta; for equal distances,
+   * rank by time delta.  This is like a modified Douglas-Peuker
+   * algorithm.
+   */
+  gcc_pure
+  bool IsBefore(const DeltaCandidate &other) const {
+    // distance is king
+    if (elim_distance != other.elim_distance)
+      return elim_distance < other.elim_distance;
+
+    // distance is equal, so go by time error
+    if (elim_time != other.elim_time)
+      return elim_time < other.elim_time;
+
+    // all else fails, go by age
+    return time < other.time;
+  }
 
-  // and update the deltas
-  UpdateDelta(previous);
-  UpdateDelta(next);
-}
+  /**
+   * Comparison for std::push_heap() and std::pop_heap(): the best
+   * candidate shall be on top of the heap.
+   */
+  struct Compare {
+    gcc_pure
+    bool operator()(const DeltaCandidate &a, const DeltaCandidate &b) const {
+      return b.IsBefore(a);
+    }
+  };
+};
 
 bool
 Trace::EraseDelta(const unsigned target_size, const unsigned recent)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
-
   if (size() < 2)
     return false;
 
-  bool modified = false;
-
   const unsigned recent_time = GetRecentTime(recent);
+  const unsigned n = n_points;
+
+  /* the remaining points as a doubly linked list of indices; the
+     arrays are compacted after all removals */
+  std::vector<unsigned> previous(n), next(n);
+  for (unsigned i = 0; i < n; ++i) {
+    previous[i] = i - 1;
+    next[i] = i + 1;
+  }
+
+  const auto make_candidate = [this](unsigned i) {
+    const DeltaCandidate c = {
+      elim_distance[i], elim_time[i], points[i].GetTime(), i,
+    };
+    return c;
+  };
+
+  /* the first and the last point (edges) and recent points are not
+     candidates */
+  std::vector<DeltaCandidate> heap;
+  heap.reserve(n);
+  for (unsigned i = 1; i + 1 < n && points[i].GetTime() < recent_time; ++i)
+    heap.push_back(make_candidate(i));
+
+  const DeltaCandidate::Compare compare;
+  std::make_heap(heap.begin(), heap.end(), compare);
+
+  unsigned remaining = n;
+  while (remaining > target_size && !heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), compare);
+    const DeltaCandidate c = heap.back();
+    heap.pop_back();
+
+    const unsigned i = c.index;
+    if (elim_distance[i] != c.elim_distance || elim_time[i] != c.elim_time)
+      /* stale: the point has been erased or updated since this
+         candidate was pushed */
+      continue;
+
+    const unsigned p = previous[i], nx = next[i];
+    next[p] = nx;
+    previous[nx] = p;
+
+    /* mark as erased */
+    elim_distance[i] = null_delta;
+    --remaining;
+
+    // and update the deltas
+    if (p > 0) {
+      UpdateDelta(p, previous[p], nx);
+      if (points[p].GetTime() < recent_time) {
+        heap.push_back(make_candidate(p));
+        std::push_heap(heap.begin(), heap.end(), compare);
+      }
+    }
 
-  TraceDelta::iterator candidate = delta_list.begin();
-  while (size() > target_size) {
-    const TraceDelta &td = *candidate;
-    if (!td.IsEdge() && td.point.GetTime() < recent_time) {
-      EraseInside(candidate);
-      candidate = delta_list.begin(); // find new top
-      modified = true;
-    } else {
-      ++candidate;
-      // suppressed removal, skip it.
+    if (nx + 1 < n) {
+      UpdateDelta(nx, p, next[nx]);
+      if (points[nx].GetTime() < recent_time) {
+        heap.push_back(make_candidate(nx));
+        std::push_heap(heap.begin(), heap.end(), compare);
+      }
     }
   }
 
-  return modified;
+  if (remaining == n)
+    return false;
+
+  /* move the remaining points together */
+  unsigned dest = 0;
+  for (unsigned i = 0; i < n; i = next[i], ++dest) {
+    points[dest] = points[i];
+    elim_time[dest] = elim_time[i];
+    elim_distance[dest] = elim_distance[i];
+    delta_distance[dest] = delta_distance[i];
+  }
+
+  assert(dest == remaining);
+  n_points = remaining;
+  return true;
 }
 
 bool
 Trace::EraseEarlierThan(const unsigned p_time)
 {
-  if (p_time == 0 || empty() || GetFront().point.GetTime() >= p_time)
+  if (p_time == 0 || empty() || front().GetTime() >= p_time)
     // there will be nothing to remove
     return false;
 
-  do {
-    TraceDelta &td = GetFront();
-    td.Remove();
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase(i);
+  unsigned n = 1;
+  while (n < n_points && points[n].GetTime() < p_time)
+    ++n;
 
-    --cached_size;
-  } while (!empty() && GetFront().point.GetTime() < p_time);
+  std::copy(points.begin() + n, points.begin() + n_points, points.begin());
+  std::copy(elim_time.begin() + n, elim_time.begin() + n_points,
+            elim_time.begin());
+  std::copy(elim_distance.begin() + n, elim_distance.begin() + n_points,
+            elim_distance.begin());
+  std::copy(delta_distance.begin() + n, delta_distance.begin() + n_points,
+            delta_distance.begin());
+  n_points -= n;
 
-  // need to set deltas for first point, only one of these
-  // will occur (have to search for this point)
+  // need to set deltas for first point
   if (!empty())
-    EraseStart(GetFront());
+    EraseStart(0);
 
   ++modify_serial;
   ++append_serial;
@@ -188,61 +248,26 @@ Trace::EraseLaterThan(const unsigned min_time)
   assert(min_time > 0);
   assert(!empty());
 
-  while (!empty() && GetBack().point.GetTime() > min_time) {
-    TraceDelta &td = GetBack();
-
-    td.Remove();
+  while (!empty() && back().GetTime() > min_time)
+    --n_points;
 
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase(i);
-
-    --cached_size;
-  }
-
-  /* need to set deltas for first point, only one of these will occur
-     (have to search for this point) */
+  // need to set deltas for last point
   if (!empty())
-    EraseStart(GetBack());
-}
-
-Trace::TraceDelta &
-Trace::Insert(const TraceDelta &td) {
-  TraceDelta::iterator it = delta_list.insert(td);
-
-  /* std::set doesn't allow modification of an item, but we
-     override that */
-  TraceDelta &new_td = const_cast<TraceDelta &>(*it);
-  return new_td;
+    EraseStart(n_points - 1);
 }
 
-/**
- * Update start node (and neighbour) after min time pruning
- */
 void
-Trace::EraseStart(TraceDelta &td_start) {
-  TraceDelta temp_td = td_start;
-  temp_td.SetDisconnected();
-  td_start.Replace(temp_td);
-
-  auto i_start = delta_list.find(td_start);
-  assert(i_start != delta_list.end());
-  delta_list.erase(i_start);
-
-  temp_td.elim_distance = null_delta;
-  temp_td.elim_time = null_time;
+Trace::EraseStart(unsigned i)
+{
+  assert(i < n_points);
 
-  TraceDelta &new_td = Insert(temp_td);
-  new_td.SetDisconnected();
-  temp_td.Replace(new_td);
+  elim_distance[i] = null_delta;
+  elim_time[i] = null_time;
 }
 
 void
 Trace::push_back(const TracePoint &point)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
-
   if (empty()) {
     // first point determines origin for flat projection
     task_projection.Reset(point.GetLocation());
@@ -270,14 +295,15 @@ Trace::push_back(const TracePoint &point)
 
   assert(size() < max_size);
 
-  TraceDelta &td = Insert(point);
-  td.point.Project(task_projection);
-  td.InsertBefore(chronological_list);
+  const unsigned i = n_points++;
+  points[i] = point;
+  points[i].Project(task_projection);
+  elim_time[i] = null_time;
+  elim_distance[i] = null_delta;
+  delta_distance[i] = 0;
 
-  ++cached_size;
-
-  if (!chronological_list.IsFirst(td))
-    UpdateDelta(td.GetPrevious());
+  if (i >= 2)
+    UpdateDelta(i - 1, i - 2, i);
 
   ++append_serial;
 }
@@ -289,10 +315,8 @@ Trace::CalcAverageDeltaDistance(const unsigned no_thin) const
   unsigned acc = 0;
   unsigned counter = 0;
 
-  const ChronologicalConstIterator end = chronological_list.end();
-  for (ChronologicalConstIterator it = chronological_list.begin();
-       it != end && it->point.GetTime() < r; ++it, ++counter)
-    acc += it->delta_distance;
+  for (; counter < n_points && points[counter].GetTime() < r; ++counter)
+    acc += delta_distance[counter];
 
   if (counter)
     return acc / counter;
@@ -307,19 +331,16 @@ Trace::CalcAverageDeltaTime(const unsigned no_thin) const
   unsigned counter = 0;
 
   /* find the last item before the "r" timestamp */
-  const ChronologicalConstIterator end = chronological_list.end();
-  ChronologicalConstIterator it;
-  for (it = chronological_list.begin(); it != end && it->point.GetTime() < r; ++it)
+  while (counter < n_points && points[counter].GetTime() < r)
     ++counter;
 
   if (counter < 2)
     return 0;
 
-  --it;
   --counter;
 
   unsigned start_time = front().GetTime();
-  unsigned end_time = it->point.GetTime();
+  unsigned end_time = points[counter].GetTime();
   return (end_time - start_time) / counter;
 }
 
@@ -360,8 +381,6 @@ Trace::Thin2()
 void
 Trace::Thin()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.Count());
   assert(size() == max_size);
 
   Thin2();
@@ -378,57 +397,16 @@ Trace::Thin()
 void
 Trace::GetPoints(TracePointVector& iov) const
 {
-  iov.clear();
-  iov.reserve(size());
-  std::copy(begin(), end(), std::back_inserter(iov));
+  iov.assign(begin(), end());
 }
 
-template<typename I>
-class PointerIterator {
-  I i;
-
-public:
-  typedef typename I::iterator_category iterator_category;
-  typedef typename I::pointer value_type;
-  typedef typename I::pointer *pointer;
-  typedef value_type &reference;
-  typedef typename I::difference_type difference_type;
-
-  PointerIterator() = default;
-  explicit PointerIterator(I _i):i(_i) {}
-  PointerIterator<I> &operator=(const PointerIterator<I> &other) = default;
-
-  PointerIterator<I> &operator--() {
-    --i;
-    return *this;
-  }
-
-  PointerIterator<I> &operator++() {
-    ++i;
-    return *this;
-  }
-
-  typename I::pointer operator*() {
-    return &*i;
-  }
-
-  bool operator==(const PointerIterator<I> &other) const {
-    return i == other.i;
-  }
-
-  bool operator!=(const PointerIterator<I> &other) const {
-    return i != other.i;
-  }
-};
-
 void
 Trace::GetPoints(TracePointerVector &v) const
 {
   v.clear();
   v.reserve(size());
-  std::copy(PointerIterator<decltype(begin())>(begin()),
-            PointerIterator<decltype(end())>(end()),
-            std::back_inserter(v));
+  for (const TracePoint &point : *this)
+    v.push_back(&point);
 }
 
 bool
@@ -442,9 +420,9 @@ Trace::SyncPoints(TracePointerVector &v) const
 
   v.reserve(size());
 
-  PointerIterator<decltype(end())> e(end());
-  std::copy(std::prev(e, size() - v.size()), e,
-            std::back_inserter(v));
+  for (unsigned i = v.size(); i < n_points; ++i)
+    v.push_back(&points[i]);
+
   assert(v.size() == size());
   return true;
 }
@@ -26,14 +26,13 @@ Copyright_License {
 
 #include "Point.hpp"
 #include "Util/NonCopyable.hpp"
-#include "Util/SliceAllocator.hpp"
-#include "Util/ListHead.hpp"
-#include "Util/CastIterator.hpp"
+#include "Util/AllocatedArray.hpp"
 #include "Util/Serial.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Compiler.h"
 
-#include <set>
+#include <algorithm>
+#include <iterator>
 #include <assert.h>
 #include <stdlib.h>
 
@@ -49,147 +48,40 @@ class TracePointerVector;
  * the candidate point removed.  In this version, time differences is also a
  * secondary factor, such that thinning attempts to remove points such that,
  * for equal distance ranking, smaller time step details are removed first.
+ *
+ * The points are stored in chronological order in one contiguous
+ * array which is allocated once with the maximum size, and the
+ * thinning metrics live in parallel arrays.  Appending a point never
+ * moves the existing ones; only thinning and erasing the oldest
+ * points do (see GetModifySerial()).  The ranking of thinning
+ * candidates is built on demand as a binary heap of array indices.
  */
 class Trace : private NonCopyable
 {
-  struct TraceDelta : public ListHead {
-    /**
-     * Function used to points for sorting by deltas.
-     * Ranking is primarily by distance delta; for equal distances, rank by
-     * time delta.
-     * This is like a modified Douglas-Peuker algorithm
-     */
-    static bool DeltaRank(const TraceDelta &x, const TraceDelta &y) {
-      // distance is king
-      if (x.elim_distance < y.elim_distance)
-        return true;
-
-      if (x.elim_distance > y.elim_distance)
-        return false;
-
-      // distance is equal, so go by time error
-      if (x.elim_time < y.elim_time)
-        return true;
-
-      if (x.elim_time > y.elim_time)
-        return false;
-
-      // all else fails, go by age
-      if (x.point.IsOlderThan(y.point))
-        return true;
-
-      if (x.point.IsNewerThan(y.point))
-        return false;
-
-      return false;
-    }
-
-    struct DeltaRankOp {
-      bool operator()(const TraceDelta &s1, const TraceDelta &s2) {
-        return DeltaRank(s1, s2);
-      }
-    };
-
-    /* using std::multiset, not because we need multiple values (we
-       don't), but to avoid std::set's overhead for duplicate
-       elimination */
-    typedef std::multiset<TraceDelta, DeltaRankOp,
-                          GlobalSliceAllocator<TraceDelta, 128u> > List;
-    typedef List::iterator iterator;
-    typedef List::const_iterator const_iterator;
-
-    TracePoint point;
-
-    unsigned elim_time;
-    unsigned elim_distance;
-    unsigned delta_distance;
-
-    TraceDelta(const TracePoint &p)
-      :point(p),
-       elim_time(null_time), elim_distance(null_delta),
-       delta_distance(0) {}
-
-    TraceDelta(const TracePoint &p_last, const TracePoint &p,
-               const TracePoint &p_next)
-      :point(p),
-       elim_time(TimeMetric(p_last, p, p_next)),
-       elim_distance(DistanceMetric(p_last, p, p_next)),
-       delta_distance(p.FlatDistanceTo(p_last))
-    {
-      assert(elim_distance != null_delta);
-    }
-
-    /**
-     * Is this the first or the last point?
-     */
-    bool IsEdge() const {
-      return elim_time == null_time;
-    }
-
-    TraceDelta &GetPrevious() {
-      return *(TraceDelta *)ListHead::GetPrevious();
-    }
-
-    TraceDelta &GetNext() {
-      return *(TraceDelta *)ListHead::GetNext();
-    }
-
-    const TraceDelta &GetPrevious() const {
-      return *(const TraceDelta *)ListHead::GetPrevious();
-    }
-
-    const TraceDelta &GetNext() const {
-      return *(const TraceDelta *)ListHead::GetNext();
-    }
-
-    void Update(const TracePoint &p_last, const TracePoint &p_next) {
-      elim_time = TimeMetric(p_last, point, p_next);
-      elim_distance = DistanceMetric(p_last, point, p_next);
-      delta_distance = point.FlatDistanceTo(p_last);
-    }
+  /**
+   * The points in chronological order.  Only the first #n_points
+   * elements are used.
+   */
+  AllocatedArray<TracePoint> points;
 
-    /**
-     * Calculate error distance, between last through this to next,
-     * if this node is removed.  This metric provides for Douglas-Peuker
-     * thinning.
-     *
-     * @param last Point previous in time to this node
-     * @param node This node
-     * @param next Point succeeding this node
-     *
-     * @return Distance error if this node is thinned
-     */
-    static unsigned DistanceMetric(const TracePoint &last,
-                                   const TracePoint &node,
-                                   const TracePoint &next) {
-      const int d_this = last.FlatDistanceTo(node) + node.FlatDistanceTo(next);
-      const int d_rem = last.FlatDistanceTo(next);
-      return abs(d_this - d_rem);
-    }
+  /**
+   * Time error if the point at the same index is thinned; null_time
+   * for the first and the last point.
+   */
+  AllocatedArray<unsigned> elim_time;
 
-    /**
-     * Calculate error time, between last through this to next,
-     * if this node is removed.  This metric provides for fair thinning
-     * (tendency to to result in equal time steps)
-     *
-     * @param last Point previous in time to this node
-     * @param node This node
-     * @param next Point succeeding this node
-     *
-     * @return Time delta if this node is thinned
-     */
-    static unsigned TimeMetric(const TracePoint &last, const TracePoint &node,
-                               const TracePoint &next) {
-      return next.DeltaTime(last)
-        - std::min(next.DeltaTime(node), node.DeltaTime(last));
-    }
-  };
+  /**
+   * Distance error if the point at the same index is thinned;
+   * null_delta for the first and the last point.
+   */
+  AllocatedArray<unsigned> elim_distance;
 
-  typedef CastIterator<const TraceDelta, ListHead::const_iterator> ChronologicalConstIterator;
+  /**
+   * Flat distance from the previous point.
+   */
+  AllocatedArray<unsigned> delta_distance;
 
-  TraceDelta::List delta_list;
-  ListHead chronological_list;
-  unsigned cached_size;
+  unsigned n_points;
 
   TaskProjection task_projection;
 
@@ -229,25 +121,13 @@ protected:
   unsigned GetRecentTime(const unsigned t) const;
 
   /**
-   * Update delta values for specified item in the delta list and the
-   * tree.  This repositions the item after into its sorted position.
-   *
-   * @param it Item to update
-   * @param tree Tree containing leaf
-   *
-   * @return Iterator to updated item
-   */
-  void UpdateDelta(TraceDelta &td);
-
-  /**
-   * Erase a non-edge item from delta list and tree, updating
-   * deltas in the process.  This Invalidates the calling iterator.
-   *
-   * @param it Item to erase
-   * @param tree Tree to remove from
+   * Update delta values for the specified point.
    *
+   * @param i Index of the point to update
+   * @param previous Index of the preceding (remaining) point
+   * @param next Index of the succeeding (remaining) point
    */
-  void EraseInside(TraceDelta::iterator it);
+  void UpdateDelta(unsigned i, unsigned previous, unsigned next);
 
   /**
    * Erase elements based on delta metric until the size is
@@ -258,7 +138,6 @@ protected:
    * fail to set the target size.
    *
    * @param target_size Size of desired list.
-   * @param tree Tree to remove from
    * @param recent Time window for which to not remove points
    *
    * @return True if items were erased
@@ -267,11 +146,10 @@ protected:
                   const unsigned recent = 0);
 
   /**
-   * Erase elements older than specified time from delta and tree,
-   * and update earliest item to become the new start
+   * Erase elements older than specified time, and update earliest
+   * item to become the new start
    *
    * @param p_time Time to remove
-   * @param tree Tree to remove from
    *
    * @return True if items were erased
    */
@@ -283,12 +161,11 @@ protected:
    */
   void EraseLaterThan(const unsigned min_time);
 
-  TraceDelta &Insert(const TraceDelta &td);
-
   /**
-   * Update start node (and neighbour) after min time pruning
+   * Mark the specified point as the new first or last point after
+   * pruning.
    */
-  void EraseStart(TraceDelta &td_start);
+  void EraseStart(unsigned i);
 
 public:
   /**
@@ -317,13 +194,12 @@ public:
   }
 
   /**
-   * Size of traces (in tree, not in temporary store) ---
-   * must call optimise() before this for it to be accurate.
+   * Size of traces
    *
-   * @return Number of traces in tree
+   * @return Number of traces stored
    */
   unsigned size() const {
-    return cached_size;
+    return n_points;
   }
 
   /**
@@ -332,7 +208,7 @@ public:
    * @return True if no traces stored
    */
   bool empty() const {
-    return cached_size == 0;
+    return n_points == 0;
   }
 
   /**
@@ -387,13 +263,13 @@ public:
   const TracePoint &front() const {
     assert(!empty());
 
-    return static_cast<const TraceDelta *>(chronological_list.GetNext())->point;
+    return points[0];
   }
 
   const TracePoint &back() const {
     assert(!empty());
 
-    return static_cast<const TraceDelta *>(chronological_list.GetPrevious())->point;
+    return points[n_points - 1];
   }
 
 private:
@@ -420,16 +296,40 @@ private:
    */
   void Thin();
 
-  TraceDelta &GetFront() {
-    assert(!empty());
-
-    return *static_cast<TraceDelta *>(chronological_list.GetNext());
+  /**
+   * Calculate error distance, between last through this to next,
+   * if this node is removed.  This metric provides for Douglas-Peuker
+   * thinning.
+   *
+   * @param last Point previous in time to this node
+   * @param node This node
+   * @param next Point succeeding this node
+   *
+   * @return Distance error if this node is thinned
+   */
+  static unsigned DistanceMetric(const TracePoint &last,
+                                 const TracePoint &node,
+                                 const TracePoint &next) {
+    const int d_this = last.FlatDistanceTo(node) + node.FlatDistanceTo(next);
+    const int d_rem = last.FlatDistanceTo(next);
+    return abs(d_this - d_rem);
   }
 
-  TraceDelta &GetBack() {
-    assert(!empty());
-
-    return *static_cast<TraceDelta *>(chronological_list.GetPrevious());
+  /**
+   * Calculate error time, between last through this to next,
+   * if this node is removed.  This metric provides for fair thinning
+   * (tendency to to result in equal time steps)
+   *
+   * @param last Point previous in time to this node
+   * @param node This node
+   * @param next Point succeeding this node
+   *
+   * @return Time delta if this node is thinned
+   */
+  static unsigned TimeMetric(const TracePoint &last, const TracePoint &node,
+                             const TracePoint &next) {
+    return next.DeltaTime(last)
+      - std::min(next.DeltaTime(node), node.DeltaTime(last));
   }
 
   gcc_pure
@@ -455,13 +355,13 @@ public:
   class const_iterator {
     friend class Trace;
 
-    ListHead::const_iterator iterator;
+    const TracePoint *iterator;
 
-    const_iterator(ListHead::const_iterator _iterator)
+    const_iterator(const TracePoint *_iterator)
       :iterator(_iterator) {}
 
   public:
-    typedef ListHead::const_iterator::iterator_category iterator_category;
+    typedef std::random_access_iterator_tag iterator_category;
     typedef ptrdiff_t difference_type;
     typedef const TracePoint value_type;
     typedef const TracePoint *pointer;
@@ -470,13 +370,11 @@ public:
     const_iterator() = default;
 
     const TracePoint &operator*() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return td.point;
+      return *iterator;
     }
 
     const TracePoint *operator->() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return &td.point;
+      return iterator;
     }
 
     const_iterator &operator++() {
@@ -501,17 +399,42 @@ public:
       return old;
     }
 
+    const_iterator &operator+=(difference_type n) {
+      iterator += n;
+      return *this;
+    }
+
+    const_iterator &operator-=(difference_type n) {
+      iterator -= n;
+      return *this;
+    }
+
+    const_iterator operator+(difference_type n) const {
+      return const_iterator(iterator + n);
+    }
+
+    const_iterator operator-(difference_type n) const {
+      return const_iterator(iterator - n);
+    }
+
+    difference_type operator-(const const_iterator &other) const {
+      return iterator - other.iterator;
+    }
+
+    const TracePoint &operator[](difference_type n) const {
+      return iterator[n];
+    }
+
     const_iterator &NextSquareRange(unsigned sq_resolution,
                                     const const_iterator &end) {
-      const TracePoint &previous = ((const TraceDelta &)*iterator).point;
+      const TracePoint &previous = *iterator;
       while (true) {
         ++iterator;
 
         if (iterator == end.iterator)
           return *this;
 
-        const TraceDelta &td = (const TraceDelta &)*iterator;
-        if (td.point.FlatSquareDistanceTo(previous) >= sq_resolution)
+        if (iterator->FlatSquareDistanceTo(previous) >= sq_resolution)
           return *this;
       }
     }
@@ -523,80 +446,28 @@ public:
     bool operator!=(const const_iterator &other) const {
       return iterator != other.iterator;
     }
+
+    bool operator<(const const_iterator &other) const {
+      return iterator < other.iterator;
+    }
   };
 
   const_iterator begin() const {
-    return chronological_list.begin();
+    return points.begin();
   }
 
   const_iterator end() const {
-    return chronological_list.end();
+    return points.begin() + n_points;
   }
 
-  class const_reverse_iterator {
-    friend class Trace;
-
-    ListHead::const_reverse_iterator iterator;
-
-    const_reverse_iterator(ListHead::const_reverse_iterator _iterator)
-      :iterator(_iterator) {}
-
-  public:
-    typedef std::forward_iterator_tag iterator_category;
-    typedef ptrdiff_t difference_type;
-    typedef const TracePoint value_type;
-    typedef const TracePoint *pointer;
-    typedef const TracePoint &reference;
-
-    const_reverse_iterator() = default;
-
-    const TracePoint &operator*() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return td.point;
-    }
-
-    const TracePoint *operator->() const {
-      const TraceDelta &td = (const TraceDelta &)*iterator;
-      return &td.point;
-    }
-
-    const_reverse_iterator &operator++() {
-      ++iterator;
-      return *this;
-    }
-
-    const_reverse_iterator operator++(int) {
-      const_reverse_iterator old = *this;
-      iterator++;
-      return old;
-    }
-
-    const_reverse_iterator &operator--() {
-      --iterator;
-      return *this;
-    }
-
-    const_reverse_iterator operator--(int) {
-      const_reverse_iterator old = *this;
-      iterator--;
-      return old;
-    }
-
-    bool operator==(const const_reverse_iterator &other) const {
-      return iterator == other.iterator;
-    }
-
-    bool operator!=(const const_reverse_iterator &other) const {
-      return iterator != other.iterator;
-    }
-  };
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
 
   const_reverse_iterator rbegin() const {
-    return chronological_list.rbegin();
+    return const_reverse_iterator(end());
   }
 
   const_reverse_iterator rend() const {
-    return chronological_list.rend();
+    return const_reverse_iterator(begin());
   }
 
   const TaskProjection &GetProjection() const {
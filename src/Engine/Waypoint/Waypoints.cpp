@@ -118,6 +118,7 @@ Waypoints::WaypointNameTree::Remove(const Waypoint &wp)
 
 Waypoints::Waypoints():
   next_id(1),
+  id_index(1, nullptr),
   home(NULL)
 {
 }
@@ -158,6 +159,9 @@ Waypoints::Append(Waypoint &&wp)
   const Waypoint &new_wp = waypoint_tree.Add(std::move(wp));
   name_tree.Add(new_wp);
 
+  assert(new_wp.id == id_index.size());
+  id_index.push_back(&new_wp);
+
   ++serial;
 
   return new_wp;
@@ -267,11 +271,9 @@ Waypoints::SetHome(const unsigned id)
 const Waypoint*
 Waypoints::LookupId(const unsigned id) const
 {
-  for (const auto &wp : waypoint_tree)
-    if (wp.id == id)
-      return &wp;
-
-  return NULL;
+  return id < id_index.size()
+    ? id_index[id]
+    : NULL;
 }
 
 void
@@ -308,6 +310,7 @@ Waypoints::Clear()
   home = NULL;
   name_tree.Clear();
   waypoint_tree.clear();
+  id_index.assign(1, nullptr);
   next_id = 1;
 }
 
@@ -321,6 +324,7 @@ Waypoints::Erase(const Waypoint& wp)
   assert(it != waypoint_tree.end());
 
   name_tree.Remove(wp);
+  id_index[wp.id] = nullptr;
   waypoint_tree.erase(it);
   ++serial;
 }
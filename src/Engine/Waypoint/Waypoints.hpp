@@ -30,6 +30,8 @@
 #include "Waypoint.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 
+#include <vector>
+
 class WaypointVisitor;
 
 /**
@@ -79,6 +81,13 @@ class Waypoints: private NonCopyable
 
   WaypointTree waypoint_tree;
   WaypointNameTree name_tree;
+
+  /**
+   * Maps Waypoint::id to the Waypoint object, for LookupId().  Ids
+   * are allocated sequentially by Append(), therefore this is a plain
+   * array indexed by id; erased waypoints leave a nullptr slot.
+   */
+  std::vector<const Waypoint *> id_index;
   TaskProjection task_projection;
 
   const Waypoint *home;
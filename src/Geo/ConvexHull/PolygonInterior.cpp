@@ -139,4 +139,31 @@ PolygonInterior(const FlatGeoPoint &P,
   return wn != 0;
 }
 
+bool
+PolygonInterior(const GeoPoint &P, const SearchPointVector &polygon,
+                ConstBuffer<unsigned> edges)
+{
+  if (polygon.size() < 3)
+    return false;
+
+  int    wn = 0;    // the winding number counter
+
+  // loop through the given edges of the polygon
+  for (unsigned e : edges) {
+    const GeoPoint &i = polygon[e].GetLocation();
+    const GeoPoint &next = polygon[e + 1].GetLocation();
 
+    if (i.latitude <= P.latitude) {
+      if (next.latitude > P.latitude)
+        // an upward crossing
+        if (isLeft(i, next, P) > 0)
+          ++wn;
+    } else {
+      if (next.latitude <= P.latitude)
+        // a downward crossing
+        if (isLeft(i, next, P) < 0)
+          --wn;
+    }
+  }
+  return wn != 0;
+}
@@ -23,6 +23,7 @@
 #define POLYGON_INTERIOR_HPP
 
 #include "Geo/SearchPointVector.hpp"
+#include "Util/ConstBuffer.hpp"
 #include "Compiler.h"
 
 struct GeoPoint;
@@ -43,4 +44,13 @@ PolygonInterior(const FlatGeoPoint &p,
                 SearchPointVector::const_iterator begin,
                 SearchPointVector::const_iterator end);
 
+/**
+ * Same as the GeoPoint overload, but checks only the specified edges
+ * (edge i connects vertex i with vertex i+1).  The result is correct
+ * if they include all edges which cross the latitude of the point.
+ */
+gcc_pure bool
+PolygonInterior(const GeoPoint &p, const SearchPointVector &polygon,
+                ConstBuffer<unsigned> edges);
+
 #endif
@@ -0,0 +1,72 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "EdgeBandIndex.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+void
+EdgeBandIndex::Build(const double *y, unsigned n)
+{
+  Clear();
+
+  if (n < 2)
+    return;
+
+  const unsigned n_edges = n - 1;
+
+  const auto minmax = std::minmax_element(y, y + n);
+  min_y = *minmax.first;
+  max_y = *minmax.second;
+
+  /* about four edges per band; long edges appear in more than one
+     band */
+  const unsigned n_bands = std::max(n_edges / 4, 1u);
+  scale = max_y > min_y ? n_bands / (max_y - min_y) : 0;
+
+  /* count the edges in each band */
+  offsets.assign(n_bands + 1, 0);
+  for (unsigned i = 0; i < n_edges; ++i) {
+    const unsigned a = GetBand(y[i]), b = GetBand(y[i + 1]);
+    for (unsigned band = std::min(a, b), last = std::max(a, b);
+         band <= last; ++band)
+      ++offsets[band + 1];
+  }
+
+  for (unsigned band = 0; band < n_bands; ++band)
+    offsets[band + 1] += offsets[band];
+
+  /* fill the edge lists */
+  edges.resize(offsets.back());
+
+  std::vector<unsigned> position(offsets.begin(), offsets.end() - 1);
+  for (unsigned i = 0; i < n_edges; ++i) {
+    const unsigned a = GetBand(y[i]), b = GetBand(y[i + 1]);
+    for (unsigned band = std::min(a, b), last = std::max(a, b);
+         band <= last; ++band)
+      edges[position[band]++] = i;
+  }
+
+  assert(position.back() == edges.size());
+}
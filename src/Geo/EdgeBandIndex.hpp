@@ -0,0 +1,122 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_EDGE_BAND_INDEX_HPP
+#define XCSOAR_EDGE_BAND_INDEX_HPP
+
+#include "Util/ConstBuffer.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+/**
+ * A spatial index for the edges of a polygon (or polyline).  The
+ * vertical extent is divided into bands of equal height, and for each
+ * band, the edges which overlap it are listed.  Queries which only
+ * care about edges crossing a certain horizontal line (or range) need
+ * to look at only a few edges instead of all of them.
+ *
+ * Edge number i connects vertex i with vertex i+1.
+ */
+class EdgeBandIndex {
+  double min_y, max_y;
+
+  /**
+   * The number of bands per unit.
+   */
+  double scale;
+
+  /**
+   * For each band, the start offset in #edges.  It has one element
+   * more than there are bands.
+   */
+  std::vector<unsigned> offsets;
+
+  std::vector<unsigned> edges;
+
+public:
+  EdgeBandIndex():scale(0) {}
+
+  bool IsDefined() const {
+    return !offsets.empty();
+  }
+
+  void Clear() {
+    offsets.clear();
+    edges.clear();
+  }
+
+  /**
+   * Build the index.
+   *
+   * @param y the vertical coordinate of each vertex
+   * @param n the number of vertices
+   */
+  void Build(const double *y, unsigned n);
+
+  gcc_pure
+  unsigned GetBandCount() const {
+    return offsets.size() - 1;
+  }
+
+  /**
+   * Returns the band containing the specified vertical position,
+   * clipped to the existing bands.
+   */
+  gcc_pure
+  unsigned GetBand(double y) const {
+    if (y <= min_y)
+      return 0;
+
+    const unsigned band = unsigned((y - min_y) * scale);
+    const unsigned last = GetBandCount() - 1;
+    return band < last ? band : last;
+  }
+
+  /**
+   * Is the vertical position outside of all edges?
+   */
+  gcc_pure
+  bool IsOutside(double y) const {
+    return y < min_y || y > max_y;
+  }
+
+  /**
+   * Is the vertical range outside of all edges?
+   */
+  gcc_pure
+  bool IsOutside(double y1, double y2) const {
+    return y2 < min_y || y1 > max_y;
+  }
+
+  /**
+   * Returns the edges overlapping the specified band.
+   */
+  gcc_pure
+  ConstBuffer<unsigned> GetEdges(unsigned band) const {
+    return ConstBuffer<unsigned>(edges.data() + offsets[band],
+                                 offsets[band + 1] - offsets[band]);
+  }
+};
+
+#endif
@@ -40,7 +40,7 @@ Copyright_License {
 #include <windows.h>
 #endif
 
-static constexpr unsigned FILE_CACHE_MAGIC = 0xab352f8a;
+static constexpr unsigned FILE_CACHE_MAGIC = 0xab352f8b;
 
 #ifndef HAVE_POSIX
 
@@ -129,12 +129,6 @@ FileCache::~FileCache() {
   free(cache_path);
 }
 
-inline size_t
-FileCache::PathBufferSize(const TCHAR *name) const
-{
-  return cache_path_length + _tcslen(name) + 2;
-}
-
 const TCHAR *
 FileCache::MakeCachePath(TCHAR *buffer, const TCHAR *name) const
 {
@@ -144,6 +138,13 @@ FileCache::MakeCachePath(TCHAR *buffer, const TCHAR *name) const
   return buffer;
 }
 
+const TCHAR *
+FileCache::MakeUnmanagedPath(TCHAR *buffer, const TCHAR *name) const
+{
+  Directory::Create(cache_path);
+  return MakeCachePath(buffer, name);
+}
+
 void
 FileCache::Flush(const TCHAR *name)
 {
@@ -151,6 +152,31 @@ FileCache::Flush(const TCHAR *name)
   File::Delete(MakeCachePath(buffer, name));
 }
 
+/**
+ * Write the path of the original file, so a different file with the
+ * same size and modification time does not match the cache.
+ */
+static bool
+WritePath(FILE *file, const TCHAR *path)
+{
+  const uint32_t length = _tcslen(path);
+  return fwrite(&length, sizeof(length), 1, file) == 1 &&
+    fwrite(path, sizeof(*path), length, file) == length;
+}
+
+static bool
+ReadAndComparePath(FILE *file, const TCHAR *path)
+{
+  uint32_t length;
+  if (fread(&length, sizeof(length), 1, file) != 1 ||
+      length != _tcslen(path) || length >= MAX_PATH)
+    return false;
+
+  TCHAR buffer[MAX_PATH];
+  return fread(buffer, sizeof(*buffer), length, file) == length &&
+    memcmp(buffer, path, length * sizeof(*path)) == 0;
+}
+
 FILE *
 FileCache::Load(const TCHAR *name, const TCHAR *original_path)
 {
@@ -182,7 +208,8 @@ FileCache::Load(const TCHAR *name, const TCHAR *original_path)
   if (fread(&magic, sizeof(magic), 1, file) != 1 ||
       magic != FILE_CACHE_MAGIC ||
       fread(&old_info, sizeof(old_info), 1, file) != 1 ||
-      old_info != original_info) {
+      old_info != original_info ||
+      !ReadAndComparePath(file, original_path)) {
     fclose(file);
     File::Delete(path);
     return NULL;
@@ -209,7 +236,8 @@ FileCache::Save(const TCHAR *name, const TCHAR *original_path)
     return NULL;
 
   if (fwrite(&FILE_CACHE_MAGIC, sizeof(FILE_CACHE_MAGIC), 1, file) != 1 ||
-      fwrite(&original_info, sizeof(original_info), 1, file) != 1) {
+      fwrite(&original_info, sizeof(original_info), 1, file) != 1 ||
+      !WritePath(file, original_path)) {
     fclose(file);
     File::Delete(path);
     return NULL;
@@ -26,6 +26,7 @@ Copyright_License {
 
 #include <stdio.h>
 #include <tchar.h>
+#include <string.h>
 
 class FileCache {
   TCHAR *cache_path;
@@ -35,11 +36,28 @@ public:
   FileCache(const TCHAR *_cache_path);
   ~FileCache();
 
+  /**
+   * Returns the buffer size required for the path of the specified
+   * cache file.
+   */
+  size_t PathBufferSize(const TCHAR *name) const {
+    return cache_path_length + _tcslen(name) + 2;
+  }
+
 protected:
-  size_t PathBufferSize(const TCHAR *name) const;
   const TCHAR *MakeCachePath(TCHAR *buffer, const TCHAR *name) const;
 
 public:
+  /**
+   * Build the path of a cache file which is not managed with Load()
+   * and Save(), e.g. because it is memory-mapped and updated in
+   * place.  The caller is responsible for validating its contents.
+   * The cache directory is created if it does not exist yet.
+   *
+   * @param buffer a buffer of at least PathBufferSize() characters
+   */
+  const TCHAR *MakeUnmanagedPath(TCHAR *buffer, const TCHAR *name) const;
+
   void Flush(const TCHAR *name);
   FILE *Load(const TCHAR *name, const TCHAR *original_path);
 
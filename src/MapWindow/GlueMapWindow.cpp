@@ -33,7 +33,7 @@ Copyright_License {
 GlueMapWindow::GlueMapWindow(const Look &look)
   :MapWindow(look.map, look.traffic),
    logger(NULL),
-   idle_robin(-1),
+   first_idle(true),
 #ifdef ENABLE_OPENGL
    data_timer(*this),
 #endif
@@ -192,10 +192,10 @@ GlueMapWindow::Idle()
   if (!render_projection.IsValid())
     return false;
 
-  if (idle_robin == unsigned(-1)) {
+  if (first_idle) {
     /* draw the first frame as quickly as possible, so the user can
        start interacting with XCSoar immediately */
-    idle_robin = 2;
+    first_idle = false;
     return true;
   }
 
@@ -206,34 +206,37 @@ GlueMapWindow::Idle()
   PeriodClock clock;
   clock.Update();
 
-  bool still_dirty;
-  bool topography_dirty = true; /* scan topography in every Idle() call */
-  bool terrain_dirty = true;
-  bool weather_dirty = true;
+  /* terrain tiles are loaded by a background thread; checking it
+     once is enough, there is no point in spinning while it works */
+  const bool terrain_dirty = UpdateTerrain();
+
+  /* the same applies to topography; this publishes the shape lists
+     which are ready and returns non-zero until all are */
+  const bool topography_dirty = UpdateTopography() > 0;
+
+  bool weather_dirty;
 
   do {
-    idle_robin = (idle_robin + 1) % 3;
-    switch (idle_robin) {
-    case 0:
-      topography_dirty = UpdateTopography(1) > 0;
-      break;
-
-    case 1:
-      terrain_dirty = UpdateTerrain();
-      break;
-
-    case 2:
-      weather_dirty = UpdateWeather();
-      break;
-    }
-
-    still_dirty = terrain_dirty || topography_dirty || weather_dirty;
+    weather_dirty = UpdateWeather();
   } while (!clock.Check(700) && /* stop after 700ms */
 #ifndef ENABLE_OPENGL
            !draw_thread->IsTriggered() &&
 #endif
            IsUserIdle(2500) &&
-           still_dirty);
+           weather_dirty);
 
-  return still_dirty;
+  return weather_dirty || topography_dirty || terrain_dirty;
+}
+
+void
+GlueMapWindow::OnTerrainLoaded()
+{
+#ifdef ENABLE_OPENGL
+  /* #data_timer keeps repainting while UpdateTerrain() reports that
+     the loader is still busy */
+#else
+  /* the DrawThread doesn't repaint after Idle(), only on trigger */
+  if (draw_thread != NULL)
+    draw_thread->TriggerRedraw();
+#endif
 }
@@ -61,7 +61,11 @@ public:
 class GlueMapWindow : public MapWindow {
   const Logger *logger;
 
-  unsigned idle_robin;
+  /**
+   * Has Idle() not been called yet?  The first frame is drawn before
+   * any data is updated.
+   */
+  bool first_idle;
 
 #ifdef ENABLE_OPENGL
   /**
@@ -210,6 +214,7 @@ protected:
   /* virtual methods from class MapWindow */
   virtual void Render(Canvas &canvas, const PixelRect &rc) override;
   virtual void DrawThermalEstimate(Canvas &canvas) const override;
+  virtual void OnTerrainLoaded() override;
   virtual void RenderTrail(Canvas &canvas,
                            const RasterPoint aircraft_pos) override;
   virtual void RenderTrackBearing(Canvas &canvas,
@@ -25,10 +25,17 @@ Copyright_License {
 #include "Look/MapLook.hpp"
 #include "Topography/CachedTopographyRenderer.hpp"
 #include "Terrain/RasterTerrain.hpp"
+#include "Terrain/TerrainLoader.hpp"
 #include "Terrain/RasterWeather.hpp"
 #include "Computer/GlideComputer.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Engine/Task/Ordered/Points/OrderedTaskPoint.hpp"
+#include "Geo/Math.hpp"
 #include "Operation/Operation.hpp"
 
+#include <algorithm>
+
 #ifdef ENABLE_OPENGL
 #include "Screen/OpenGL/Scissor.hpp"
 #endif
@@ -44,6 +51,7 @@ MapWindow::MapWindow(const MapLook &_look,
    topography(NULL), topography_renderer(NULL),
    terrain(NULL),
    terrain_radius(fixed(0)),
+   terrain_loader(NULL),
    weather(NULL),
    traffic_look(_traffic_look),
    waypoint_renderer(NULL, look.waypoint),
@@ -68,6 +76,9 @@ MapWindow::MapWindow(const MapLook &_look,
 MapWindow::~MapWindow()
 {
   delete topography_renderer;
+
+  /* stopped by SetTerrain(NULL) in OnDestroy() */
+  assert(terrain_loader == NULL);
 }
 
 void
@@ -131,6 +142,53 @@ MapWindow::UpdateTopography(unsigned max_update)
     return 0;
 }
 
+/**
+ * Build the list of locations where terrain tiles shall be loaded in
+ * advance: along the current track, followed by the remaining legs of
+ * the active task.
+ *
+ * @param step the maximum distance between two locations
+ */
+static void
+FillTerrainPrefetch(TerrainLoader::PrefetchList &list,
+                    const MoreData &basic, const ProtectedTaskManager *task,
+                    fixed step)
+{
+  /* how far ahead along the track shall we look? */
+  static constexpr unsigned PREFETCH_SECONDS = 10 * 60;
+
+  if (!basic.location_available)
+    return;
+
+  const GeoPoint location = basic.location;
+
+  if (basic.track_available && basic.MovementDetected()) {
+    const GeoPoint ahead =
+      FindLatitudeLongitude(location, basic.track,
+                            basic.ground_speed * fixed(PREFETCH_SECONDS));
+    TerrainLoader::AppendLine(list, location, ahead, step);
+  }
+
+  if (task == NULL)
+    return;
+
+  ProtectedTaskManager::Lease lease(*task);
+  if (lease->GetMode() == TaskType::ORDERED) {
+    const OrderedTask &ordered = lease->GetOrderedTask();
+    GeoPoint previous = location;
+    for (unsigned i = ordered.GetActiveIndex(), n = ordered.TaskSize();
+         i < n && !list.full(); ++i) {
+      const GeoPoint next = ordered.GetTaskPoint(i).GetLocation();
+      TerrainLoader::AppendLine(list, previous, next, step);
+      previous = next;
+    }
+  } else {
+    const TaskWaypoint *tp = lease->GetActiveTaskPoint();
+    if (tp != NULL)
+      TerrainLoader::AppendLine(list, location, tp->GetLocation(), step);
+  }
+}
+
 bool
 MapWindow::UpdateTerrain()
 {
@@ -145,16 +203,18 @@ MapWindow::UpdateTerrain()
 
   // always service terrain even if it's not used by the map,
   // because it's used by other calculations
-  RasterTerrain::ExclusiveLease lease(*terrain);
-  lease->SetViewCenter(location, radius);
-  if (lease->IsDirty())
-    terrain_radius = fixed(0);
-  else {
-    terrain_radius = radius;
-    terrain_center = location;
-  }
+  terrain_loader->SetView(location, radius);
+  terrain_radius = radius;
+  terrain_center = location;
 
-  return lease->IsDirty();
+  TerrainLoader::PrefetchList prefetch;
+  FillTerrainPrefetch(prefetch, Basic(), task,
+                      std::max(radius, fixed(1000)));
+  terrain_loader->SetPrefetch(prefetch, radius);
+
+  /* the loader thread continues until all tiles are loaded, and
+     calls OnTerrainLoaded() whenever tiles have been published */
+  return terrain_loader->IsDirty();
 }
 
 bool
@@ -213,9 +273,22 @@ MapWindow::SetTopography(TopographyStore *_topography)
 void
 MapWindow::SetTerrain(RasterTerrain *_terrain)
 {
+  if (terrain_loader != NULL) {
+    /* the old terrain may be deleted after we return */
+    terrain_loader->StopAsync();
+    terrain_loader->WaitStopped();
+    delete terrain_loader;
+    terrain_loader = NULL;
+  }
+
   terrain = _terrain;
   terrain_center = GeoPoint::Invalid();
   background.SetTerrain(_terrain);
+
+  if (terrain != NULL)
+    terrain_loader = new TerrainLoader(*terrain, [this](){
+        OnTerrainLoaded();
+      });
 }
 
 void
@@ -45,6 +45,7 @@ struct TrafficLook;
 class TopographyStore;
 class CachedTopographyRenderer;
 class RasterTerrain;
+class TerrainLoader;
 class RasterWeather;
 class ProtectedMarkers;
 class Waypoints;
@@ -120,6 +121,12 @@ protected:
   GeoPoint terrain_center;
   fixed terrain_radius;
 
+  /**
+   * Loads the terrain tiles for this view in background.  It exists
+   * while #terrain is set.
+   */
+  TerrainLoader *terrain_loader;
+
   RasterWeather *weather;
 
   const TrafficLook &traffic_look;
@@ -332,6 +339,9 @@ protected:
   unsigned UpdateTopography(unsigned max_update=1024);
 
   /**
+   * Ask #terrain_loader to load the terrain tiles for the current
+   * view, and the tiles along the expected flight path.
+   *
    * @return true if UpdateTerrain() should be called again
    */
   bool UpdateTerrain();
@@ -341,6 +351,12 @@ protected:
    */
   bool UpdateWeather();
 
+  /**
+   * Called by #terrain_loader (in its own thread) after it has
+   * published new terrain tiles of the current view.
+   */
+  virtual void OnTerrainLoaded() {}
+
   void UpdateAll() {
     UpdateTopography();
     UpdateTerrain();
@@ -520,7 +520,7 @@ public:
   /**
    * Check whether the two angles are roughly equal.
    */
-  gcc_const
+  gcc_pure
   bool CompareRoughly(Angle other, Angle threshold = Angle::Degrees(10)) const;
 };
 
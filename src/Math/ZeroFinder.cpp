@@ -69,10 +69,10 @@ ZeroFinder::solution_within_tolerance(const fixed x,
   if (x_plus >= xmax)
     return false;
 
-  const fixed fx = f(x);
-  if (f(x_plus)<fx)
+  const fixed fx = Evaluate(x);
+  if (Evaluate(x_plus)<fx)
     return false;
-  if (f(x_minus)<fx)
+  if (Evaluate(x_minus)<fx)
     return false;
   // existing solution is good 
   return true;
@@ -135,9 +135,28 @@ fixed ZeroFinder::find_zero(const fixed xstart) {
 #ifdef INSTRUMENT_ZERO
   zero_total++;
 #endif
+  if (cache != nullptr) {
+    ++cache->searches;
+
+    fixed x;
+    if (cache->valid && find_zero_warm(x))
+      ++cache->warm_starts;
+    else {
+      const fixed fa = Evaluate(xmin);
+      const fixed fb = Evaluate(xmax);
+      x = find_zero_actual(xmin, fa, xmax, fb);
+    }
+
+    UpdateCache(x);
+    return x;
+  }
+
   if ((xmin<=xstart) || (xstart<=xmax) ||
-      (f(xstart)> sqrt_epsilon))
-    return find_zero_actual(xstart);
+      (f(xstart)> sqrt_epsilon)) {
+    const fixed fa = f(xmin);
+    const fixed fb = f(xmax);
+    return find_zero_actual(xmin, fa, xmax, fb);
+  }
 #ifdef INSTRUMENT_ZERO
   zero_skipped++;
 #endif
@@ -145,20 +164,83 @@ fixed ZeroFinder::find_zero(const fixed xstart) {
 }
 
 inline fixed
-ZeroFinder::find_zero_actual(const fixed xstart)
+ZeroFinder::Evaluate(const fixed x)
 {
-  fixed a, b, c; // Abscissae, descr. see above
-  fixed fa; // f(a)
-  fixed fb; // f(b)
-  fixed fc; // f(c)
+  if (cache != nullptr)
+    ++cache->evaluations;
+
+  return f(x);
+}
+
+void
+ZeroFinder::UpdateCache(const fixed x)
+{
+  assert(cache != nullptr);
+
+  /* the next bracket is twice as wide as the last move, but at least
+     a few tolerances, and never a large part of the range */
+  const fixed step_min = tolerance * 4;
+  const fixed step_max = (xmax - xmin) / 4;
+  const fixed step = cache->valid
+    ? Double(fabs(x - cache->x))
+    : step_max;
+
+  cache->x = x;
+  cache->step = std::max(step_min, std::min(step, step_max));
+  cache->valid = true;
+}
+
+/**
+ * Do the two function values bracket a zero?
+ */
+static inline bool
+BracketsZero(const fixed fa, const fixed fb)
+{
+  return !(positive(fa) && positive(fb)) && !(negative(fa) && negative(fb));
+}
+
+bool
+ZeroFinder::find_zero_warm(fixed &result)
+{
+  const fixed x0 = std::max(xmin, std::min(cache->x, xmax));
+  const fixed f0 = Evaluate(x0);
+  if (fabs(f0) < sqrt_epsilon) {
+    result = x0;
+    return true;
+  }
+
+  const fixed b = std::min(x0 + cache->step, xmax);
+  if (b > x0) {
+    const fixed fb = Evaluate(b);
+    if (BracketsZero(f0, fb)) {
+      result = find_zero_actual(x0, f0, b, fb);
+      return true;
+    }
+  }
 
-  bool b_best = true; // b is best and last called
+  const fixed a = std::max(x0 - cache->step, xmin);
+  if (a < x0) {
+    const fixed fa = Evaluate(a);
+    if (BracketsZero(fa, f0)) {
+      result = find_zero_actual(a, fa, x0, f0);
+      return true;
+    }
+  }
 
-  c = a = xmin;  
-  fc = fa = f(a);  
+  return false;
+}
 
-  b = xmax;  
-  fb = f(b);
+inline fixed
+ZeroFinder::find_zero_actual(fixed a, fixed fa, fixed b, fixed fb)
+{
+  fixed c; // Abscissae, descr. see above
+  fixed fc; // f(c)
+
+  // b is best and last called
+  bool b_best = true;
+
+  c = a;
+  fc = fa;
 
   // Main iteration loop
   for (;;) {
@@ -189,7 +271,7 @@ ZeroFinder::find_zero_actual(const fixed xstart)
     if (fabs(new_step) <= tol_act || fabs(fb) < sqrt_epsilon) {
       if (!b_best)
         // call once more
-        f(b);
+        Evaluate(b);
 
       // Acceptable approx. is found
       return b;
@@ -245,7 +327,7 @@ ZeroFinder::find_zero_actual(const fixed xstart)
 
     // Do step to a new approxim.
     b += new_step;
-    fb = f(b);
+    fb = Evaluate(b);
 
     // Adjust c for it to have a sign opposite to that of b
     if ((positive(fb) && positive(fc)) || (negative(fb) && negative(fc))) {
@@ -314,31 +396,73 @@ fixed ZeroFinder::find_min(const fixed xstart) {
 #ifdef INSTRUMENT_ZERO
   zero_total++;
 #endif
-  if (!solution_within_tolerance(xstart, tolerance_actual_min(xstart)))
-    return find_min_actual(xstart);
+  if (cache != nullptr) {
+    ++cache->searches;
+
+    fixed x;
+    if (cache->valid && find_min_warm(x))
+      ++cache->warm_starts;
+    else {
+      /* First step - always gold section*/
+      const fixed x0 = xmin + r * (xmax - xmin);
+      const fixed f0 = Evaluate(x0);
+      x = find_min_actual(xmin, xmax, x0, f0, x0, f0, x0, f0);
+    }
+
+    UpdateCache(x);
+    return x;
+  }
+
+  if (!solution_within_tolerance(xstart, tolerance_actual_min(xstart))) {
+    /* First step - always gold section*/
+    const fixed x0 = xmin + r * (xmax - xmin);
+    const fixed f0 = f(x0);
+    return find_min_actual(xmin, xmax, x0, f0, x0, f0, x0, f0);
+  }
 #ifdef INSTRUMENT_ZERO
   zero_skipped++;
 #endif
   return xstart;
 }
 
+bool
+ZeroFinder::find_min_warm(fixed &result)
+{
+  const fixed x0 = std::max(xmin, std::min(cache->x, xmax));
+  const fixed a = std::max(x0 - cache->step, xmin);
+  const fixed b = std::min(x0 + cache->step, xmax);
+
+  /* the ends are evaluated first, so that f() was last called at
+     x0 when the search starts */
+  const fixed fa = a < x0 ? Evaluate(a) : fixed(0);
+  const fixed fb = b > x0 ? Evaluate(b) : fixed(0);
+  const fixed f0 = Evaluate(x0);
+
+  /* assuming f() is unimodal, the minimum is inside [a,b] if neither
+     end is lower than x0; a range limit needs no check */
+  if ((a < x0 && fa < f0) || (b > x0 && fb < f0))
+    return false;
+
+  /* seed the parabolic interpolation with the bracket ends */
+  if (a < x0 && b > x0) {
+    if (fa <= fb)
+      result = find_min_actual(a, b, x0, f0, a, fa, b, fb);
+    else
+      result = find_min_actual(a, b, x0, f0, b, fb, a, fa);
+  } else
+    result = find_min_actual(a, b, x0, f0, x0, f0, x0, f0);
+
+  return true;
+}
+
 inline fixed
-ZeroFinder::find_min_actual(const fixed xstart)
+ZeroFinder::find_min_actual(fixed a, fixed b, fixed x, fixed fx,
+                            fixed w, fixed fw, fixed v, fixed fv)
 {
-  fixed x, v, w; // Abscissae, descr. see above
-  fixed fx; // f(x)
-  fixed fv; // f(v)
-  fixed fw; // f(w)
-  fixed a = xmin;
-  fixed b = xmax;
   bool x_best = true;
 
   assert(positive(tolerance) && b > a);
 
-  /* First step - always gold section*/
-  x = w = v = a + r * (b - a);
-  fx = fw = fv = f(v);
-
   // Main iteration loop
   for (;;) {
     // Range over which the minimum is seeked for
@@ -352,7 +476,7 @@ ZeroFinder::find_min_actual(const fixed xstart)
     if (fabs(x-middle_range) + Half(range) <= double_tol_act) {
       if (!x_best)
         // call once more
-        f(x);
+        Evaluate(x);
 
       // Acceptable approx. is found
       return x;
@@ -400,7 +524,7 @@ ZeroFinder::find_min_actual(const fixed xstart)
     {
       // Tentative point for the min
       const fixed t = x + new_step;
-      const fixed ft = f(t);
+      const fixed ft = Evaluate(t);
       // t is a better approximation
       if (ft <= fx) {
         // Reduce the range so that t would fall within it
@@ -32,6 +32,47 @@
  *
  */
 class ZeroFinder {
+public:
+  /**
+   * The solution of a previous search, from which the next search is
+   * warm-started, and convergence statistics for profiling.  A
+   * ZeroFinder is usually a short-lived object, so the caller keeps
+   * this across searches and attaches it with SetCache().
+   */
+  struct Cache {
+    /** The previous solution */
+    fixed x;
+    /** Half width of the bracket tried around #x */
+    fixed step;
+    /** Is #x usable as a warm start? */
+    bool valid;
+
+    /** Number of searches */
+    unsigned searches;
+    /** Number of searches which converged inside the warm bracket */
+    unsigned warm_starts;
+    /** Total number of function evaluations */
+    unsigned evaluations;
+
+    Cache() {
+      Clear();
+    }
+
+    /** Forget the previous solution and reset the statistics */
+    void Clear() {
+      Invalidate();
+      searches = warm_starts = evaluations = 0;
+    }
+
+    /**
+     * Forget the previous solution, e.g. because the function has
+     * changed substantially.
+     */
+    void Invalidate() {
+      valid = false;
+    }
+  };
+
 protected:
   /** min value of search range */
   const fixed xmin;
@@ -40,6 +81,10 @@ protected:
   /** search tolerance in x */
   const fixed tolerance;
 
+private:
+  /** Warm start and statistics, optional */
+  Cache *cache;
+
 public:
   /**
    * Constructor of zero finder search algorithm
@@ -49,11 +94,20 @@ public:
    * @param _tolerance Absolute tolerance of solution (in x)
    */
   ZeroFinder(const fixed _xmin, const fixed _xmax, const fixed _tolerance) :
-    xmin(_xmin), xmax(_xmax), tolerance(_tolerance)
+    xmin(_xmin), xmax(_xmax), tolerance(_tolerance), cache(nullptr)
   {
     assert(xmin < xmax);
   }
 
+  /**
+   * Warm-start the following searches from the solution stored in the
+   * given cache (if valid), and store their solutions and statistics
+   * there.
+   */
+  void SetCache(Cache &_cache) {
+    cache = &_cache;
+  }
+
   /**
    * Abstract method for function to be minimised or root-solved
    *
@@ -72,7 +126,6 @@ public:
    *
    * @return x value of best solution
    */
-  gcc_pure
   fixed find_zero(const fixed xstart);
 
   /**
@@ -84,15 +137,49 @@ public:
    *
    * @return x value of best solution
    */
-  gcc_pure
   fixed find_min(const fixed xstart);
 
 private:
-  gcc_pure
-  fixed find_zero_actual(const fixed xstart);
+  /**
+   * Evaluate f(), counting the call in the cache's statistics.
+   */
+  fixed Evaluate(const fixed x);
 
-  gcc_pure
-  fixed find_min_actual(const fixed xstart);
+  /**
+   * Find a zero within [a,b], where f(a) and f(b) have opposite signs
+   */
+  fixed find_zero_actual(fixed a, fixed fa, fixed b, fixed fb);
+
+  /**
+   * Find the minimum within [a,b], starting at x (inside [a,b]),
+   * which is the point f() was last evaluated at.  w and v are
+   * earlier evaluations (or equal to x), see the description of the
+   * algorithm.
+   */
+  fixed find_min_actual(fixed a, fixed b, fixed x, fixed fx,
+                        fixed w, fixed fw, fixed v, fixed fv);
+
+  /**
+   * Try to find a zero inside a small bracket around the cached
+   * solution.
+   *
+   * @return true if a zero was bracketed and found
+   */
+  bool find_zero_warm(fixed &result);
+
+  /**
+   * Try to find the minimum inside a small bracket around the cached
+   * solution.
+   *
+   * @return true if the minimum was bracketed and found
+   */
+  bool find_min_warm(fixed &result);
+
+  /**
+   * Store a solution in the cache, and size the next warm bracket by
+   * how far the solution moved.
+   */
+  void UpdateCache(fixed x);
 
   /**
    * Tolerance in f of minimisation routine at x
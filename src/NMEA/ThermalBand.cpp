@@ -86,12 +86,14 @@ ThermalBandInfo::Expand(const fixed height)
 {
   ThermalBandInfo new_tbi;
 
-  // calculate new buckets so glider is below max
-  fixed hbuk = max_thermal_height / NUMTHERMALBUCKETS;
-
   new_tbi.Clear();
   new_tbi.max_thermal_height = std::max(fixed(1), max_thermal_height);
 
+  // calculate new buckets so glider is below max; the bucket height
+  // is based on the clamped ceiling, or a tiny (or zero) ceiling
+  // would make the following loop (almost) endless
+  const fixed hbuk = new_tbi.max_thermal_height / NUMTHERMALBUCKETS;
+
   // increase ceiling until reach required height
   while (new_tbi.max_thermal_height < height) {
     new_tbi.max_thermal_height += hbuk;
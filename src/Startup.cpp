@@ -371,8 +371,8 @@ Startup()
   RASP.ScanAll(CommonInterface::Basic().location, operation);
 
   // Reads the airspace files
-  ReadAirspace(airspace_database, terrain, computer_settings.pressure,
-               operation);
+  ReadAirspace(airspace_database, terrain, file_cache,
+               computer_settings.pressure, operation);
 
   {
     const AircraftState aircraft_state =
@@ -195,6 +195,13 @@ ProtectedTaskManager::SetRoutePlanner(const RoutePlannerGlue *_route) {
   lease->SetIntersectionTest(&intersection_test);
 }
 
+void
+ProtectedTaskManager::SetWorkerPool(WorkerPool *worker_pool)
+{
+  ExclusiveLease lease(*this);
+  lease->SetWorkerPool(worker_pool);
+}
+
 bool
 ReachIntersectionTest::Intersects(const AGeoPoint& destination)
 {
@@ -32,6 +32,7 @@
 
 class GlidePolar;
 class RoutePlannerGlue;
+class WorkerPool;
 struct RangeAndRadial;
 
 class ReachIntersectionTest: public AbortIntersectionTest {
@@ -122,6 +123,8 @@ public:
 
   void SetRoutePlanner(const RoutePlannerGlue *_route);
 
+  void SetWorkerPool(WorkerPool *worker_pool);
+
   short GetTerrainBase() const;
 };
 
@@ -29,6 +29,7 @@ struct GlideSettings;
 class RoughAltitude;
 class RasterTerrain;
 class ProtectedAirspaceWarningManager;
+class WorkerPool;
 
 class RoutePlannerGlue {
   const RasterTerrain *terrain;
@@ -39,6 +40,10 @@ public:
 
   void SetTerrain(const RasterTerrain *terrain);
 
+  void SetWorkerPool(WorkerPool *worker_pool) {
+    planner.SetWorkerPool(worker_pool);
+  }
+
   void UpdatePolar(const GlideSettings &settings,
                    const GlidePolar &polar,
                    const GlidePolar &safety_polar,
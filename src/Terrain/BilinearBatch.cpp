@@ -0,0 +1,171 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "BilinearBatch.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+/**
+ * The portable implementation, used for the remainder which does not
+ * fill a SIMD register.  Same formula as
+ * RasterBuffer::GetInterpolated().
+ */
+gcc_const
+static inline short
+Interpolate(short a, short b, short c, short d, unsigned ix, unsigned iy)
+{
+  const unsigned kx = 0x100 - ix;
+  const unsigned ky = 0x100 - iy;
+
+  return (a * kx * ky + b * ix * ky + c * kx * iy + d * ix * iy) >> 16;
+}
+
+#ifdef __SSE2__
+
+/**
+ * Multiply 32 bit integers, and keep the lower 32 bits of each
+ * product.  SSE4.1 has _mm_mullo_epi32(), but SSE2 doesn't.
+ */
+gcc_always_inline
+static inline __m128i
+MultiplyLow32(__m128i a, __m128i b)
+{
+  const __m128i even = _mm_mul_epu32(a, b);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                    _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/**
+ * Calculate eight samples.  The horizontal step uses the 16 bit
+ * multiply-add instruction; the intermediate results need 24 bits,
+ * and the vertical step is done with 32 bit integers.  The final sum
+ * fits in 32 bits, just like in the portable implementation.
+ */
+gcc_always_inline
+static inline void
+Interpolate8(const short *top_left, const short *top_right,
+             const short *bottom_left, const short *bottom_right,
+             const short *ix, const short *iy, short *dest)
+{
+  const __m128i a = _mm_loadu_si128((const __m128i *)top_left);
+  const __m128i b = _mm_loadu_si128((const __m128i *)top_right);
+  const __m128i c = _mm_loadu_si128((const __m128i *)bottom_left);
+  const __m128i d = _mm_loadu_si128((const __m128i *)bottom_right);
+  const __m128i x = _mm_loadu_si128((const __m128i *)ix);
+  const __m128i y = _mm_loadu_si128((const __m128i *)iy);
+
+  const __m128i full = _mm_set1_epi16(0x100);
+  const __m128i kx = _mm_sub_epi16(full, x);
+  const __m128i ky = _mm_sub_epi16(full, y);
+
+  const __m128i wx_lo = _mm_unpacklo_epi16(kx, x);
+  const __m128i wx_hi = _mm_unpackhi_epi16(kx, x);
+
+  const __m128i top_lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), wx_lo);
+  const __m128i top_hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), wx_hi);
+  const __m128i bottom_lo = _mm_madd_epi16(_mm_unpacklo_epi16(c, d), wx_lo);
+  const __m128i bottom_hi = _mm_madd_epi16(_mm_unpackhi_epi16(c, d), wx_hi);
+
+  /* the vertical weights are positive; zero-extend them to 32 bit */
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i r_lo =
+    _mm_add_epi32(MultiplyLow32(top_lo, _mm_unpacklo_epi16(ky, zero)),
+                  MultiplyLow32(bottom_lo, _mm_unpacklo_epi16(y, zero)));
+  const __m128i r_hi =
+    _mm_add_epi32(MultiplyLow32(top_hi, _mm_unpackhi_epi16(ky, zero)),
+                  MultiplyLow32(bottom_hi, _mm_unpackhi_epi16(y, zero)));
+
+  _mm_storeu_si128((__m128i *)dest,
+                   _mm_packs_epi32(_mm_srai_epi32(r_lo, 16),
+                                   _mm_srai_epi32(r_hi, 16)));
+}
+
+static constexpr unsigned SIMD_WIDTH = 8;
+
+#elif defined(__ARM_NEON__)
+
+/**
+ * Calculate four samples.
+ */
+gcc_always_inline
+static inline void
+Interpolate4(const short *top_left, const short *top_right,
+             const short *bottom_left, const short *bottom_right,
+             const short *ix, const short *iy, short *dest)
+{
+  const int16x4_t a = vld1_s16(top_left);
+  const int16x4_t b = vld1_s16(top_right);
+  const int16x4_t c = vld1_s16(bottom_left);
+  const int16x4_t d = vld1_s16(bottom_right);
+  const int16x4_t x = vld1_s16(ix);
+  const int16x4_t y = vld1_s16(iy);
+
+  const int16x4_t full = vdup_n_s16(0x100);
+  const int16x4_t kx = vsub_s16(full, x);
+  const int16x4_t ky = vsub_s16(full, y);
+
+  const int32x4_t top = vmlal_s16(vmull_s16(a, kx), b, x);
+  const int32x4_t bottom = vmlal_s16(vmull_s16(c, kx), d, x);
+  const int32x4_t r = vmlaq_s32(vmulq_s32(top, vmovl_s16(ky)),
+                                bottom, vmovl_s16(y));
+
+  vst1_s16(dest, vshrn_n_s32(r, 16));
+}
+
+static constexpr unsigned SIMD_WIDTH = 4;
+
+#endif
+
+void
+BilinearInterpolate(const short *gcc_restrict top_left,
+                    const short *gcc_restrict top_right,
+                    const short *gcc_restrict bottom_left,
+                    const short *gcc_restrict bottom_right,
+                    const short *gcc_restrict ix,
+                    const short *gcc_restrict iy,
+                    short *gcc_restrict dest, unsigned n)
+{
+  unsigned i = 0;
+
+#if defined(__SSE2__)
+  for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    Interpolate8(top_left + i, top_right + i, bottom_left + i,
+                 bottom_right + i, ix + i, iy + i, dest + i);
+#elif defined(__ARM_NEON__)
+  for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    Interpolate4(top_left + i, top_right + i, bottom_left + i,
+                 bottom_right + i, ix + i, iy + i, dest + i);
+#endif
+
+  for (; i < n; ++i)
+    dest[i] = Interpolate(top_left[i], top_right[i],
+                          bottom_left[i], bottom_right[i], ix[i], iy[i]);
+}
@@ -0,0 +1,121 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_BILINEAR_BATCH_HPP
+#define XCSOAR_TERRAIN_BILINEAR_BATCH_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <assert.h>
+
+/**
+ * Interpolate a number of height samples between four neighbouring
+ * raster pixels each.  The result is the same as
+ * RasterBuffer::GetInterpolated().
+ *
+ * All arrays have #n elements; the fractions are 0..0x100.  SSE2 or
+ * NEON is used if available.
+ */
+void
+BilinearInterpolate(const short *gcc_restrict top_left,
+                    const short *gcc_restrict top_right,
+                    const short *gcc_restrict bottom_left,
+                    const short *gcc_restrict bottom_right,
+                    const short *gcc_restrict ix,
+                    const short *gcc_restrict iy,
+                    short *gcc_restrict dest, unsigned n);
+
+/**
+ * Collects bilinear interpolation jobs in "structure of arrays"
+ * layout, to be calculated in one go by BilinearInterpolate().  The
+ * results are delivered in the order of the jobs.
+ */
+class BilinearBatch : private NonCopyable {
+public:
+  static constexpr unsigned CAPACITY = 64;
+
+private:
+  unsigned n;
+
+  short top_left[CAPACITY], top_right[CAPACITY];
+  short bottom_left[CAPACITY], bottom_right[CAPACITY];
+  short ix[CAPACITY], iy[CAPACITY];
+
+public:
+  BilinearBatch():n(0) {}
+
+  bool IsEmpty() const {
+    return n == 0;
+  }
+
+  bool IsFull() const {
+    return n == CAPACITY;
+  }
+
+  /**
+   * Queue one job.
+   *
+   * @param p pointer to the top left pixel
+   * @param dx the offset of the pixel to the right (0 or 1)
+   * @param dy the offset of the pixel below (0 or the row length)
+   */
+  void Append(const short *p, unsigned dx, unsigned dy,
+              unsigned _ix, unsigned _iy) {
+    assert(!IsFull());
+    assert(_ix < 0x100);
+    assert(_iy < 0x100);
+
+    top_left[n] = p[0];
+    top_right[n] = p[dx];
+    bottom_left[n] = p[dy];
+    bottom_right[n] = p[dx + dy];
+    ix[n] = _ix;
+    iy[n] = _iy;
+    ++n;
+  }
+
+  /**
+   * Queue a job whose result is known already.  It passes the kernel
+   * unmodified, because all of its weight is on one pixel.
+   */
+  void AppendValue(short value) {
+    assert(!IsFull());
+
+    top_left[n] = top_right[n] = bottom_left[n] = bottom_right[n] = value;
+    ix[n] = iy[n] = 0;
+    ++n;
+  }
+
+  /**
+   * Calculate all queued jobs, store the results in the given array
+   * and clear the batch.
+   */
+  void Flush(short *dest) {
+    BilinearInterpolate(top_left, top_right, bottom_left, bottom_right,
+                        ix, iy, dest, n);
+    n = 0;
+  }
+};
+
+#endif
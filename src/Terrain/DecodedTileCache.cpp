@@ -0,0 +1,257 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/DecodedTileCache.hpp"
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef HAVE_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static constexpr uint32_t DECODED_TILE_CACHE_MAGIC = 0x3d7c1e02;
+
+/**
+ * Slots are aligned to memory pages, so a tile can be paged in
+ * without touching its neighbours.
+ */
+static constexpr size_t SLOT_ALIGNMENT = 4096;
+
+/**
+ * Don't map more than this; the mapping must fit into the address
+ * space of 32 bit processes.
+ */
+static constexpr uint64_t MAX_MAPPING_SIZE = 512 * 1024 * 1024;
+
+static constexpr uint64_t
+AlignSlot(uint64_t size)
+{
+  return (size + SLOT_ALIGNMENT - 1) & ~uint64_t(SLOT_ALIGNMENT - 1);
+}
+
+#ifdef HAVE_POSIX
+
+static bool
+WriteAt(int fd, const void *data, size_t size, off_t offset)
+{
+  return pwrite(fd, data, size, offset) == (ssize_t)size;
+}
+
+bool
+DecodedTileCache::Open(const TCHAR *path, const Source &source,
+                       unsigned _n_tiles, unsigned tile_size)
+{
+  Close();
+
+  const uint64_t _slot_size = AlignSlot(uint64_t(tile_size) * sizeof(short));
+  const uint64_t _slots_offset =
+    AlignSlot(sizeof(Header) + uint64_t(_n_tiles) * sizeof(uint32_t));
+  const uint64_t _mapping_size = _slots_offset + _n_tiles * _slot_size;
+  if (_n_tiles == 0 || tile_size == 0 || _mapping_size > MAX_MAPPING_SIZE)
+    return false;
+
+  n_tiles = _n_tiles;
+  slot_size = (size_t)_slot_size;
+  slots_offset = (size_t)_slots_offset;
+  mapping_size = (size_t)_mapping_size;
+
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_NOCTTY
+  flags |= O_NOCTTY;
+#endif
+#ifdef O_CLOEXEC
+  flags |= O_CLOEXEC;
+#endif
+
+  fd = open(path, flags, 0666);
+  if (fd < 0)
+    return false;
+
+  Header header;
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    Close();
+    return false;
+  }
+
+  if ((size_t)st.st_size < slots_offset ||
+      pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+      header.magic != DECODED_TILE_CACHE_MAGIC ||
+      header.source != source ||
+      header.n_tiles != n_tiles ||
+      header.slot_size != slot_size) {
+    /* a new file, or one which was created for another terrain
+       file */
+    if (!Clear(source)) {
+      Close();
+      return false;
+    }
+  } else
+    /* a slot which was not written completely (e.g. because XCSoar
+       was killed) is not referenced and will be overwritten */
+    n_slots = ((size_t)st.st_size - slots_offset) / slot_size;
+
+  /* map the maximum size; pages beyond the end of the file are never
+     accessed, because only complete slots are referenced */
+  void *p = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED) {
+    Close();
+    return false;
+  }
+
+  data = (const uint8_t *)p;
+
+  /* if the file was truncated, slots may be referenced which don't
+     exist anymore; new tiles would be appended there */
+  for (unsigned i = 0; i < n_tiles; ++i) {
+    if (GetSlot(i) > n_slots) {
+      if (!Clear(source)) {
+        Close();
+        return false;
+      }
+
+      break;
+    }
+  }
+
+  return true;
+}
+
+bool
+DecodedTileCache::Clear(const Source &source)
+{
+  Header header;
+  /* zero-fill all implicit padding bytes */
+  memset(&header, 0, sizeof(header));
+  header.magic = DECODED_TILE_CACHE_MAGIC;
+  /* copy the members, not the padding */
+  header.source.size = source.size;
+  header.source.mtime = source.mtime;
+  header.source.hash = source.hash;
+  header.n_tiles = n_tiles;
+  header.slot_size = slot_size;
+
+  n_slots = 0;
+  return ftruncate(fd, 0) == 0 && ftruncate(fd, slots_offset) == 0 &&
+    WriteAt(fd, &header, sizeof(header), 0);
+}
+
+void
+DecodedTileCache::Close()
+{
+  if (data != nullptr) {
+    munmap(const_cast<uint8_t *>(data), mapping_size);
+    data = nullptr;
+  }
+
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
+
+uint32_t
+DecodedTileCache::GetSlot(unsigned index) const
+{
+  assert(IsOpen());
+  assert(index < n_tiles);
+
+  uint32_t slot;
+  memcpy(&slot, data + sizeof(Header) + index * sizeof(slot), sizeof(slot));
+  return slot;
+}
+
+void
+DecodedTileCache::Load(unsigned index, short *dest, unsigned n) const
+{
+  assert(n * sizeof(*dest) <= slot_size);
+
+  const uint32_t slot = GetSlot(index);
+  assert(slot > 0);
+
+  memcpy(dest, data + slots_offset + (slot - 1) * slot_size,
+         n * sizeof(*dest));
+}
+
+void
+DecodedTileCache::Store(unsigned index, const short *src, unsigned n)
+{
+  assert(n * sizeof(*src) <= slot_size);
+
+  if (!IsOpen() || GetSlot(index) != 0)
+    return;
+
+  /* append the tile, and grow the file to the full slot size, so the
+     next slot is aligned */
+  const off_t offset = slots_offset + n_slots * slot_size;
+  if (!WriteAt(fd, src, n * sizeof(*src), offset) ||
+      ftruncate(fd, offset + slot_size) < 0)
+    return;
+
+  /* reference it only after the tile has been written */
+  const uint32_t slot = ++n_slots;
+  WriteAt(fd, &slot, sizeof(slot), sizeof(Header) + index * sizeof(slot));
+}
+
+#else
+
+bool
+DecodedTileCache::Open(const TCHAR *path, const Source &source,
+                       unsigned _n_tiles, unsigned tile_size)
+{
+  return false;
+}
+
+void
+DecodedTileCache::Close()
+{
+}
+
+bool
+DecodedTileCache::Clear(const Source &source)
+{
+  return false;
+}
+
+uint32_t
+DecodedTileCache::GetSlot(unsigned index) const
+{
+  return 0;
+}
+
+void
+DecodedTileCache::Load(unsigned index, short *dest, unsigned n) const
+{
+  assert(false);
+}
+
+void
+DecodedTileCache::Store(unsigned index, const short *src, unsigned n)
+{
+}
+
+#endif
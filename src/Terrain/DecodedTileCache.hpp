@@ -0,0 +1,184 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_DECODED_TILE_CACHE_HPP
+#define XCSOAR_DECODED_TILE_CACHE_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <tchar.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * An on-disk cache of decoded terrain tiles.  Decoding a JPEG2000
+ * tile is expensive; with this cache, it needs to be done only once,
+ * and activating the tile later is just a page-in of the memory
+ * mapped file.
+ *
+ * The file consists of a header, a table which maps each tile number
+ * to a slot, and the slots in the order in which the tiles were
+ * stored.  All slots have the size of a full tile.  The whole
+ * possible file size is mapped at once, and the file grows as tiles
+ * get stored.
+ *
+ * This is only implemented on POSIX systems; elsewhere, Open() always
+ * fails.
+ */
+class DecodedTileCache : private NonCopyable {
+public:
+  /**
+   * Identifies the terrain file a cache was created for.
+   */
+  struct Source {
+    /**
+     * Size and modification time of the file containing the terrain
+     * (usually the map archive).
+     */
+    uint64_t size, mtime;
+
+    /**
+     * A hash of the terrain's metadata.
+     */
+    uint32_t hash;
+
+    bool operator==(const Source &other) const {
+      return size == other.size && mtime == other.mtime &&
+        hash == other.hash;
+    }
+
+    bool operator!=(const Source &other) const {
+      return !(*this == other);
+    }
+  };
+
+private:
+  struct Header {
+    uint32_t magic;
+
+    uint32_t n_tiles;
+
+    Source source;
+
+    /**
+     * The size of each slot in bytes.
+     */
+    uint32_t slot_size;
+  };
+
+#ifdef HAVE_POSIX
+  int fd;
+#endif
+
+  /**
+   * The memory mapping of the file, or nullptr if the cache is not
+   * open.
+   */
+  const uint8_t *data;
+
+  size_t mapping_size;
+
+  unsigned n_tiles;
+
+  size_t slot_size;
+
+  /**
+   * The file offset of the first slot.
+   */
+  size_t slots_offset;
+
+  /**
+   * The number of slots in the file.
+   */
+  unsigned n_slots;
+
+public:
+  DecodedTileCache()
+    :
+#ifdef HAVE_POSIX
+    fd(-1),
+#endif
+    data(nullptr) {}
+
+  ~DecodedTileCache() {
+    Close();
+  }
+
+  bool IsOpen() const {
+    return data != nullptr;
+  }
+
+  /**
+   * Open the cache file, or create it if it does not exist.  If the
+   * file was created for a different terrain file, it is discarded.
+   *
+   * @param source identifies the terrain file
+   * @param n_tiles the number of tiles in the terrain file
+   * @param tile_size the maximum number of pixels per tile
+   * @return true on success
+   */
+  bool Open(const TCHAR *path, const Source &source,
+            unsigned n_tiles, unsigned tile_size);
+
+  void Close();
+
+  /**
+   * Has the specified tile been stored in this cache?
+   */
+  gcc_pure
+  bool Contains(unsigned index) const {
+    return IsOpen() && GetSlot(index) != 0;
+  }
+
+  /**
+   * Copy the specified tile from the cache.  The caller must check
+   * Contains() first.
+   *
+   * @param n the number of pixels of this tile
+   */
+  void Load(unsigned index, short *dest, unsigned n) const;
+
+  /**
+   * Store a decoded tile in the cache.  Errors are ignored, the tile
+   * will be decoded again next time.
+   *
+   * @param n the number of pixels of this tile
+   */
+  void Store(unsigned index, const short *src, unsigned n);
+
+private:
+  /**
+   * Discard all tiles and write a new header.
+   */
+  bool Clear(const Source &source);
+
+  /**
+   * Returns the slot number plus one, or 0 if the tile is not stored
+   * in this cache.
+   */
+  gcc_pure
+  uint32_t GetSlot(unsigned index) const;
+};
+
+#endif
@@ -30,7 +30,10 @@ Copyright_License {
 #include "Projection/WindowProjection.hpp"
 #endif
 
+#include <algorithm>
+
 #include <assert.h>
+#include <stdlib.h>
 
 void
 HeightMatrix::SetSize(size_t _size)
@@ -81,18 +84,90 @@ void
 HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
                    unsigned quantisation_pixels, bool interpolate)
 {
-  const unsigned screen_width = projection.GetScreenWidth();
-  const unsigned screen_height = projection.GetScreenHeight();
+  SetSize(projection.GetScreenWidth(), projection.GetScreenHeight(),
+          quantisation_pixels);
 
-  SetSize((screen_width + quantisation_pixels - 1) / quantisation_pixels,
-          (screen_height + quantisation_pixels - 1) / quantisation_pixels);
+  Fill(map, projection, quantisation_pixels, interpolate,
+       0, 0, width, height);
+}
 
-  short *p = data.begin();
-  for (unsigned y = 0; y < screen_height;
-       y += quantisation_pixels, p += width) {
-    map.ScanLine(projection.ScreenToGeo(0, y),
-                 projection.ScreenToGeo(screen_width, y),
-                 p, width, interpolate);
+/**
+ * The step between two cells is measured over this many cells, to
+ * reduce the rounding error.
+ */
+static constexpr unsigned REFERENCE_STEPS = 256;
+
+/**
+ * Divide, rounding towards negative infinity.
+ */
+gcc_const
+static int
+DivideFloor(int a, int b)
+{
+  assert(b > 0);
+
+  return (a >= 0 ? a : a - b + 1) / b;
+}
+
+void
+HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
+                   unsigned quantisation_pixels, bool interpolate,
+                   unsigned x_start, unsigned y_start,
+                   unsigned x_end, unsigned y_end)
+{
+  assert(x_start < x_end);
+  assert(x_end <= width);
+  assert(y_start <= y_end);
+  assert(y_end <= height);
+
+  const int q = quantisation_pixels;
+
+  /* cell (x, y) is sampled at screen position (x, y) * q; each row
+     is scanned relative to the cell column which contains the screen
+     origin, which makes the value of a cell independent of the range
+     being filled, and of panning the map by whole cells */
+  const int origin_x = DivideFloor(projection.GetScreenOrigin().x, q);
+
+  for (unsigned y = y_start; y < y_end; ++y) {
+    const int screen_y = y * q;
+    map.ScanSteps(projection.ScreenToGeo(origin_x * q, screen_y),
+                  projection.ScreenToGeo((origin_x + REFERENCE_STEPS) * q,
+                                         screen_y),
+                  REFERENCE_STEPS, int(x_start) - origin_x,
+                  data.begin() + y * width + x_start, x_end - x_start,
+                  interpolate);
+  }
+}
+
+void
+HeightMatrix::Scroll(int dx, int dy)
+{
+  assert(unsigned(abs(dx)) < width);
+  assert(unsigned(abs(dy)) < height);
+
+  const unsigned src_x = std::max(dx, 0), dest_x = std::max(-dx, 0);
+  const unsigned n = width - abs(dx);
+  const unsigned dest_y_start = std::max(-dy, 0);
+  const unsigned dest_y_end = height - std::max(dy, 0);
+
+  const auto move_row = [this, src_x, dest_x, n, dy](unsigned y) {
+    const short *src = GetRow(y + dy) + src_x;
+    std::copy(src, src + n, data.begin() + y * width + dest_x);
+  };
+
+  if (dy > 0 || (dy == 0 && dx > 0)) {
+    /* moving towards the start of the buffer */
+    for (unsigned y = dest_y_start; y < dest_y_end; ++y)
+      move_row(y);
+  } else if (dy < 0) {
+    for (unsigned y = dest_y_end; y-- > dest_y_start;)
+      move_row(y);
+  } else if (dx < 0) {
+    /* moving within each row towards its end */
+    for (unsigned y = 0; y < height; ++y) {
+      const short *src = GetRow(y);
+      std::copy_backward(src, src + n, data.begin() + y * width + width);
+    }
   }
 }
 
@@ -61,6 +61,25 @@ public:
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
             unsigned quantisation_pixels, bool interpolate);
+
+  /**
+   * Fill only the specified range of cells, without changing the
+   * size.  The cells get exactly the same values as in a full Fill()
+   * call, even if the projection has been translated by whole cells
+   * in the meantime.
+   */
+  void Fill(const RasterMap &map, const WindowProjection &map_projection,
+            unsigned quantisation_pixels, bool interpolate,
+            unsigned x_start, unsigned y_start,
+            unsigned x_end, unsigned y_end);
+
+  /**
+   * Move the contents of the buffer, e.g. after the map has been
+   * panned: the cell at (x+dx, y+dy) is moved to (x, y).  The cells
+   * which are exposed keep undefined values; they can be filled
+   * with the range version of Fill().
+   */
+  void Scroll(int dx, int dy);
 #endif
 
   unsigned GetWidth() const {
@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "Terrain/RasterBuffer.hpp"
+#include "Terrain/BilinearBatch.hpp"
 #include "Math/FastMath.h"
 
 #include <algorithm>
@@ -77,6 +78,42 @@ RasterBuffer::GetInterpolated(unsigned lx, unsigned ly) const
   return GetInterpolated(lx, ly, ix, iy);
 }
 
+void
+RasterBuffer::GetInterpolated(unsigned lx, unsigned ly,
+                              unsigned ix, unsigned iy,
+                              BilinearBatch &batch) const
+{
+  assert(IsDefined());
+  assert(lx < GetWidth());
+  assert(ly < GetHeight());
+
+  const unsigned int dx = (lx == GetWidth() - 1) ? 0 : 1;
+  const unsigned int dy = (ly == GetHeight() - 1) ? 0 : GetWidth();
+  const short *tm = GetDataAt(lx, ly);
+
+  if (IsSpecial(*tm) || IsSpecial(tm[dx]) ||
+      IsSpecial(tm[dy]) || IsSpecial(tm[dx + dy])) {
+    batch.AppendValue(*tm);
+    return;
+  }
+
+  batch.Append(tm, dx, dy, ix, iy);
+}
+
+void
+RasterBuffer::GetInterpolated(unsigned lx, unsigned ly,
+                              BilinearBatch &batch) const
+{
+  const unsigned int ix = CombinedDivAndMod(lx);
+  const unsigned int iy = CombinedDivAndMod(ly);
+  if (lx >= GetWidth() || ly >= GetHeight()) {
+    batch.AppendValue(TERRAIN_INVALID);
+    return;
+  }
+
+  GetInterpolated(lx, ly, ix, iy, batch);
+}
+
 /**
  * This class implements an algorithm to traverse pixels quickly with
  * only integer addition, no multiplication and division.
@@ -114,6 +151,41 @@ public:
   }
 };
 
+/**
+ * Steps through the positions "start + (i * delta) / size" for
+ * i=0..size with only integer addition.  The results are exactly the
+ * same as those of the division (rounding towards zero), but without
+ * its cost and without the risk of overflowing "i * delta".
+ */
+class LineStepper
+{
+  unsigned start;
+  bool backwards;
+  unsigned quotient, remainder, size;
+  unsigned offset, counter;
+
+public:
+  LineStepper(unsigned _start, int delta, unsigned _size)
+    :start(_start), backwards(delta < 0),
+     quotient(abs(delta) / _size), remainder(abs(delta) % _size),
+     size(_size), offset(0), counter(0) {
+    assert(size > 0);
+  }
+
+  unsigned Get() const {
+    return backwards ? start - offset : start + offset;
+  }
+
+  void Next() {
+    /* branch-free, because the carry follows no predictable
+       pattern */
+    counter += remainder;
+    const unsigned carry = counter >= size;
+    offset += quotient + carry;
+    counter -= size & -carry;
+  }
+};
+
 void
 RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
                                  short *gcc_restrict buffer, unsigned size,
@@ -140,13 +212,43 @@ RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
 
     unsigned cy = y;
     const unsigned int iy = CombinedDivAndMod(cy);
-
-    --size;
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
+    const unsigned int ky = 0x100 - iy;
+
+    const short *gcc_restrict top = GetDataAt(0, cy);
+    const short *gcc_restrict bottom = cy == GetHeight() - 1
+      ? top
+      : top + GetWidth();
+    const unsigned last_column = GetWidth() - 1;
+
+    /* bilinear interpolation is separable: the two rows are blended
+       once per raster column, and each sample is a linear
+       interpolation between two blended columns; in 32 bit modular
+       arithmetic, the result is exactly the same as
+       GetInterpolated() */
+    unsigned column = unsigned(-1);
+    unsigned left = 0, right = 0;
+    bool special = false;
+
+    LineStepper x(ax, dx, size - 1);
+    for (short *const end = buffer + size; buffer < end;
+         ++buffer, x.Next()) {
+      unsigned cx = x.Get();
       const unsigned int ix = CombinedDivAndMod(cx);
 
-      *buffer++ = GetInterpolated(cx, cy, ix, iy);
+      if (cx != column) {
+        /* entered a new raster column; when zoomed in, this happens
+           only every few samples */
+        column = cx;
+        const unsigned next = cx == last_column ? cx : cx + 1;
+        special = IsSpecial(top[cx]) || IsSpecial(top[next]) ||
+          IsSpecial(bottom[cx]) || IsSpecial(bottom[next]);
+        left = top[cx] * ky + bottom[cx] * iy;
+        right = top[next] * ky + bottom[next] * iy;
+      }
+
+      *buffer = special
+        ? top[cx]
+        : (left * (0x100 - ix) + right * ix) >> 16;
     }
   } else if (gcc_likely(dx > 0)) {
     /* no interpolation needed, forward scan */
@@ -166,12 +268,9 @@ RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
 
     const short *gcc_restrict src = GetDataAt(0, y >> 8);
 
-    --size;
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-
-      *buffer++ = src[cx >> 8];
-    }
+    LineStepper x(ax, dx, size - 1);
+    for (short *const end = buffer + size; buffer < end; x.Next())
+      *buffer++ = src[x.Get() >> 8];
   }
 }
 
@@ -206,24 +305,158 @@ RasterBuffer::ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
   if (interpolate && (unsigned)(abs(dx) + abs(dy)) < (2 * size << 8u)) {
     /* interpolate */
 
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-      unsigned cy = ay + (i * dy) / (int)size;
+    /* the four raster pixels of the current cell; when zoomed in,
+       many consecutive samples are within the same cell */
+    const short *cell = NULL;
+    int top_left = 0, top_right = 0, bottom_left = 0, bottom_right = 0;
+    bool special = false;
+
+    LineStepper x(ax, dx, size), y(ay, dy, size);
+    for (short *const end = buffer + size + 1; buffer < end;
+         ++buffer, x.Next(), y.Next()) {
+      unsigned cx = x.Get(), cy = y.Get();
 
       const unsigned int ix = CombinedDivAndMod(cx);
       const unsigned int iy = CombinedDivAndMod(cy);
 
-      *buffer++ = GetInterpolated(cx, cy, ix, iy);
+      const short *tm = GetDataAt(cx, cy);
+      if (tm != cell) {
+        cell = tm;
+        const unsigned int x1 = (cx == GetWidth() - 1) ? 0 : 1;
+        const unsigned int y1 = (cy == GetHeight() - 1) ? 0 : GetWidth();
+        top_left = tm[0];
+        top_right = tm[x1];
+        bottom_left = tm[y1];
+        bottom_right = tm[x1 + y1];
+        special = IsSpecial(top_left) || IsSpecial(top_right) ||
+          IsSpecial(bottom_left) || IsSpecial(bottom_right);
+      }
+
+      if (special) {
+        *buffer = top_left;
+        continue;
+      }
+
+      const unsigned int kx = 0x100 - ix, ky = 0x100 - iy;
+      *buffer = (top_left * kx * ky + top_right * ix * ky +
+                 bottom_left * kx * iy + bottom_right * ix * iy) >> 16;
     }
   } else {
     /* no interpolation needed */
 
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-      unsigned cy = ay + (i * dy) / (int)size;
+    LineStepper x(ax, dx, size), y(ay, dy, size);
+    for (short *const end = buffer + size + 1; buffer < end;
+         x.Next(), y.Next())
+      *buffer++ = Get(x.Get() >> 8, y.Get() >> 8);
+  }
+}
+
+void
+RasterBuffer::ScanSteps(int64_t x, int64_t y, int64_t dx, int64_t dy,
+                        unsigned fraction_bits,
+                        short *gcc_restrict buffer, unsigned size,
+                        bool interpolate) const
+{
+  assert(fraction_bits >= 8);
+  assert(x >= 0 && (x >> fraction_bits) < GetWidth());
+  assert(y >= 0 && (y >> fraction_bits) < GetHeight());
+  assert(buffer != NULL);
+  assert(size > 0);
+
+  /* the interpolation needs the positions in 1/256 pixels */
+  const unsigned fine_shift = fraction_bits - 8;
 
-      *buffer++ = Get(cx >> 8, cy >> 8);
+  const int64_t step = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+  /* disable interpolation when an output pixel is larger than two
+     pixels in our buffer, like ScanLine() does */
+  if (interpolate && step < (int64_t(2) << fraction_bits)) {
+    if (dy == 0) {
+      /* north-up: blend the two rows once per raster column, like
+         ScanHorizontalLine() */
+
+      unsigned cy = unsigned(y >> fine_shift);
+      const unsigned int iy = CombinedDivAndMod(cy);
+      const unsigned int ky = 0x100 - iy;
+
+      const short *gcc_restrict top = GetDataAt(0, cy);
+      const short *gcc_restrict bottom = cy == GetHeight() - 1
+        ? top
+        : top + GetWidth();
+      const unsigned last_column = GetWidth() - 1;
+
+      unsigned column = unsigned(-1);
+      unsigned left = 0, right = 0;
+      bool special = false;
+
+      for (short *const end = buffer + size; buffer < end;
+           ++buffer, x += dx) {
+        unsigned cx = unsigned(x >> fine_shift);
+        const unsigned int ix = CombinedDivAndMod(cx);
+
+        if (cx != column) {
+          column = cx;
+          const unsigned next = cx == last_column ? cx : cx + 1;
+          special = IsSpecial(top[cx]) || IsSpecial(top[next]) ||
+            IsSpecial(bottom[cx]) || IsSpecial(bottom[next]);
+          left = top[cx] * ky + bottom[cx] * iy;
+          right = top[next] * ky + bottom[next] * iy;
+        }
+
+        *buffer = special
+          ? top[cx]
+          : (left * (0x100 - ix) + right * ix) >> 16;
+      }
+    } else {
+      /* keep the four raster pixels of the current cell, like
+         ScanLine() */
+
+      const short *cell = NULL;
+      int top_left = 0, top_right = 0, bottom_left = 0, bottom_right = 0;
+      bool special = false;
+
+      for (short *const end = buffer + size; buffer < end;
+           ++buffer, x += dx, y += dy) {
+        unsigned cx = unsigned(x >> fine_shift);
+        unsigned cy = unsigned(y >> fine_shift);
+
+        const unsigned int ix = CombinedDivAndMod(cx);
+        const unsigned int iy = CombinedDivAndMod(cy);
+
+        const short *tm = GetDataAt(cx, cy);
+        if (tm != cell) {
+          cell = tm;
+          const unsigned int x1 = (cx == GetWidth() - 1) ? 0 : 1;
+          const unsigned int y1 = (cy == GetHeight() - 1) ? 0 : GetWidth();
+          top_left = tm[0];
+          top_right = tm[x1];
+          bottom_left = tm[y1];
+          bottom_right = tm[x1 + y1];
+          special = IsSpecial(top_left) || IsSpecial(top_right) ||
+            IsSpecial(bottom_left) || IsSpecial(bottom_right);
+        }
+
+        if (special) {
+          *buffer = top_left;
+          continue;
+        }
+
+        const unsigned int kx = 0x100 - ix, ky = 0x100 - iy;
+        *buffer = (top_left * kx * ky + top_right * ix * ky +
+                   bottom_left * kx * iy + bottom_right * ix * iy) >> 16;
+      }
     }
+  } else if (dy == 0) {
+    /* no interpolation needed, north-up */
+
+    const short *gcc_restrict src = GetDataAt(0, unsigned(y >> fraction_bits));
+    for (short *const end = buffer + size; buffer < end; x += dx)
+      *buffer++ = src[x >> fraction_bits];
+  } else {
+    /* no interpolation needed */
+
+    for (short *const end = buffer + size; buffer < end; x += dx, y += dy)
+      *buffer++ = Get(unsigned(x >> fraction_bits),
+                      unsigned(y >> fraction_bits));
   }
 }
 
@@ -29,6 +29,9 @@ Copyright_License {
 #include "Compiler.h"
 
 #include <cstddef>
+#include <stdint.h>
+
+class BilinearBatch;
 
 class RasterBuffer : private NonCopyable {
 public:
@@ -112,6 +115,10 @@ public:
 
   void Resize(unsigned _width, unsigned _height);
 
+  void Swap(RasterBuffer &other) {
+    data.Swap(other.data);
+  }
+
   gcc_pure
   short GetInterpolated(unsigned lx, unsigned ly,
                         unsigned ix, unsigned iy) const;
@@ -119,6 +126,21 @@ public:
   gcc_pure
   short GetInterpolated(unsigned lx, unsigned ly) const;
 
+  /**
+   * Like GetInterpolated(), but queue the calculation in a
+   * #BilinearBatch.  The result is available after
+   * BilinearBatch::Flush().
+   */
+  void GetInterpolated(unsigned lx, unsigned ly,
+                       unsigned ix, unsigned iy,
+                       BilinearBatch &batch) const;
+
+  /**
+   * Batch version of GetInterpolated(unsigned, unsigned).
+   */
+  void GetInterpolated(unsigned lx, unsigned ly,
+                       BilinearBatch &batch) const;
+
   gcc_pure
   short Get(unsigned x, unsigned y) const {
     return *GetDataAt(x, y);
@@ -137,6 +159,20 @@ public:
   void ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
                 short *buffer, unsigned size, bool interpolate) const;
 
+  /**
+   * Fill the buffer with the samples at the positions "(x, y) + i *
+   * (dx, dy)" for i=0..size-1.  Unlike ScanLine(), each position
+   * depends only on the start position, the step and its index, so
+   * a part of a line can be scanned with exactly the same results.
+   * All positions must be within the buffer.
+   *
+   * @param fraction_bits the number of fractional bits in the pixel
+   * positions; must be at least 8
+   */
+  void ScanSteps(int64_t x, int64_t y, int64_t dx, int64_t dy,
+                 unsigned fraction_bits,
+                 short *buffer, unsigned size, bool interpolate) const;
+
   /**
    * Wrapper for ScanLine() with basic range checks.
    */
@@ -24,8 +24,11 @@ Copyright_License {
 #include "Terrain/RasterMap.hpp"
 #include "Geo/GeoClip.hpp"
 #include "IO/FileCache.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/PathName.hpp"
 #include "Util/ConvertString.hpp"
 
+#include <windef.h> /* for MAX_PATH */
 #include <algorithm>
 #include <assert.h>
 #include <string.h>
@@ -66,6 +69,22 @@ RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
     }
   }
 
+  if (cache != NULL) {
+    /* keep decoded tiles on disk, to avoid decoding them again */
+    const TCHAR *name = _T("terrain-tiles");
+    TCHAR buffer[cache->PathBufferSize(name)];
+
+    /* the terrain is usually a member of the map archive, which is
+       the regular file identifying it */
+    TCHAR source_buffer[MAX_PATH];
+    const TCHAR *source_path = File::Exists(_path)
+      ? _path
+      : DirName(_path, source_buffer);
+
+    raster_tile_cache.OpenDecodedTiles(cache->MakeUnmanagedPath(buffer, name),
+                                       source_path);
+  }
+
   projection.Set(GetBounds(),
                  raster_tile_cache.GetFineWidth(),
                  raster_tile_cache.GetFineHeight());
@@ -81,12 +100,9 @@ AngleToPixel(Angle value, Angle start, Angle end, unsigned width)
   return unsigned((value - start).Native() * width / (end - start).Native());
 }
 
-void
-RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
+RasterLocation
+RasterMap::ToPixel(const GeoPoint &location) const
 {
-  if (!raster_tile_cache.GetInitialised())
-    return;
-
   const GeoBounds &bounds = GetBounds();
 
   int x = AngleToPixel(location.longitude, bounds.GetWest(), bounds.GetEast(),
@@ -95,10 +111,42 @@ RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
   int y = AngleToPixel(location.latitude, bounds.GetNorth(), bounds.GetSouth(),
                        raster_tile_cache.GetHeight());
 
-  raster_tile_cache.UpdateTiles(path, x, y,
+  return RasterLocation(x, y);
+}
+
+void
+RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
+{
+  if (!raster_tile_cache.GetInitialised())
+    return;
+
+  const RasterLocation pt = ToPixel(location);
+  raster_tile_cache.UpdateTiles(path, pt.x, pt.y,
                                 projection.DistancePixelsCoarse(radius));
 }
 
+bool
+RasterMap::PollTiles(const GeoPoint &location, fixed radius)
+{
+  if (!raster_tile_cache.GetInitialised())
+    return false;
+
+  const RasterLocation pt = ToPixel(location);
+  return raster_tile_cache.PollTiles(pt.x, pt.y,
+                                     projection.DistancePixelsCoarse(radius));
+}
+
+bool
+RasterMap::PollPrefetchTiles(const GeoPoint &location, fixed radius)
+{
+  if (!raster_tile_cache.GetInitialised() || !IsInside(location))
+    return false;
+
+  const RasterLocation pt = ToPixel(location);
+  return raster_tile_cache.PollPrefetchTiles(pt.x, pt.y,
+                                             projection.DistancePixelsCoarse(radius));
+}
+
 short
 RasterMap::GetHeight(const GeoPoint &location) const
 {
@@ -113,6 +161,50 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const
   return raster_tile_cache.GetInterpolatedHeight(pt.x, pt.y);
 }
 
+/**
+ * The number of locations projected in one chunk by GetHeights() and
+ * GetInterpolatedHeights().
+ */
+static constexpr unsigned PROJECT_CHUNK = 64;
+
+void
+RasterMap::GetHeights(const GeoPoint *locations, short *heights,
+                      unsigned n) const
+{
+  RasterLocation buffer[PROJECT_CHUNK];
+
+  while (n > 0) {
+    const unsigned chunk = std::min(n, PROJECT_CHUNK);
+    for (unsigned i = 0; i < chunk; ++i)
+      buffer[i] = projection.ProjectCoarse(locations[i]);
+
+    raster_tile_cache.GetHeights(buffer, heights, chunk);
+
+    locations += chunk;
+    heights += chunk;
+    n -= chunk;
+  }
+}
+
+void
+RasterMap::GetInterpolatedHeights(const GeoPoint *locations, short *heights,
+                                  unsigned n) const
+{
+  RasterLocation buffer[PROJECT_CHUNK];
+
+  while (n > 0) {
+    const unsigned chunk = std::min(n, PROJECT_CHUNK);
+    for (unsigned i = 0; i < chunk; ++i)
+      buffer[i] = projection.ProjectFine(locations[i]);
+
+    raster_tile_cache.GetInterpolatedHeights(buffer, heights, chunk);
+
+    locations += chunk;
+    heights += chunk;
+    n -= chunk;
+  }
+}
+
 void
 RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
                     short *buffer, unsigned size, bool interpolate) const
@@ -186,6 +278,34 @@ RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
                              interpolate);
 }
 
+void
+RasterMap::ScanSteps(const GeoPoint &origin, const GeoPoint &reference,
+                     unsigned reference_steps, int first,
+                     short *buffer, unsigned size, bool interpolate) const
+{
+  assert(reference_steps > 0);
+  assert(buffer != NULL);
+  assert(size > 0);
+
+  /* convert to map pixels in 32.32 fixed point; the "fine" locations
+     have 8 fractional bits, and may be negative outside of the
+     map */
+  static constexpr int64_t FINE_TO_FIXED =
+    int64_t(1) << (32 - RasterTileCache::SUBPIXEL_BITS);
+
+  const RasterLocation a = projection.ProjectFine(origin);
+  const RasterLocation b = projection.ProjectFine(reference);
+
+  const int64_t dx = int64_t((int)b.x - (int)a.x) * FINE_TO_FIXED /
+    int(reference_steps);
+  const int64_t dy = int64_t((int)b.y - (int)a.y) * FINE_TO_FIXED /
+    int(reference_steps);
+
+  raster_tile_cache.ScanSteps(int64_t((int)a.x) * FINE_TO_FIXED + first * dx,
+                              int64_t((int)a.y) * FINE_TO_FIXED + first * dy,
+                              dx, dy, buffer, size, interpolate);
+}
+
 bool
 RasterMap::FirstIntersection(const GeoPoint &origin, const int h_origin,
                              const GeoPoint &destination, const int h_destination,
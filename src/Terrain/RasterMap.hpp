@@ -63,8 +63,44 @@ public:
     return GetBounds().GetCenter();
   }
 
+  /**
+   * Load the tiles around the specified location synchronously.
+   */
   void SetViewCenter(const GeoPoint &location, fixed radius);
 
+  /**
+   * Asynchronous version of SetViewCenter(), phase 1: determine
+   * which tiles are needed.  Caller must hold an exclusive lock.
+   *
+   * @return true if LoadTiles() and PublishTiles() shall be called
+   * @see RasterTileCache::PollTiles()
+   */
+  bool PollTiles(const GeoPoint &location, fixed radius);
+
+  /**
+   * Request tiles around a location which is expected to come into
+   * view soon; to be used instead of PollTiles().
+   *
+   * @see RasterTileCache::PollPrefetchTiles()
+   */
+  bool PollPrefetchTiles(const GeoPoint &location, fixed radius);
+
+  /**
+   * Phase 2: decode the requested tiles.  Caller must hold a shared
+   * lock.
+   */
+  void LoadTiles() {
+    raster_tile_cache.LoadTiles(path);
+  }
+
+  /**
+   * Phase 3: make the decoded tiles available.  Caller must hold an
+   * exclusive lock.
+   */
+  void PublishTiles() {
+    raster_tile_cache.PublishTiles();
+  }
+
   /**
    * Determines if SetViewCenter() should be called again to continue
    * loading.
@@ -100,6 +136,19 @@ public:
   gcc_pure
   short GetInterpolatedHeight(const GeoPoint &location) const;
 
+  /**
+   * Batch version of GetHeight(), which is faster for many locations
+   * which are close to each other.
+   */
+  void GetHeights(const GeoPoint *locations, short *heights,
+                  unsigned n) const;
+
+  /**
+   * Batch version of GetInterpolatedHeight().
+   */
+  void GetInterpolatedHeights(const GeoPoint *locations, short *heights,
+                              unsigned n) const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -107,6 +156,16 @@ public:
   void ScanLine(const GeoPoint &start, const GeoPoint &end,
                 short *buffer, unsigned size, bool interpolate) const;
 
+  /**
+   * Fill the buffer with samples at the locations "origin + i *
+   * (reference - origin) / reference_steps" for i=first..first+size-1.
+   * Unlike ScanLine(), the value of a sample does not depend on
+   * which part of the line is being scanned.
+   */
+  void ScanSteps(const GeoPoint &origin, const GeoPoint &reference,
+                 unsigned reference_steps, int first,
+                 short *buffer, unsigned size, bool interpolate) const;
+
   gcc_pure
   bool FirstIntersection(const GeoPoint &origin, int h_origin,
                          const GeoPoint &destination, int h_destination,
@@ -130,6 +189,9 @@ public:
                         int h_origin, int h_glide,
                         const GeoPoint& destination) const;
 
+private:
+  gcc_pure
+  RasterLocation ToPixel(const GeoPoint &location) const;
 };
 
 
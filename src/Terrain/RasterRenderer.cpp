@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/SlopeShading.hpp"
 #include "Math/FastMath.h"
 #include "Util/Clamp.hpp"
 #include "Screen/Ramp.hpp"
@@ -31,12 +32,28 @@ Copyright_License {
 #include "Projection/WindowProjection.hpp"
 #include "Asset.hpp"
 #include "Event/Idle.hpp"
+#include "Thread/WorkerPool.hpp"
+
+#include <algorithm>
 
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 //#define FAST_RSQRT
 
+/**
+ * The maximum number of bands: one for each pool thread plus one for
+ * the calling thread.
+ */
+static constexpr unsigned MAX_BANDS = WorkerPool::MAX_THREADS + 1;
+
+/**
+ * Don't split the image into bands smaller than this; for tiny
+ * images, the synchronisation would cost more than it saves.
+ */
+static constexpr unsigned MIN_BAND_HEIGHT = 16;
+
 constexpr
 static inline unsigned
 MIX(unsigned x, unsigned y, unsigned i)
@@ -79,14 +96,22 @@ ContourInterval(const int h, const unsigned contour_height_scale)
   return std::min(254u, unsigned(h) >> contour_height_scale);
 }
 
+/**
+ * A contour column buffer value which ContourInterval() never
+ * returns.
+ */
+static constexpr unsigned char NO_CONTOUR = 0xff;
+
 RasterRenderer::RasterRenderer()
   :quantisation_pixels(2),
 #ifdef ENABLE_OPENGL
    last_quantisation_pixels(-1),
    bounds(GeoBounds::Invalid()),
 #endif
+   valid_rect(0, 0, 0, 0),
    image(NULL),
-   contour_column_base(NULL)
+   contour_column_base(NULL),
+   worker_pool(nullptr)
 {
   // scale quantisation_pixels so resolution is not too high on old hardware
   // with large displays
@@ -128,20 +153,26 @@ RasterRenderer::UpdateQuantisation()
 
 #endif
 
-void
-RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection)
+/**
+ * Determine the geographic edge length of a cell in the screen
+ * centre, and return the step size used for slope calculations (0
+ * disables slope shading).
+ */
+static unsigned
+CalculateResolution(const RasterMap &map, const WindowProjection &projection,
+                    unsigned quantisation_pixels, fixed &pixel_size)
 {
   // Coordinates of the MapWindow center
   unsigned x = projection.GetScreenWidth() / 2;
   unsigned y = projection.GetScreenHeight() / 2;
   // GeoPoint corresponding to the MapWindow center
   GeoPoint Gmid = projection.ScreenToGeo(x, y);
-  // GeoPoint "next to" Gmid (depends on terrain resolution)
-  GeoPoint Gneighbor = projection.ScreenToGeo(x + quantisation_pixels,
-                                              y + quantisation_pixels);
 
-  // Geographical edge length of pixel in the MapWindow center in meters
-  pixel_size = fixed_sqrt_half * Gmid.Distance(Gneighbor);
+  /* Geographical edge length of pixel in meters; this is derived
+     from the scale, because measuring the distance to a neighbouring
+     pixel suffers from the integer rotation of the screen
+     coordinates, which would make it depend on the map position */
+  pixel_size = projection.DistancePixelsToMeters(quantisation_pixels);
 
   // set resolution
 
@@ -151,15 +182,25 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
 
     fixed map_pixel_size = map.PixelDistance(Gmid, 1);
     fixed q = map_pixel_size / pixel_size;
-    quantisation_effective = std::max(1, (int)q);
+    const unsigned quantisation_effective = std::max(1, (int)q);
 
     if (quantisation_effective > 25)
       /* disable slope shading when zoomed in very near (not enough
          terrain resolution to make a useful slope calculation) */
-      quantisation_effective = 0;
+      return 0;
+
+    return quantisation_effective;
   } else
     /* disable slope shading when zoomed out very far (too tiny) */
-    quantisation_effective = 0;
+    return 0;
+}
+
+void
+RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection)
+{
+  quantisation_effective = CalculateResolution(map, projection,
+                                               quantisation_pixels,
+                                               pixel_size);
 
 #ifdef ENABLE_OPENGL
   bounds = projection.GetScreenBounds().Scale(fixed(1.5));
@@ -171,9 +212,170 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
   last_quantisation_pixels = quantisation_pixels;
 #else
   height_matrix.Fill(map, projection, quantisation_pixels, true);
+  scan_projection = projection;
 #endif
+
+  valid_rect = CellRect(0, 0, 0, 0);
+}
+
+#ifndef ENABLE_OPENGL
+
+/**
+ * Divide, rounding to the nearest integer.
+ */
+gcc_const
+static int
+DivideRound(int a, int b)
+{
+  assert(b > 0);
+
+  return (a >= 0 ? a + b / 2 : a - b / 2) / b;
+}
+
+bool
+RasterRenderer::ScrollMap(const RasterMap &map,
+                          const WindowProjection &projection)
+{
+  const unsigned screen_width = projection.GetScreenWidth();
+  const unsigned screen_height = projection.GetScreenHeight();
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  if (image == nullptr || !scan_projection.IsValid() ||
+      screen_width != scan_projection.GetScreenWidth() ||
+      screen_height != scan_projection.GetScreenHeight() ||
+      width < 4 || height < 4)
+    return false;
+
+  /* it's a translation if the scale is the same and the rotation
+     moves the screen corners by less than one pixel */
+  const Angle max_rotation =
+    Angle::Radians(fixed(2) / (screen_width + screen_height));
+  if (projection.GetScale() != scan_projection.GetScale() ||
+      !projection.GetScreenAngle().CompareRoughly(scan_projection.GetScreenAngle(),
+                                                  max_rotation))
+    return false;
+
+  /* where is the new screen origin in the current height matrix? */
+  const RasterPoint new_origin = projection.GetScreenOrigin();
+  RasterPoint offset =
+    scan_projection.GeoToScreen(projection.GetGeoLocation());
+  offset.x -= new_origin.x;
+  offset.y -= new_origin.y;
+
+  /* GeoToScreen() gets less accurate far away from the geographic
+     location of the projection; don't let the screen origin wander
+     too far */
+  const RasterPoint origin = scan_projection.GetScreenOrigin();
+  if (unsigned(abs(origin.x - offset.x - new_origin.x)) > 2 * screen_width ||
+      unsigned(abs(origin.y - offset.y - new_origin.y)) > 2 * screen_height)
+    return false;
+
+  const int q = quantisation_pixels;
+  const int dx = DivideRound(offset.x, q);
+  const int dy = DivideRound(offset.y, q);
+
+  /* if more than half of the image is new, there's not much to
+     gain */
+  if (unsigned(abs(dx)) * 2 > width || unsigned(abs(dy)) * 2 > height)
+    return false;
+
+  /* the slope step depends on the terrain resolution in the screen
+     centre; if it changes, every pixel may change */
+  fixed new_pixel_size;
+  if (CalculateResolution(map, projection, quantisation_pixels,
+                          new_pixel_size) != quantisation_effective)
+    return false;
+
+  /* the whole image remains valid, unless this is changed below */
+  valid_rect = CellRect(0, 0, width, height);
+
+  if (dx == 0 && dy == 0)
+    /* less than half a cell: nothing to do */
+    return true;
+
+  height_matrix.Scroll(dx, dy);
+  ScrollImage(dx, dy);
+
+  scan_projection.SetScreenOrigin(origin.x - dx * q, origin.y - dy * q);
+
+  /* fill the exposed rows, then the exposed columns of the other
+     rows */
+
+  unsigned rows_top = 0, rows_bottom = height;
+  if (dy > 0) {
+    rows_bottom = height - dy;
+    height_matrix.Fill(map, scan_projection, quantisation_pixels, true,
+                       0, rows_bottom, width, height);
+  } else if (dy < 0) {
+    rows_top = -dy;
+    height_matrix.Fill(map, scan_projection, quantisation_pixels, true,
+                       0, 0, width, rows_top);
+  }
+
+  if (dx > 0)
+    height_matrix.Fill(map, scan_projection, quantisation_pixels, true,
+                       width - dx, rows_top, width, rows_bottom);
+  else if (dx < 0)
+    height_matrix.Fill(map, scan_projection, quantisation_pixels, true,
+                       0, rows_top, -dx, rows_bottom);
+
+  /* the pixels near the edges of the moved part must be generated
+     again: their slope was calculated with the neighbours which were
+     available at that time, and the contour lines depend on the
+     pixels left of and above them; one extra pixel makes the contour
+     state converge */
+  const int margin = quantisation_effective + 1;
+
+  if (dx != 0) {
+    valid_rect.left = std::max(-dx, 0) + margin;
+    valid_rect.right = std::max(int(width) - std::max(dx, 0) - margin, 0);
+  }
+
+  if (dy != 0) {
+    valid_rect.top = std::max(-dy, 0) + margin;
+    valid_rect.bottom = std::max(int(height) - std::max(dy, 0) - margin, 0);
+  }
+
+  return true;
 }
 
+void
+RasterRenderer::ScrollImage(int dx, int dy)
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  assert(unsigned(abs(dx)) < width);
+  assert(unsigned(abs(dy)) < height);
+
+  const unsigned src_x = std::max(dx, 0), dest_x = std::max(-dx, 0);
+  const unsigned n = width - abs(dx);
+  const unsigned dest_y_start = std::max(-dy, 0);
+  const unsigned dest_y_end = height - std::max(dy, 0);
+
+  /* rows may overlap with themselves (dy==0), which is why
+     std::copy_backward() is needed when moving to the right */
+  const auto move_row = [this, src_x, dest_x, n, dx, dy](unsigned y) {
+    const BGRColor *src = image->GetRow(y + dy) + src_x;
+    BGRColor *dest = image->GetRow(y) + dest_x;
+    if (dx > 0)
+      std::copy(src, src + n, dest);
+    else
+      std::copy_backward(src, src + n, dest + n);
+  };
+
+  if (dy > 0) {
+    for (unsigned y = dest_y_start; y < dest_y_end; ++y)
+      move_row(y);
+  } else {
+    for (unsigned y = dest_y_end; y-- > dest_y_start;)
+      move_row(y);
+  }
+}
+
+#endif
+
 void
 RasterRenderer::GenerateImage(bool do_shading,
                               unsigned height_scale,
@@ -189,7 +391,10 @@ RasterRenderer::GenerateImage(bool do_shading,
                           height_matrix.GetHeight());
 
     delete[] contour_column_base;
-    contour_column_base = new unsigned char[height_matrix.GetWidth()];
+    contour_column_base =
+      new unsigned char[height_matrix.GetWidth() * MAX_BANDS];
+
+    valid_rect = CellRect(0, 0, 0, 0);
   }
 
   if (quantisation_effective == 0) {
@@ -199,34 +404,139 @@ RasterRenderer::GenerateImage(bool do_shading,
 
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
-  ContourStart(contour_height_scale);
+  if (do_contour && !valid_rect.IsEmpty())
+    ConvergeContours(do_shading);
+
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  /* generate everything except the valid rectangle: the rows above
+     and below it, and the columns left and right of it */
+  CellRect dirty[4];
+  unsigned n_dirty = 0;
+  if (valid_rect.IsEmpty()) {
+    dirty[n_dirty++] = CellRect(0, 0, width, height);
+  } else {
+    dirty[n_dirty++] = CellRect(0, 0, width, valid_rect.top);
+    dirty[n_dirty++] = CellRect(0, valid_rect.bottom, width, height);
+    dirty[n_dirty++] = CellRect(0, valid_rect.top,
+                                valid_rect.left, valid_rect.bottom);
+    dirty[n_dirty++] = CellRect(valid_rect.right, valid_rect.top,
+                                width, valid_rect.bottom);
+  }
+
+  valid_rect = CellRect(0, 0, 0, 0);
 
-  if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
-                       sunazimuth, contour_height_scale);
-  else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
+  for (unsigned i = 0; i < n_dirty; ++i) {
+    const CellRect &rc = dirty[i];
+    if (rc.IsEmpty())
+      continue;
+
+    if (do_shading)
+      GenerateSlopeImage(rc, height_scale, contrast, brightness,
+                         sunazimuth, contour_height_scale);
+    else
+      GenerateUnshadedImage(rc, height_scale, contour_height_scale);
+  }
 
   image->SetDirty();
 }
 
+unsigned
+RasterRenderer::GetBandCount(unsigned height) const
+{
+  if (worker_pool == nullptr)
+    return 1;
+
+  const unsigned n = std::min(worker_pool->GetThreadCount() + 1,
+                              unsigned(MAX_BANDS));
+  return Clamp(height / MIN_BAND_HEIGHT, 1u, n);
+}
+
 void
-RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
+RasterRenderer::ForEachBand(const CellRect &rc,
+                            const unsigned contour_height_scale, bool slope,
+                            const BandFunction &f)
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = rc.bottom - rc.top;
+  const unsigned n_bands = GetBandCount(height);
+
+  const auto band_rect = [&](unsigned i) {
+    return CellRect(rc.left, rc.top + height * i / n_bands,
+                    rc.right, rc.top + height * (i + 1) / n_bands);
+  };
+
+  /* each band's contour column buffer receives the values the row
+     loop leaves behind in the band above it */
+  const auto contour_start = [&](unsigned i) {
+    unsigned char *column_base = contour_column_base + width * i;
+    if (i == 0)
+      ContourStart(column_base, rc, contour_height_scale, slope);
+    else
+      ContourEnd(column_base, band_rect(i - 1), contour_height_scale, slope);
+  };
+
+  const auto band = [&](unsigned i) {
+    const CellRect band = band_rect(i);
+    f(band.top, band.bottom, contour_column_base + width * i);
+  };
+
+  if (n_bands > 1) {
+    worker_pool->Run(n_bands, contour_start);
+
+    /* a column without any checked pixel in the band above inherits
+       the value from further above */
+    for (unsigned i = 1; i < n_bands; ++i) {
+      unsigned char *column_base = contour_column_base + width * i;
+      const unsigned char *above = column_base - width;
+      for (unsigned x = rc.left; x < rc.right; ++x)
+        if (column_base[x] == NO_CONTOUR)
+          column_base[x] = above[x];
+    }
+
+    worker_pool->Run(n_bands, band);
+  } else {
+    contour_start(0);
+    band(0);
+  }
+}
+
+void
+RasterRenderer::GenerateUnshadedImage(const CellRect &rc,
+                                      unsigned height_scale,
                                       const unsigned contour_height_scale)
 {
-  const short *src = height_matrix.GetData();
+  ForEachBand(rc, contour_height_scale, false,
+              [this, &rc, height_scale, contour_height_scale]
+              (unsigned y_start, unsigned y_end,
+               unsigned char *column_base) {
+      const CellRect band(rc.left, y_start, rc.right, y_end);
+      GenerateUnshadedRows(band, column_base,
+                           height_scale, contour_height_scale);
+    });
+}
+
+void
+RasterRenderer::GenerateUnshadedRows(const CellRect &rc,
+                                     unsigned char *column_base,
+                                     unsigned height_scale,
+                                     const unsigned contour_height_scale)
+{
   const BGRColor *oColorBuf = color_table + 64 * 256;
-  BGRColor *dest = image->GetTopRow();
+  BGRColor *dest = image->GetRow(rc.top);
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
-    BGRColor *p = dest;
+  for (unsigned y = rc.top; y < rc.bottom; ++y) {
+    const short *src = height_matrix.GetRow(y) + rc.left;
+    BGRColor *p = dest + rc.left;
     dest = image->GetNextRow(dest);
 
-    unsigned contour_row_base = ContourInterval(*src,
-                                                contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base = RowContourStart(rc.left, y,
+                                                contour_height_scale,
+                                                false);
+    unsigned char *contour_this_column_base = column_base + rc.left;
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
+    for (unsigned x = rc.right - rc.left; x > 0; --x) {
       int h = *src++;
       if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
         if (h < 0)
@@ -258,16 +568,27 @@ RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
 }
 
 /**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
+ * Determine the distance of the next row/column used for the slope
+ * calculation.  It is smaller at the bottom/right edge.
  */
 gcc_const
-static int
-ClipHeightDelta(int d)
+static inline unsigned
+SlopePlusIndex(unsigned i, unsigned size, unsigned quantisation_effective)
 {
-  return Clamp(d, -512, 512);
+  return i < size - quantisation_effective
+    ? quantisation_effective
+    : size - 1 - i;
+}
+
+/**
+ * Determine the distance of the previous row/column used for the
+ * slope calculation.  It is smaller at the top/left edge.
+ */
+gcc_const
+static inline unsigned
+SlopeMinusIndex(unsigned i, unsigned quantisation_effective)
+{
+  return i >= quantisation_effective ? quantisation_effective : i;
 }
 
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
@@ -276,19 +597,30 @@ ClipHeightDelta(int d)
 // (gridding of display) This is why quantisation_effective is used instead of 1
 // previously.  for large zoom levels, quantisation_effective=1
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const CellRect &rc,
+                                   unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
                                    const unsigned contour_height_scale)
 {
   assert(quantisation_effective > 0);
 
-  PixelRect border;
-  border.left = quantisation_effective;
-  border.top = quantisation_effective;
-  border.right = height_matrix.GetWidth() - quantisation_effective;
-  border.bottom = height_matrix.GetHeight() - quantisation_effective;
+  ForEachBand(rc, contour_height_scale, true,
+              [=](unsigned y_start, unsigned y_end,
+                  unsigned char *column_base) {
+      const CellRect band(rc.left, y_start, rc.right, y_end);
+      GenerateSlopeRows(band, column_base, height_scale, contrast,
+                        sx, sy, sz, contour_height_scale);
+    });
+}
 
+void
+RasterRenderer::GenerateSlopeRows(const CellRect &rc,
+                                  unsigned char *column_base,
+                                  unsigned height_scale, int contrast,
+                                  const int sx, const int sy, const int sz,
+                                  const unsigned contour_height_scale)
+{
   const unsigned height_slope_factor =
     Clamp((unsigned)pixel_size, 1u,
           /* this upper limit avoids integer overflows in the "mag"
@@ -296,9 +628,14 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
              square will not overflow */
           8192u / (quantisation_effective * quantisation_effective));
 
-  const short *src = height_matrix.GetData();
   const BGRColor *oColorBuf = color_table + 64 * 256;
-#ifdef FAST_RSQRT
+#ifndef FAST_RSQRT
+  const SlopeShading shading(sx, sy, sz, contrast, height_slope_factor);
+
+  /* the shading of the columns which are not near the left/right
+     edge is calculated in chunks */
+  short shade[SlopeShading::CHUNK_SIZE];
+#else
   const short szindex = sz*contrast/128;
   const short sval_min = szindex-63;
   const short sval_max = szindex+63;
@@ -308,28 +645,33 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sz_c = sz*contrast>>7;
 #endif
 
-  BGRColor *dest = image->GetTopRow();
+  BGRColor *dest = image->GetRow(rc.top);
 
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
-    const unsigned row_plus_index = y < (unsigned)border.bottom
-      ? quantisation_effective
-      : height_matrix.GetHeight() - 1 - y;
+  for (unsigned y = rc.top; y < rc.bottom; ++y) {
+    const unsigned row_plus_index =
+      SlopePlusIndex(y, height_matrix.GetHeight(), quantisation_effective);
     const unsigned row_plus_offset = height_matrix.GetWidth() * row_plus_index;
 
-    const unsigned row_minus_index = y >= quantisation_effective
-      ? quantisation_effective : y;
+    const unsigned row_minus_index =
+      SlopeMinusIndex(y, quantisation_effective);
     const unsigned row_minus_offset = height_matrix.GetWidth() * row_minus_index;
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
-    BGRColor *p = dest;
+    const short *src = height_matrix.GetRow(y) + rc.left;
+    BGRColor *p = dest + rc.left;
     dest = image->GetNextRow(dest);
 
-    unsigned contour_row_base = ContourInterval(*src,
-                                                contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base = RowContourStart(rc.left, y,
+                                                contour_height_scale,
+                                                true);
+    unsigned char *contour_this_column_base = column_base + rc.left;
 
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
+#ifndef FAST_RSQRT
+    unsigned shade_start = 0, shade_end = 0;
+#endif
+
+    for (unsigned x = rc.left; x < rc.right; ++x, ++src) {
       int h = *src;
       if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
         if (h < 0)
@@ -350,11 +692,10 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 
         // X direction
 
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetWidth() - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
+        const unsigned column_plus_index =
+          SlopePlusIndex(x, height_matrix.GetWidth(), quantisation_effective);
+        const unsigned column_minus_index =
+          SlopeMinusIndex(x, quantisation_effective);
 
         assert(src - column_minus_index >= height_matrix.GetData());
         assert(src + column_plus_index >= height_matrix.GetData());
@@ -385,31 +726,38 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above - h_below);
-        const int p22 = ClipHeightDelta(h_right - h_left);
-
         const unsigned p20 = column_plus_index + column_minus_index;
 
+#ifndef FAST_RSQRT
+        int sindex;
+        if (column_plus_index == quantisation_effective &&
+            column_minus_index == quantisation_effective) {
+          if (x >= shade_end) {
+            const unsigned n =
+              std::min(std::min(unsigned(SlopeShading::CHUNK_SIZE),
+                                rc.right - x),
+                       height_matrix.GetWidth() - quantisation_effective - x);
+            shading.Calculate(src - row_minus_offset, src + row_plus_offset,
+                              src - quantisation_effective,
+                              src + quantisation_effective,
+                              shade, n, p20, p31);
+            shade_start = x;
+            shade_end = x + n;
+          }
+
+          sindex = shade[x - shade_start];
+        } else
+          sindex = shading.Calculate(h_above, h_below, h_left, h_right,
+                                     p20, p31);
+
+        *p++ = oColorBuf[h + 256 * sindex];
+#else
+        const int p32 = SlopeShading::ClipHeightDelta(h_above - h_below);
+        const int p22 = SlopeShading::ClipHeightDelta(h_right - h_left);
+
         const int dd0 = p22 * int(p31);
         const int dd1 = int(p20) * p32;
         const unsigned dd2 = p20 * p31 * height_slope_factor;
-#ifndef FAST_RSQRT
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-#ifdef FIXED_MATH
-        const unsigned mag = isqrt4(square_mag);
-#else
-        const unsigned mag = (unsigned)sqrt((fixed)square_mag);
-#endif
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[h + 256 * Clamp(sindex, -63, 63)];
-#else
         const int num = (dd2 * sz_c + dd0 * sx_c + dd1 * sy_c);
         const int sval = i_normalise_mag3(num, dd0, dd1, dd2);
         if (gcc_unlikely(sval<=sval_min))
@@ -433,7 +781,8 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 }
 
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const CellRect &rc,
+                                   unsigned height_scale,
                                    int contrast, int brightness,
                                    const Angle sunazimuth,
                                    const unsigned contour_height_scale)
@@ -445,7 +794,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
   const int sz = (int)(255 * fudgeelevation.fastsine());
 
-  GenerateSlopeImage(height_scale, contrast,
+  GenerateSlopeImage(rc, height_scale, contrast,
                      sx, sy, sz, contour_height_scale);
 }
 
@@ -480,12 +829,127 @@ RasterRenderer::ColorTable(const ColorRamp *color_ramp, bool do_water,
   }
 }
 
+bool
+RasterRenderer::IsContourChecked(unsigned x, unsigned y, bool slope) const
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+  const short *src = height_matrix.GetRow(y) + x;
+
+  if (RasterBuffer::IsSpecial(*src))
+    return false;
+
+  if (slope) {
+    /* GenerateSlopeRows() skips the check if a neighbour is
+       special */
+    const unsigned row_plus_offset =
+      width * SlopePlusIndex(y, height, quantisation_effective);
+    const unsigned row_minus_offset =
+      width * SlopeMinusIndex(y, quantisation_effective);
+    const unsigned column_plus_index =
+      SlopePlusIndex(x, width, quantisation_effective);
+    const unsigned column_minus_index =
+      SlopeMinusIndex(x, quantisation_effective);
+
+    if (RasterBuffer::IsSpecial(src[-(int)row_minus_offset]) ||
+        RasterBuffer::IsSpecial(src[row_plus_offset]) ||
+        RasterBuffer::IsSpecial(src[-(int)column_minus_index]) ||
+        RasterBuffer::IsSpecial(src[column_plus_index]))
+      return false;
+  }
+
+  return true;
+}
+
 void
-RasterRenderer::ContourStart(const unsigned contour_height_scale)
+RasterRenderer::ContourStart(unsigned char *column_base, const CellRect &rc,
+                             const unsigned contour_height_scale,
+                             bool slope) const
 {
-  // initialise column to first row
-  const short *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetWidth(); x > 0; --x)
-    *col_base++ = ContourInterval(*src++, contour_height_scale);
+  for (unsigned x = rc.left; x < rc.right; ++x) {
+    /* the row loop leaves each column with the contour interval of
+       the last pixel which went through the contour check; find it
+       above this band, falling back to the first row */
+    unsigned row = rc.top;
+    while (row > 0) {
+      --row;
+
+      if (IsContourChecked(x, row, slope))
+        break;
+    }
+
+    column_base[x] = ContourInterval(height_matrix.GetRow(row)[x],
+                                     contour_height_scale);
+  }
+}
+
+void
+RasterRenderer::ContourEnd(unsigned char *column_base, const CellRect &rc,
+                           const unsigned contour_height_scale,
+                           bool slope) const
+{
+  for (unsigned x = rc.left; x < rc.right; ++x) {
+    column_base[x] = NO_CONTOUR;
+
+    for (unsigned row = rc.bottom; row > rc.top;) {
+      --row;
+
+      if (IsContourChecked(x, row, slope)) {
+        column_base[x] = ContourInterval(height_matrix.GetRow(row)[x],
+                                         contour_height_scale);
+        break;
+      }
+    }
+  }
+}
+
+unsigned
+RasterRenderer::RowContourStart(unsigned x, unsigned y,
+                                const unsigned contour_height_scale,
+                                bool slope) const
+{
+  /* like ContourStart(), but for the row: falling back to the first
+     pixel */
+  while (x > 0) {
+    --x;
+
+    if (IsContourChecked(x, y, slope))
+      break;
+  }
+
+  return ContourInterval(height_matrix.GetRow(y)[x], contour_height_scale);
+}
+
+void
+RasterRenderer::ConvergeContours(bool slope)
+{
+  /* the pixel before the valid rectangle is generated again, with
+     the same neighbours as before; if it is checked, the state is
+     the same on both sides of it */
+  unsigned left = valid_rect.left, top = valid_rect.top;
+
+  if (valid_rect.left > 0) {
+    for (unsigned y = valid_rect.top; y < valid_rect.bottom; ++y) {
+      for (unsigned x = valid_rect.left - 1; x < valid_rect.right; ++x) {
+        if (IsContourChecked(x, y, slope)) {
+          left = std::max(left, x + 1);
+          break;
+        }
+      }
+    }
+  }
+
+  if (valid_rect.top > 0) {
+    for (unsigned x = valid_rect.left; x < valid_rect.right; ++x) {
+      for (unsigned y = valid_rect.top - 1; y < valid_rect.bottom; ++y) {
+        if (IsContourChecked(x, y, slope)) {
+          top = std::max(top, y + 1);
+          break;
+        }
+      }
+    }
+  }
+
+  valid_rect.left = std::min(left, valid_rect.right);
+  valid_rect.top = std::min(top, valid_rect.bottom);
 }
@@ -28,9 +28,14 @@ Copyright_License {
 #include "Screen/RawBitmap.hpp"
 #include "Math/fixed.hpp"
 #include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <functional>
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#else
+#include "Projection/WindowProjection.hpp"
 #endif
 
 #define NUM_COLOR_RAMP_LEVELS 13
@@ -38,10 +43,30 @@ Copyright_License {
 class Angle;
 class Canvas;
 class RasterMap;
+#ifdef ENABLE_OPENGL
 class WindowProjection;
+#endif
+class WorkerPool;
 struct ColorRamp;
 
 class RasterRenderer : private NonCopyable {
+  /**
+   * A rectangle of #HeightMatrix cells (and image pixels).
+   */
+  struct CellRect {
+    unsigned left, top, right, bottom;
+
+    CellRect() = default;
+
+    constexpr CellRect(unsigned _left, unsigned _top,
+                       unsigned _right, unsigned _bottom)
+      :left(_left), top(_top), right(_right), bottom(_bottom) {}
+
+    constexpr bool IsEmpty() const {
+      return left >= right || top >= bottom;
+    }
+  };
+
   /** screen dimensions in coarse pixels */
   unsigned quantisation_pixels;
 
@@ -66,13 +91,38 @@ class RasterRenderer : private NonCopyable {
    * texture has to be redrawn.
    */
   GeoBounds bounds;
+#else
+  /**
+   * The projection the #HeightMatrix was filled with.  ScrollMap()
+   * moves its screen origin by whole cells, so it always describes
+   * the current contents.
+   */
+  WindowProjection scan_projection;
 #endif
 
+  /**
+   * The part of the image which is still valid after ScrollMap(); the
+   * next GenerateImage() call generates only the rest.  Empty if the
+   * whole image needs to be generated.
+   */
+  CellRect valid_rect;
+
   HeightMatrix height_matrix;
   RawBitmap *image;
 
+  /**
+   * The contour interval of each column, which is carried from one
+   * row to the next.  There is one such row for each band the image
+   * may be split into.
+   */
   unsigned char *contour_column_base;
 
+  /**
+   * If not nullptr, the image is split into horizontal bands which
+   * are shaded in parallel on this pool.
+   */
+  WorkerPool *worker_pool;
+
   fixed pixel_size;
 
   BGRColor color_table[256 * 128];
@@ -93,6 +143,16 @@ public:
     return height_matrix.GetHeight();
   }
 
+  /**
+   * Shade the image on the specified #WorkerPool.  The output is the
+   * same as without one.  The pool must remain valid until this
+   * method is called again; nullptr shades on the calling thread
+   * only.
+   */
+  void SetWorkerPool(WorkerPool *_worker_pool) {
+    worker_pool = _worker_pool;
+  }
+
 #ifdef ENABLE_OPENGL
   void Invalidate() {
     bounds.SetInvalid();
@@ -126,6 +186,25 @@ public:
    */
   void ScanMap(const RasterMap &map, const WindowProjection &projection);
 
+#ifndef ENABLE_OPENGL
+  /**
+   * Try to reuse the height matrix and the image of the previous
+   * ScanMap() call for a translated projection: the contents are
+   * moved by whole cells, and only the exposed cells are filled.
+   * The following GenerateImage() call must be passed the same
+   * parameters as the previous one; it generates only the pixels
+   * which are affected.
+   *
+   * The resolution is not recalculated; the residual offset (less
+   * than half a cell) is tolerated like a small change of the
+   * projection.
+   *
+   * @return false if the projection is not a translation or the
+   * offset is too large; ScanMap() must be called instead
+   */
+  bool ScrollMap(const RasterMap &map, const WindowProjection &projection);
+#endif
+
   /**
    * Convert the height matrix into the image.
    */
@@ -140,29 +219,119 @@ public:
 
 protected:
   /**
-   * Convert the height matrix into the image, without shading.
+   * Convert a rectangle of the height matrix into the image, without
+   * shading.
    */
-  void GenerateUnshadedImage(unsigned height_scale,
+  void GenerateUnshadedImage(const CellRect &rc, unsigned height_scale,
                              const unsigned contour_height_scale);
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Convert a rectangle of the height matrix into the image, with
+   * slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale, int contrast,
+  void GenerateSlopeImage(const CellRect &rc,
+                          unsigned height_scale, int contrast,
                           const int sx, const int sy, const int sz,
                           const unsigned contour_height_scale);
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Convert a rectangle of the height matrix into the image, with
+   * slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale,
+  void GenerateSlopeImage(const CellRect &rc, unsigned height_scale,
                           int contrast, int brightness,
                           const Angle sunazimuth,
                           const unsigned contour_height_scale);
 
 private:
+  typedef std::function<void(unsigned y_start, unsigned y_end,
+                             unsigned char *column_base)> BandFunction;
+
+  /**
+   * Determine how many horizontal bands a rectangle with the
+   * specified number of rows is split into.
+   */
+  gcc_pure
+  unsigned GetBandCount(unsigned height) const;
+
+  /**
+   * Invoke the function for each band of the rectangle (on the
+   * #WorkerPool if there is one), passing the range of rows and the
+   * band's own contour column buffer, which has been initialised
+   * for the band's first row.
+   */
+  void ForEachBand(const CellRect &rc,
+                   const unsigned contour_height_scale, bool slope,
+                   const BandFunction &f);
+
+  void GenerateUnshadedRows(const CellRect &rc,
+                            unsigned char *column_base,
+                            unsigned height_scale,
+                            const unsigned contour_height_scale);
+
+  void GenerateSlopeRows(const CellRect &rc,
+                         unsigned char *column_base,
+                         unsigned height_scale, int contrast,
+                         const int sx, const int sy, const int sz,
+                         const unsigned contour_height_scale);
+
+  /**
+   * Does the row loop pass the specified pixel through the contour
+   * check?
+   *
+   * @param slope true if the image is rendered by
+   * GenerateSlopeRows(), which skips the check next to "special"
+   * heights
+   */
+  gcc_pure
+  bool IsContourChecked(unsigned x, unsigned y, bool slope) const;
+
+  /**
+   * Initialise the contour column buffer for a band beginning at the
+   * specified row, with the values the row-by-row loop would have
+   * left behind after the rows above it.  Only the columns of the
+   * rectangle are initialised.
+   */
+  void ContourStart(unsigned char *column_base, const CellRect &rc,
+                    const unsigned contour_height_scale,
+                    bool slope) const;
+
+  /**
+   * Store the contour interval of the last pixel in each column of
+   * the rectangle which went through the contour check, i.e. the
+   * value the row loop leaves behind in the contour column buffer.
+   * Columns without such a pixel get a value which ContourInterval()
+   * never returns.
+   */
+  void ContourEnd(unsigned char *column_base, const CellRect &rc,
+                  const unsigned contour_height_scale,
+                  bool slope) const;
+
+  /**
+   * Determine the contour interval the row loop carries into the
+   * specified pixel from the pixels left of it.
+   */
+  gcc_pure
+  unsigned RowContourStart(unsigned x, unsigned y,
+                           const unsigned contour_height_scale,
+                           bool slope) const;
+
+  /**
+   * Shrink #valid_rect after ScrollMap(), so the contour state of
+   * each row and column converges before it: the first pixel which
+   * goes through the contour check compares itself with the last
+   * checked pixel left of / above it, which may be in the part that
+   * was scrolled in if all pixels in between were skipped (next to
+   * water or outside of the map).
+   */
+  void ConvergeContours(bool slope);
 
-  void ContourStart(const unsigned contour_height_scale);
+#ifndef ENABLE_OPENGL
+  /**
+   * Move the image contents like HeightMatrix::Scroll().
+   */
+  void ScrollImage(int dx, int dy);
+#endif
 };
 
 #endif
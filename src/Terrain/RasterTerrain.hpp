@@ -44,6 +44,7 @@ public:
   friend class RoutePlannerGlue; // for route planning
   friend class ProtectedTaskManager; // for intersection
   friend class WaypointVisitorMap; // for intersection rendering
+  friend class TerrainLoader; // for loading tiles with a shared lock
 
   /** invalid value for terrain */
   static constexpr short TERRAIN_INVALID = RasterBuffer::TERRAIN_INVALID;
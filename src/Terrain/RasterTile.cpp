@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "Terrain/RasterTile.hpp"
+#include "Terrain/BilinearBatch.hpp"
 
 #include <algorithm>
 
@@ -95,6 +96,19 @@ RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
   return buffer.GetInterpolated(lx, ly, ix, iy);
 }
 
+void
+RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
+                                  unsigned ix, unsigned iy,
+                                  BilinearBatch &batch) const
+{
+  if (IsDisabled() || (lx -= xstart) >= width || (ly -= ystart) >= height) {
+    batch.AppendValue(RasterBuffer::TERRAIN_INVALID);
+    return;
+  }
+
+  buffer.GetInterpolated(lx, ly, ix, iy, batch);
+}
+
 bool
 RasterTile::CheckTileVisibility(int view_x, int view_y, unsigned view_radius)
 {
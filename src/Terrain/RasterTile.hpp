@@ -131,6 +131,14 @@ public:
   short GetInterpolatedHeight(unsigned x, unsigned y,
                               unsigned ix, unsigned iy) const;
 
+  /**
+   * Like GetInterpolatedHeight(), but queue the calculation in a
+   * #BilinearBatch.
+   */
+  void GetInterpolatedHeight(unsigned x, unsigned y,
+                             unsigned ix, unsigned iy,
+                             BilinearBatch &batch) const;
+
   inline short* GetImageBuffer() {
     return buffer.GetData();
   }
@@ -143,6 +151,16 @@ public:
                     bx - (xstart << 8), by - (ystart << 8),
                     dest, size, interpolate);
   }
+
+  /**
+   * @see RasterBuffer::ScanSteps(); the positions are map pixels in
+   * 32.32 fixed point
+   */
+  void ScanSteps(int64_t x, int64_t y, int64_t dx, int64_t dy,
+                 short *dest, unsigned size, bool interpolate) const {
+    buffer.ScanSteps(x - (int64_t(xstart) << 32), y - (int64_t(ystart) << 32),
+                     dx, dy, 32, dest, size, interpolate);
+  }
 };
 
 #endif
@@ -23,11 +23,14 @@ Copyright_License {
 
 #include "Terrain/RasterTileCache.hpp"
 #include "Terrain/RasterLocation.hpp"
+#include "Terrain/BilinearBatch.hpp"
 #include "jasper/jas_image.h"
 #include "Math/Angle.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "Math/FastMath.h"
+#include "OS/FileUtil.hpp"
+#include "Thread/FastMutex.hpp"
 
 #include <string.h>
 #include <algorithm>
@@ -35,16 +38,28 @@ Copyright_License {
 short*
 RasterTileCache::GetImageBuffer(unsigned index)
 {
-  if (TileRequest(index))
-    return tiles.GetLinear(index).GetImageBuffer();
-
-  return NULL;
+  if (!TileRequest(index) || loaded_tiles.full())
+    return NULL;
+
+  /* decode into a private buffer; PublishTiles() will move it into
+     the tile */
+  const RasterTile &tile = tiles.GetLinear(index);
+  LoadedTile &loaded = loaded_tiles.append();
+  loaded.index = index;
+  loaded.decoded = true;
+  loaded.buffer.Resize(tile.width, tile.height);
+  return loaded.buffer.GetData();
 }
 
 void
 RasterTileCache::SetTile(unsigned index,
                          int xstart, int ystart, int xend, int yend)
 {
+  if (!scan_overview)
+    /* the tile metadata is known already; don't modify it while
+       readers may be accessing it */
+    return;
+
   if (!segments.empty() && !segments.last().IsTileSegment())
     /* link current marker segment with this tile */
     segments.last().tile = index;
@@ -77,14 +92,6 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
      the screen will be loaded in advance */
   radius += 256;
 
-  enum {
-    /**
-     * Maximum number of tiles loaded at a time, to reduce system load
-     * peaks.
-    */
-    MAX_ACTIVATE = MAX_ACTIVE_TILES > 32 ? 16 : MAX_ACTIVE_TILES / 2,
-  };
-
   /* query all tiles; all tiles which are either in range or already
      loaded are added to RequestTiles */
 
@@ -131,15 +138,110 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
 }
 
 bool
-RasterTileCache::TileRequest(unsigned index)
+RasterTileCache::PollPrefetchTiles(int x, int y, unsigned radius)
 {
-  RasterTile &tile = tiles.GetLinear(index);
-
-  if (!tile.IsRequested())
+  if (scan_overview)
     return false;
 
-  tile.Enable();
-  return true; // want to load this one!
+  /* see PollTiles() */
+  radius += 256;
+
+  unsigned num_active = 0;
+  request_tiles.clear();
+  for (int i = tiles.GetSize() - 1; i >= 0; --i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    tile.ClearRequest();
+
+    if (tile.IsEnabled())
+      ++num_active;
+    else if (tile.CheckTileVisibility(x, y, radius) &&
+             !request_tiles.full())
+      request_tiles.append(i);
+  }
+
+  /* stay within the budget, so the next PollTiles() call does not
+     need to dispose tiles which are in view */
+
+  const unsigned budget = num_active < MAX_ACTIVE_TILES
+    ? std::min(MAX_ACTIVE_TILES - num_active, unsigned(MAX_ACTIVATE))
+    : 0;
+  if (request_tiles.size() > budget) {
+    const RTDistanceSort sort(*this);
+    std::sort(request_tiles.begin(), request_tiles.end(), sort);
+    request_tiles.shrink(budget);
+  }
+
+  for (auto it = request_tiles.begin(), end = request_tiles.end();
+       it != end; ++it)
+    tiles.GetLinear(*it).SetRequest();
+
+  return !request_tiles.empty();
+}
+
+bool
+RasterTileCache::LoadDecodedTiles()
+{
+  if (!decoded_tiles.IsOpen())
+    return true;
+
+  bool decode = false;
+  for (auto it = request_tiles.begin(), end = request_tiles.end();
+       it != end; ++it) {
+    RasterTile &tile = tiles.GetLinear(*it);
+    if (!tile.IsRequested())
+      continue;
+
+    if (!decoded_tiles.Contains(*it) || loaded_tiles.full()) {
+      decode = true;
+      continue;
+    }
+
+    LoadedTile &loaded = loaded_tiles.append();
+    loaded.index = *it;
+    loaded.decoded = false;
+    loaded.buffer.Resize(tile.width, tile.height);
+    decoded_tiles.Load(*it, loaded.buffer.GetData(),
+                       tile.width * tile.height);
+
+    /* the request flag is cleared by PublishTiles(); until then,
+       IsCached() keeps libjasper from decoding it again */
+  }
+
+  return decode;
+}
+
+void
+RasterTileCache::StoreDecodedTiles()
+{
+  if (!decoded_tiles.IsOpen())
+    return;
+
+  for (auto it = loaded_tiles.begin(), end = loaded_tiles.end();
+       it != end; ++it) {
+    const RasterTile &tile = tiles.GetLinear(it->index);
+    if (it->decoded)
+      decoded_tiles.Store(it->index, it->buffer.GetData(),
+                          tile.width * tile.height);
+  }
+}
+
+bool
+RasterTileCache::IsCached(unsigned index) const
+{
+  for (auto it = loaded_tiles.begin(), end = loaded_tiles.end();
+       it != end; ++it)
+    if (it->index == index && !it->decoded)
+      return true;
+
+  return false;
+}
+
+bool
+RasterTileCache::TileRequest(unsigned index) const
+{
+  const RasterTile &tile = tiles.GetLinear(index);
+
+  return tile.IsRequested() && tile.IsDefined() && !IsCached(index);
 }
 
 short
@@ -178,11 +280,93 @@ RasterTileCache::GetInterpolatedHeight(unsigned int lx, unsigned int ly) const
                                    ly >> OVERVIEW_BITS);
 }
 
+void
+RasterTileCache::GetHeights(const RasterLocation *locations, short *heights,
+                            unsigned n) const
+{
+  /* the most recently used tile and its origin */
+  const RasterTile *tile = NULL;
+  unsigned tile_x = 0, tile_y = 0;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned px = locations[i].x, py = locations[i].y;
+    if (px >= width || py >= height) {
+      // outside overall bounds
+      heights[i] = RasterBuffer::TERRAIN_INVALID;
+      continue;
+    }
+
+    if (tile == NULL || px - tile_x >= tile_width ||
+        py - tile_y >= tile_height) {
+      const unsigned column = px / tile_width, row = py / tile_height;
+      tile = &tiles.Get(column, row);
+      tile_x = column * tile_width;
+      tile_y = row * tile_height;
+    }
+
+    heights[i] = tile->IsEnabled()
+      ? tile->GetHeight(px, py)
+      // not loaded, so go to overview
+      : overview.GetInterpolated(px << (SUBPIXEL_BITS - OVERVIEW_BITS),
+                                 py << (SUBPIXEL_BITS - OVERVIEW_BITS));
+  }
+}
+
+void
+RasterTileCache::GetInterpolatedHeights(const RasterLocation *locations,
+                                        short *heights, unsigned n) const
+{
+  BilinearBatch batch;
+
+  /* the most recently used tile and its origin */
+  const RasterTile *tile = NULL;
+  unsigned tile_x = 0, tile_y = 0;
+
+  for (unsigned i = 0; i < n;) {
+    const unsigned start = i;
+
+    for (; i < n && !batch.IsFull(); ++i) {
+      const unsigned lx = locations[i].x, ly = locations[i].y;
+      if (lx >= overview_width_fine || ly >= overview_height_fine) {
+        // outside overall bounds
+        batch.AppendValue(RasterBuffer::TERRAIN_INVALID);
+        continue;
+      }
+
+      unsigned px = lx, py = ly;
+      const unsigned int ix = CombinedDivAndMod(px);
+      const unsigned int iy = CombinedDivAndMod(py);
+
+      if (tile == NULL || px - tile_x >= tile_width ||
+          py - tile_y >= tile_height) {
+        const unsigned column = px / tile_width, row = py / tile_height;
+        tile = &tiles.Get(column, row);
+        tile_x = column * tile_width;
+        tile_y = row * tile_height;
+      }
+
+      if (tile->IsEnabled())
+        tile->GetInterpolatedHeight(px, py, ix, iy, batch);
+      else
+        // not loaded, so go to overview
+        overview.GetInterpolated(lx >> OVERVIEW_BITS, ly >> OVERVIEW_BITS,
+                                 batch);
+    }
+
+    batch.Flush(heights + start);
+  }
+}
+
 void
 RasterTileCache::SetSize(unsigned _width, unsigned _height,
                          unsigned _tile_width, unsigned _tile_height,
                          unsigned tile_columns, unsigned tile_rows)
 {
+  if (!scan_overview)
+    /* libjasper reports the size again while loading tiles; it is
+       known already */
+    return;
+
   width = _width;
   height = _height;
   tile_width = _tile_width;
@@ -199,6 +383,12 @@ void
 RasterTileCache::SetLatLonBounds(double _lon_min, double _lon_max,
                                  double _lat_min, double _lat_max)
 {
+  if (!scan_overview)
+    /* the GeoJP2 box is parsed again while loading tiles; the bounds
+       are known already, don't modify them while readers may be
+       accessing them */
+    return;
+
   const Angle lon_min(Angle::Degrees(_lon_min));
   const Angle lon_max(Angle::Degrees(_lon_max));
   const Angle lat_min(Angle::Degrees(_lat_min));
@@ -225,6 +415,11 @@ RasterTileCache::Reset()
 
   for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
     it->Disable();
+
+  loaded_tiles.clear();
+  load_failed = false;
+
+  decoded_tiles.Close();
 }
 
 gcc_pure
@@ -258,7 +453,8 @@ RasterTileCache::SkipMarkerSegment(long file_offset) const
 
   long skip_to = segment->file_offset;
   while (segment->IsTileSegment() &&
-         !tiles.GetLinear(segment->tile).IsRequested()) {
+         (!tiles.GetLinear(segment->tile).IsRequested() ||
+          IsCached(segment->tile))) {
     ++segment;
     if (segment >= segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -324,17 +520,25 @@ RasterTileCache::MarkerSegment(long file_offset, unsigned id)
 
 extern RasterTileCache *raster_tile_current;
 
-void
+/**
+ * Serialises all libjasper calls, because libjasper and
+ * #raster_tile_current are not thread-safe.
+ */
+static FastMutex jasper_mutex;
+
+bool
 RasterTileCache::LoadJPG2000(const char *jp2_filename)
 {
   jas_stream_t *in;
 
+  jasper_mutex.Lock();
+
   raster_tile_current = this;
 
   in = jas_stream_fopen(jp2_filename, "rb");
   if (!in) {
-    Reset();
-    return;
+    jasper_mutex.Unlock();
+    return false;
   }
 
   if (operation != NULL)
@@ -342,6 +546,10 @@ RasterTileCache::LoadJPG2000(const char *jp2_filename)
 
   jp2_decode(in, scan_overview ? "xcsoar=2" : "xcsoar=1");
   jas_stream_close(in);
+
+  raster_tile_current = NULL;
+  jasper_mutex.Unlock();
+  return true;
 }
 
 bool
@@ -413,12 +621,14 @@ RasterTileCache::LoadOverview(const char *path, const TCHAR *world_file,
 
   Reset();
 
-  LoadJPG2000(path);
-  scan_overview = false;
+  if (!LoadJPG2000(path))
+    Reset();
 
   if (initialised && world_file != NULL)
     LoadWorldFile(world_file);
 
+  scan_overview = false;
+
   if (initialised && !bounds_initialised)
     initialised = false;
 
@@ -435,9 +645,41 @@ RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
   if (!PollTiles(x, y, radius))
     return;
 
-  remaining_segments = 0;
+  LoadTiles(path);
+  PublishTiles();
+}
+
+void
+RasterTileCache::LoadTiles(const char *path)
+{
+  assert(loaded_tiles.empty());
+
+  if (LoadDecodedTiles()) {
+    remaining_segments = 0;
+
+    load_failed = !LoadJPG2000(path);
+
+    StoreDecodedTiles();
+  }
+}
+
+void
+RasterTileCache::PublishTiles()
+{
+  if (load_failed) {
+    /* the file has vanished */
+    Reset();
+    return;
+  }
+
+  for (auto it = loaded_tiles.begin(), end = loaded_tiles.end();
+       it != end; ++it) {
+    RasterTile &tile = tiles.GetLinear(it->index);
+    tile.buffer.Swap(it->buffer);
+    tile.ClearRequest();
+  }
 
-  LoadJPG2000(path);
+  loaded_tiles.clear();
 
   /* permanently disable the requested tiles which are still not
      loaded, to prevent trying to reload them over and over in a busy
@@ -452,6 +694,49 @@ RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
   ++serial;
 }
 
+/**
+ * The 32 bit FNV-1a hash.
+ */
+gcc_pure
+static uint32_t
+UpdateFNV1a(const void *data, size_t length, uint32_t hash)
+{
+  const uint8_t *p = (const uint8_t *)data, *end = p + length;
+  while (p < end)
+    hash = (hash ^ *p++) * 16777619u;
+  return hash;
+}
+
+bool
+RasterTileCache::OpenDecodedTiles(const TCHAR *path, const TCHAR *source_path)
+{
+  if (!initialised)
+    return false;
+
+  assert(bounds_initialised);
+
+  DecodedTileCache::Source source;
+  source.size = File::GetSize(source_path);
+  source.mtime = File::GetLastModification(source_path);
+  if (source.size == 0)
+    /* not a regular file, the cache could not be validated */
+    return false;
+
+  /* the marker segment offsets change with any modification of the
+     JPEG2000 code stream; together with the dimensions, they
+     identify the terrain inside the source file */
+  uint32_t hash = UpdateFNV1a(segments.begin(),
+                              segments.size() * sizeof(*segments.begin()),
+                              2166136261u);
+  hash = UpdateFNV1a(&bounds, sizeof(bounds), hash);
+
+  const uint32_t dimensions[] = { width, height, tile_width, tile_height };
+  source.hash = UpdateFNV1a(dimensions, sizeof(dimensions), hash);
+
+  return decoded_tiles.Open(path, source, tiles.GetSize(),
+                            tile_width * tile_height);
+}
+
 bool
 RasterTileCache::SaveCache(FILE *file) const
 {
@@ -25,6 +25,7 @@ Copyright_License {
 #define XCSOAR_RASTERTILE_CACHE_HPP
 
 #include "RasterTile.hpp"
+#include "DecodedTileCache.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hpp"
@@ -62,6 +63,13 @@ class RasterTileCache : private NonCopyable {
   static constexpr unsigned MAX_ACTIVE_TILES = 16;
 #endif
 
+  /**
+   * Maximum number of tiles loaded at a time, to reduce system load
+   * peaks.
+   */
+  static constexpr unsigned MAX_ACTIVATE =
+    MAX_ACTIVE_TILES > 32 ? 16 : MAX_ACTIVE_TILES / 2;
+
   /**
    * The width and height of the terrain bitmap is shifted by this
    * number of bits to determine the overview size.
@@ -114,6 +122,22 @@ protected:
     }
   };
 
+  /**
+   * A tile which was decoded by LoadTiles(), but has not yet been
+   * published by PublishTiles().
+   */
+  struct LoadedTile {
+    unsigned index;
+
+    /**
+     * Was this tile decoded by libjasper?  If not, it was loaded from
+     * #decoded_tiles.
+     */
+    bool decoded;
+
+    RasterBuffer buffer;
+  };
+
   struct CacheHeader {
     enum {
 #ifdef FIXED_MATH
@@ -168,11 +192,28 @@ protected:
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  /**
+   * The tiles decoded by LoadTiles().  Their buffers are kept
+   * private until PublishTiles() moves them into #tiles, so readers
+   * holding a shared lock never see a partially decoded tile.
+   */
+  StaticArray<LoadedTile, MAX_ACTIVATE> loaded_tiles;
+
+  /**
+   * Set by LoadTiles() if the file could not be opened.
+   */
+  bool load_failed;
+
   /**
    * Progress callbacks for loading the file during startup.
    */
   OperationEnvironment *operation;
 
+  /**
+   * Optional on-disk cache of decoded tiles, see OpenDecodedTiles().
+   */
+  DecodedTileCache decoded_tiles;
+
 public:
   RasterTileCache():operation(NULL) {
     Reset();
@@ -204,6 +245,24 @@ public:
   short GetInterpolatedHeight(unsigned int lx,
                               unsigned int ly) const;
 
+  /**
+   * Batch version of GetHeight().  Consecutive locations in the same
+   * tile share one tile lookup.
+   *
+   * @param locations the pixel locations; may be out of range
+   */
+  void GetHeights(const RasterLocation *locations, short *heights,
+                  unsigned n) const;
+
+  /**
+   * Batch version of GetInterpolatedHeight(); the interpolation is
+   * done with SIMD instructions (see #BilinearBatch).
+   *
+   * @param locations the sub-pixel locations; may be out of range
+   */
+  void GetInterpolatedHeights(const RasterLocation *locations,
+                              short *heights, unsigned n) const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -214,6 +273,18 @@ public:
   void ScanLine(const RasterLocation start, const RasterLocation end,
                 short *buffer, unsigned size, bool interpolate) const;
 
+  /**
+   * Fill the buffer with the samples at the positions "(x, y) + i *
+   * (dx, dy)" for i=0..size-1; see RasterBuffer::ScanSteps().
+   * Positions outside of the map are filled with
+   * RasterBuffer::TERRAIN_INVALID.
+   *
+   * @param x the pixel column of the first sample in 32.32 fixed point
+   * @param y the pixel row of the first sample in 32.32 fixed point
+   */
+  void ScanSteps(int64_t x, int64_t y, int64_t dx, int64_t dy,
+                 short *buffer, unsigned size, bool interpolate) const;
+
   bool FirstIntersection(int origin_x, int origin_y,
                          int destination_x, int destination_y,
                          int h_origin,
@@ -229,7 +300,13 @@ public:
                int h_origin, const int slope_fact) const;
 
 protected:
-  void LoadJPG2000(const char *path);
+  /**
+   * Run libjasper on the file.  Only one file is decoded at a time
+   * in the whole process, because libjasper is not thread-safe.
+   *
+   * @return false if the file could not be opened
+   */
+  bool LoadJPG2000(const char *path);
 
   /**
    * Load a world file (*.tfw or *.j2w).
@@ -255,8 +332,62 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+  /**
+   * Enable the on-disk cache of decoded tiles.  After a tile has been
+   * decoded once, it will be loaded from this file instead of being
+   * decoded again.  This must be called after the overview has been
+   * loaded.
+   *
+   * @param path the path of the cache file; it is created if it does
+   * not exist, and discarded if it belongs to another terrain file
+   * @param source_path the regular file which contains the terrain
+   * (e.g. the map archive); its size and modification time are part
+   * of the cache key
+   * @return true if the cache is available
+   */
+  bool OpenDecodedTiles(const TCHAR *path, const TCHAR *source_path);
+
+  /**
+   * Load the tiles around the specified pixel location, and dispose
+   * tiles which are out of range.  This is a shortcut for
+   * PollTiles(), LoadTiles() and PublishTiles() for callers which
+   * hold an exclusive lock all the time.
+   */
   void UpdateTiles(const char *path, int x, int y, unsigned radius);
 
+  /**
+   * Determine which tiles are needed around the specified pixel
+   * location, dispose tiles which are out of range and request the
+   * missing ones.  This is the first of the three loading phases;
+   * the caller must hold an exclusive lock.
+   *
+   * @return true if tiles were requested and LoadTiles() shall be
+   * called
+   */
+  bool PollTiles(int x, int y, unsigned radius);
+
+  /**
+   * Like PollTiles(), but for a location which the view is expected
+   * to reach soon.  It requests only tiles which fit into the budget
+   * of #MAX_ACTIVE_TILES, and never disposes a tile.  It does not
+   * affect IsDirty().
+   */
+  bool PollPrefetchTiles(int x, int y, unsigned radius);
+
+  /**
+   * Decode the tiles requested by PollTiles() or PollPrefetchTiles()
+   * into private buffers.  This does not modify data seen by readers,
+   * therefore the caller needs only a shared lock, but only one
+   * thread may run the loading phases at a time.
+   */
+  void LoadTiles(const char *path);
+
+  /**
+   * Make the tiles decoded by LoadTiles() available to readers.  The
+   * caller must hold an exclusive lock.
+   */
+  void PublishTiles();
+
   /**
    * Determines if there are still tiles scheduled to be loaded.  Call
    * this after UpdateTiles() to determine if UpdateTiles() should be
@@ -293,7 +424,7 @@ public:
   long SkipMarkerSegment(long file_offset) const;
   void MarkerSegment(long file_offset, unsigned id);
 
-  bool TileRequest(unsigned index);
+  bool TileRequest(unsigned index) const;
 
   short *GetOverview() {
     return overview.GetData();
@@ -312,7 +443,26 @@ public:
   }
 
 protected:
-  bool PollTiles(int x, int y, unsigned radius);
+  /**
+   * Load the requested tiles from #decoded_tiles.
+   *
+   * @return true if there are requested tiles left which need to be
+   * decoded
+   */
+  bool LoadDecodedTiles();
+
+  /**
+   * Store the tiles which were just decoded in #decoded_tiles.
+   */
+  void StoreDecodedTiles();
+
+  /**
+   * Was this tile loaded from #decoded_tiles by the current
+   * LoadTiles() call?  Its request flag remains set until
+   * PublishTiles(), but libjasper must not decode it again.
+   */
+  gcc_pure
+  bool IsCached(unsigned index) const;
 
 public:
   short GetMaxElevation() const {
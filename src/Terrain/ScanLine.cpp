@@ -24,6 +24,8 @@ Copyright_License {
 #include "Terrain/RasterTileCache.hpp"
 #include "Terrain/RasterLocation.hpp"
 
+#include <algorithm>
+
 #include <stdlib.h>
 
 struct GridLocation : public RasterLocation {
@@ -336,3 +338,114 @@ RasterTileCache::ScanLine(const RasterLocation _start,
     current = next;
   }
 }
+
+/**
+ * Count the positions "position + i * step" (starting with i=0)
+ * which are within [min, max), up to the specified limit.  The first
+ * position must be within.
+ */
+gcc_const
+static unsigned
+CountInside(int64_t position, int64_t step, int64_t min, int64_t max,
+            unsigned limit)
+{
+  assert(position >= min && position < max);
+
+  int64_t n;
+  if (step > 0)
+    n = (max - 1 - position) / step + 1;
+  else if (step < 0)
+    n = (position - min) / -step + 1;
+  else
+    return limit;
+
+  return n < limit ? unsigned(n) : limit;
+}
+
+/**
+ * Count the positions "position + i * step" (starting with i=0)
+ * before the first one which is within [min, max), up to the
+ * specified limit.
+ */
+gcc_const
+static unsigned
+CountOutside(int64_t position, int64_t step, int64_t min, int64_t max,
+             unsigned limit)
+{
+  int64_t n;
+  if (position < min) {
+    if (step <= 0)
+      return limit;
+
+    n = (min - position + step - 1) / step;
+  } else if (position >= max) {
+    if (step >= 0)
+      return limit;
+
+    n = (position - max + 1 - step - 1) / -step;
+  } else
+    return 0;
+
+  return n < limit ? unsigned(n) : limit;
+}
+
+void
+RasterTileCache::ScanSteps(int64_t x, int64_t y, int64_t dx, int64_t dy,
+                           short *buffer, unsigned size,
+                           bool interpolate) const
+{
+  const short invalid = RasterBuffer::TERRAIN_INVALID;
+
+  const int64_t map_width = int64_t(width) << 32;
+  const int64_t map_height = int64_t(height) << 32;
+
+  /* the overview pixel positions have more fractional bits */
+  static constexpr unsigned overview_bits = 32 + OVERVIEW_BITS;
+  const int64_t overview_width = int64_t(overview.GetWidth()) << overview_bits;
+  const int64_t overview_height =
+    int64_t(overview.GetHeight()) << overview_bits;
+
+  while (size > 0) {
+    unsigned n = std::max(CountOutside(x, dx, 0, map_width, size),
+                          CountOutside(y, dy, 0, map_height, size));
+    if (n > 0) {
+      std::fill_n(buffer, n, invalid);
+    } else {
+      /* scan the part of the line which is within the current tile */
+      const unsigned tile_x = unsigned(x >> 32) / tile_width;
+      const unsigned tile_y = unsigned(y >> 32) / tile_height;
+      const int64_t left = int64_t(tile_x * tile_width) << 32;
+      const int64_t top = int64_t(tile_y * tile_height) << 32;
+      const int64_t right =
+        std::min(left + (int64_t(tile_width) << 32), map_width);
+      const int64_t bottom =
+        std::min(top + (int64_t(tile_height) << 32), map_height);
+
+      n = std::min(CountInside(x, dx, left, right, size),
+                   CountInside(y, dy, top, bottom, size));
+
+      const RasterTile &tile = tiles.Get(tile_x, tile_y);
+      if (tile.IsEnabled())
+        tile.ScanSteps(x, y, dx, dy, buffer, n, interpolate);
+      else if (x < overview_width && y < overview_height) {
+        n = std::min(CountInside(x, dx, 0, overview_width, n),
+                     CountInside(y, dy, 0, overview_height, n));
+        overview.ScanSteps(x, y, dx, dy, overview_bits,
+                           buffer, n, interpolate);
+      } else {
+        /* the overview size may be rounded down; use its last
+           pixel, like ScanLineChecked() */
+        n = 1;
+        *buffer = overview.Get(std::min(unsigned(x >> overview_bits),
+                                        overview.GetWidth() - 1),
+                               std::min(unsigned(y >> overview_bits),
+                                        overview.GetHeight() - 1));
+      }
+    }
+
+    x += n * dx;
+    y += n * dy;
+    buffer += n;
+    size -= n;
+  }
+}
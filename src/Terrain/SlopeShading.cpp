@@ -0,0 +1,308 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "SlopeShading.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+/*
+ * The vectorised implementations exploit the value ranges guaranteed
+ * by the SlopeShading preconditions: the clipped height deltas are
+ * within +/-512 and p20/p31 are less than 64, so the gradient
+ * components "dd0" and "dd1" and the light vector products fit in
+ * 16 bit, and the sum of their squares fits in 31 bit.  The shading
+ * value "sval" is within +/-2*|s|, where |s| is the magnitude of the
+ * light vector.
+ */
+
+#ifdef __SSE2__
+
+/**
+ * Calculate "num / (floor(sqrt(square_mag + square_mag_offset)) | 1)"
+ * in the lower two lanes.  All operands and intermediate results are
+ * exact in double precision, therefore the result is the same as with
+ * integer arithmetics.  The upper two lanes of the result are zero.
+ */
+gcc_always_inline
+static inline __m128i
+Normalise2(__m128i num, __m128i square_mag, __m128d square_mag_offset)
+{
+  const __m128d m = _mm_add_pd(_mm_cvtepi32_pd(square_mag),
+                               square_mag_offset);
+  const __m128i mag = _mm_or_si128(_mm_cvttpd_epi32(_mm_sqrt_pd(m)),
+                                   _mm_set1_epi32(1));
+  return _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(num),
+                                     _mm_cvtepi32_pd(mag)));
+}
+
+gcc_always_inline
+static inline __m128i
+Normalise4(__m128i num, __m128i square_mag, __m128d square_mag_offset)
+{
+  const __m128i lo = Normalise2(num, square_mag, square_mag_offset);
+  const __m128i hi = Normalise2(_mm_unpackhi_epi64(num, num),
+                                _mm_unpackhi_epi64(square_mag, square_mag),
+                                square_mag_offset);
+  return _mm_unpacklo_epi64(lo, hi);
+}
+
+/**
+ * Divide by 128, rounding towards zero like the C division operator.
+ */
+gcc_always_inline
+static inline __m128i
+Divide128(__m128i t)
+{
+  /* add 127 to negative values */
+  const __m128i bias = _mm_srli_epi32(_mm_srai_epi32(t, 31), 25);
+  return _mm_srai_epi32(_mm_add_epi32(t, bias), 7);
+}
+
+/**
+ * Calculate the shading of eight pixels at a time.
+ *
+ * @return the number of pixels which were calculated
+ */
+static unsigned
+CalculateSIMD(const short *gcc_restrict above,
+              const short *gcc_restrict below,
+              const short *gcc_restrict left,
+              const short *gcc_restrict right,
+              short *gcc_restrict dest, unsigned n,
+              int p20, int p31, int dd2,
+              int sx, int sy, int sz, int contrast)
+{
+  const __m128i clip_min = _mm_set1_epi16(-512);
+  const __m128i clip_max = _mm_set1_epi16(512);
+  const __m128i v_p20 = _mm_set1_epi16(p20);
+  const __m128i v_p31 = _mm_set1_epi16(p31);
+
+  /* each (p22, p32) pair is multiplied with (p31*sx, p20*sy) */
+  const short k0 = p31 * sx, k1 = p20 * sy;
+  const __m128i k = _mm_set_epi16(k1, k0, k1, k0, k1, k0, k1, k0);
+  const __m128i num_offset = _mm_set1_epi32(dd2 * sz);
+  const __m128d square_mag_offset = _mm_set1_pd(double(dd2) * dd2);
+
+  const __m128i v_sz = _mm_set1_epi16(sz);
+  const __m128i v_contrast = _mm_set1_epi16(contrast);
+  const __m128i index_min = _mm_set1_epi16(-63);
+  const __m128i index_max = _mm_set1_epi16(63);
+
+  unsigned i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)(above + i));
+    const __m128i b = _mm_loadu_si128((const __m128i *)(below + i));
+    const __m128i l = _mm_loadu_si128((const __m128i *)(left + i));
+    const __m128i r = _mm_loadu_si128((const __m128i *)(right + i));
+
+    /* the saturated difference is still out of the clip range if the
+       real one is */
+    const __m128i p32 =
+      _mm_max_epi16(_mm_min_epi16(_mm_subs_epi16(a, b), clip_max), clip_min);
+    const __m128i p22 =
+      _mm_max_epi16(_mm_min_epi16(_mm_subs_epi16(r, l), clip_max), clip_min);
+
+    const __m128i dd0 = _mm_mullo_epi16(p22, v_p31);
+    const __m128i dd1 = _mm_mullo_epi16(p32, v_p20);
+
+    const __m128i num_lo =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(p22, p32), k),
+                    num_offset);
+    const __m128i num_hi =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(p22, p32), k),
+                    num_offset);
+
+    const __m128i dd_lo = _mm_unpacklo_epi16(dd0, dd1);
+    const __m128i dd_hi = _mm_unpackhi_epi16(dd0, dd1);
+
+    const __m128i sval =
+      _mm_packs_epi32(Normalise4(num_lo, _mm_madd_epi16(dd_lo, dd_lo),
+                                 square_mag_offset),
+                      Normalise4(num_hi, _mm_madd_epi16(dd_hi, dd_hi),
+                                 square_mag_offset));
+
+    /* (sval - sz) * contrast needs 32 bit */
+    const __m128i delta = _mm_sub_epi16(sval, v_sz);
+    const __m128i product_lo = _mm_mullo_epi16(delta, v_contrast);
+    const __m128i product_hi = _mm_mulhi_epi16(delta, v_contrast);
+
+    const __m128i sindex =
+      _mm_packs_epi32(Divide128(_mm_unpacklo_epi16(product_lo, product_hi)),
+                      Divide128(_mm_unpackhi_epi16(product_lo, product_hi)));
+
+    _mm_storeu_si128((__m128i *)(dest + i),
+                     _mm_max_epi16(_mm_min_epi16(sindex, index_max),
+                                   index_min));
+  }
+
+  return i;
+}
+
+#elif defined(__ARM_NEON__)
+
+/**
+ * Calculate floor(sqrt(x)).  The floating point estimate may be off
+ * by one, which is corrected with integer arithmetics.
+ */
+gcc_always_inline
+static inline uint32x4_t
+SquareRoot4(uint32x4_t x)
+{
+  const float32x4_t f = vcvtq_f32_u32(x);
+  float32x4_t r = vrsqrteq_f32(f);
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(f, r), r));
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(f, r), r));
+
+  const uint32x4_t max = vdupq_n_u32(0xffff);
+  uint32x4_t m = vminq_u32(vcvtq_u32_f32(vmulq_f32(f, r)), max);
+
+  /* the comparison masks are all ones, i.e. -1 */
+  m = vaddq_u32(m, vcgtq_u32(vmulq_u32(m, m), x));
+  const uint32x4_t m1 = vaddq_u32(m, vdupq_n_u32(1));
+  return vsubq_u32(m, vandq_u32(vcleq_u32(vmulq_u32(m1, m1), x),
+                                vcltq_u32(m, max)));
+}
+
+/**
+ * Divide with the C semantics (rounding towards zero).  The floating
+ * point estimate may be off by one, which is corrected with integer
+ * arithmetics.
+ */
+gcc_always_inline
+static inline int32x4_t
+Divide4(int32x4_t num, uint32x4_t d)
+{
+  const uint32x4_t a = vreinterpretq_u32_s32(vabsq_s32(num));
+
+  const float32x4_t df = vcvtq_f32_u32(d);
+  float32x4_t r = vrecpeq_f32(df);
+  r = vmulq_f32(r, vrecpsq_f32(df, r));
+  r = vmulq_f32(r, vrecpsq_f32(df, r));
+
+  uint32x4_t q = vcvtq_u32_f32(vmulq_f32(vcvtq_f32_u32(a), r));
+  q = vaddq_u32(q, vcgtq_u32(vmulq_u32(q, d), a));
+  q = vsubq_u32(q, vcleq_u32(vmulq_u32(vaddq_u32(q, vdupq_n_u32(1)), d),
+                             a));
+
+  const int32x4_t sign = vshrq_n_s32(num, 31);
+  return vsubq_s32(veorq_s32(vreinterpretq_s32_u32(q), sign), sign);
+}
+
+/**
+ * Calculate the shading of four pixels at a time.
+ *
+ * @return the number of pixels which were calculated
+ */
+static unsigned
+CalculateSIMD(const short *gcc_restrict above,
+              const short *gcc_restrict below,
+              const short *gcc_restrict left,
+              const short *gcc_restrict right,
+              short *gcc_restrict dest, unsigned n,
+              int p20, int p31, int dd2,
+              int sx, int sy, int sz, int contrast)
+{
+  const int16x4_t clip_min = vdup_n_s16(-512);
+  const int16x4_t clip_max = vdup_n_s16(512);
+  const int16x4_t v_p20 = vdup_n_s16(p20);
+  const int16x4_t v_p31 = vdup_n_s16(p31);
+  const int16x4_t k0 = vdup_n_s16(p31 * sx);
+  const int16x4_t k1 = vdup_n_s16(p20 * sy);
+  const int32x4_t num_offset = vdupq_n_s32(dd2 * sz);
+  const uint32x4_t square_mag_offset = vdupq_n_u32(unsigned(dd2) * dd2);
+  const int32x4_t v_sz = vdupq_n_s32(sz);
+  const int32x4_t v_contrast = vdupq_n_s32(contrast);
+
+  unsigned i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const int16x4_t a = vld1_s16(above + i);
+    const int16x4_t b = vld1_s16(below + i);
+    const int16x4_t l = vld1_s16(left + i);
+    const int16x4_t r = vld1_s16(right + i);
+
+    /* the saturated difference is still out of the clip range if the
+       real one is */
+    const int16x4_t p32 =
+      vmax_s16(vmin_s16(vqsub_s16(a, b), clip_max), clip_min);
+    const int16x4_t p22 =
+      vmax_s16(vmin_s16(vqsub_s16(r, l), clip_max), clip_min);
+
+    const int16x4_t dd0 = vmul_s16(p22, v_p31);
+    const int16x4_t dd1 = vmul_s16(p32, v_p20);
+
+    const int32x4_t num = vmlal_s16(vmlal_s16(num_offset, p22, k0),
+                                    p32, k1);
+    const uint32x4_t square_mag =
+      vaddq_u32(vreinterpretq_u32_s32(vmlal_s16(vmull_s16(dd0, dd0),
+                                                dd1, dd1)),
+                square_mag_offset);
+
+    const uint32x4_t mag = vorrq_u32(SquareRoot4(square_mag),
+                                     vdupq_n_u32(1));
+    const int32x4_t sval = Divide4(num, mag);
+
+    int32x4_t t = vmulq_s32(vsubq_s32(sval, v_sz), v_contrast);
+    /* divide by 128, rounding towards zero: add 127 to negative
+       values */
+    const uint32x4_t negative = vreinterpretq_u32_s32(vshrq_n_s32(t, 31));
+    t = vaddq_s32(t, vreinterpretq_s32_u32(vshrq_n_u32(negative, 25)));
+    t = vshrq_n_s32(t, 7);
+
+    vst1_s16(dest + i,
+             vmovn_s32(vmaxq_s32(vminq_s32(t, vdupq_n_s32(63)),
+                                 vdupq_n_s32(-63))));
+  }
+
+  return i;
+}
+
+#endif
+
+void
+SlopeShading::Calculate(const short *gcc_restrict above,
+                        const short *gcc_restrict below,
+                        const short *gcc_restrict left,
+                        const short *gcc_restrict right,
+                        short *gcc_restrict dest, unsigned n,
+                        unsigned p20, unsigned p31) const
+{
+  assert(p20 < 64);
+  assert(p31 < 64);
+
+  unsigned i = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+  const int dd2 = p20 * p31 * height_slope_factor;
+  i = CalculateSIMD(above, below, left, right, dest, n,
+                    p20, p31, dd2, sx, sy, sz, contrast);
+#endif
+
+  for (; i < n; ++i)
+    dest[i] = Calculate(above[i], below[i], left[i], right[i], p20, p31);
+}
@@ -0,0 +1,135 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+#define XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+
+#include "Math/fixed.hpp"
+#include "Math/FastMath.h"
+#include "Util/Clamp.hpp"
+#include "Compiler.h"
+
+#include <assert.h>
+
+/**
+ * Calculates the hill shading of terrain pixels: the brightness
+ * offset (-63..63) resulting from the angle between the surface
+ * normal and the light source.
+ *
+ * The surface normal is derived from the four neighbours of a pixel;
+ * p20 is the horizontal distance between the left and the right
+ * neighbour, p31 the vertical distance between the upper and the
+ * lower neighbour.  Both must be less than 64.
+ */
+class SlopeShading {
+  int sx, sy, sz;
+  int contrast;
+  unsigned height_slope_factor;
+
+public:
+  /**
+   * The recommended number of pixels to be passed to the batch
+   * version of Calculate().  It is small enough for a buffer on the
+   * stack, and large enough to amortise the setup.
+   */
+  static constexpr unsigned CHUNK_SIZE = 64;
+
+  /**
+   * @param sx, sy, sz the light vector, with a magnitude of up to
+   * 255
+   * @param contrast the contrast (0..255)
+   * @param height_slope_factor the scale of the vertical component
+   * of the surface normal; it must be small enough to keep the
+   * squared magnitude of the normal within 32 bits
+   */
+  SlopeShading(int _sx, int _sy, int _sz, int _contrast,
+               unsigned _height_slope_factor)
+    :sx(_sx), sy(_sy), sz(_sz), contrast(_contrast),
+     height_slope_factor(_height_slope_factor) {
+    assert(sx >= -255 && sx <= 255);
+    assert(sy >= -255 && sy <= 255);
+    assert(sz >= -255 && sz <= 255);
+    assert(contrast >= 0 && contrast <= 255);
+  }
+
+  /**
+   * Calculate the shading of one pixel.
+   */
+  gcc_pure
+  int Calculate(int h_above, int h_below, int h_left, int h_right,
+                unsigned p20, unsigned p31) const {
+    assert(p20 < 64);
+    assert(p31 < 64);
+
+    const int p32 = ClipHeightDelta(h_above - h_below);
+    const int p22 = ClipHeightDelta(h_right - h_left);
+
+    const int dd0 = p22 * int(p31);
+    const int dd1 = int(p20) * p32;
+    const unsigned dd2 = p20 * p31 * height_slope_factor;
+    const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
+    const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
+#ifdef FIXED_MATH
+    const unsigned mag = isqrt4(square_mag);
+#else
+    const unsigned mag = (unsigned)sqrt((fixed)square_mag);
+#endif
+    /* this is a workaround for a SIGFPE (division by zero)
+       observed by our users on some Android devices (e.g. Nexus
+       7), even though we did our best to make sure that the
+       integer arithmetics above can't overflow */
+    /* TODO: debug this problem and replace this workaround */
+    const int sval = num / int(mag|1);
+    const int sindex = (sval - sz) * contrast / 128;
+    return Clamp(sindex, -63, 63);
+  }
+
+  /**
+   * Calculate the shading of #n adjacent pixels which all have the
+   * same neighbour distances.  The result is the same as
+   * Calculate(); SSE2 or NEON is used if available.
+   *
+   * The source pointers point to the first pixel's neighbours.
+   * Special terrain values are not checked, the caller must ignore
+   * their results.
+   */
+  void Calculate(const short *gcc_restrict above,
+                 const short *gcc_restrict below,
+                 const short *gcc_restrict left,
+                 const short *gcc_restrict right,
+                 short *gcc_restrict dest, unsigned n,
+                 unsigned p20, unsigned p31) const;
+
+  /**
+   * Clip the difference between two adjacent terrain height values
+   * to sane bounds.  This works around integer overflows in the
+   * formula when the map file is broken, avoiding the sqrt() call
+   * with a negative argument.
+   */
+  gcc_const
+  static int ClipHeightDelta(int d) {
+    return Clamp(d, -512, 512);
+  }
+};
+
+#endif
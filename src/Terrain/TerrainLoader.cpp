@@ -0,0 +1,179 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/TerrainLoader.hpp"
+#include "Terrain/RasterTerrain.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+
+TerrainLoader::TerrainLoader(RasterTerrain &_terrain,
+                             std::function<void()> _loaded)
+  :terrain(_terrain), loaded(std::move(_loaded)),
+   view_center(GeoPoint::Invalid()), view_radius(fixed(0)),
+   view_pending(false), dirty(false),
+   prefetch_radius(fixed(0)), prefetch_position(0) {}
+
+void
+TerrainLoader::SetView(const GeoPoint &center, fixed radius)
+{
+  ScopeLock protect(mutex);
+
+  view_center = center;
+  view_radius = radius;
+  view_pending = true;
+
+  /* if the thread is busy, it will pick up the new view before it
+     returns from Tick() */
+  if (!IsBusy())
+    Trigger();
+}
+
+void
+TerrainLoader::SetPrefetch(const PrefetchList &locations, fixed radius)
+{
+  ScopeLock protect(mutex);
+
+  prefetch = locations;
+  prefetch_radius = radius;
+  prefetch_position = 0;
+
+  if (!prefetch.empty() && !IsBusy())
+    Trigger();
+}
+
+bool
+TerrainLoader::IsDirty()
+{
+  ScopeLock protect(mutex);
+  return dirty || view_pending;
+}
+
+void
+TerrainLoader::StopAsync()
+{
+  ScopeLock protect(mutex);
+  StandbyThread::StopAsync();
+}
+
+void
+TerrainLoader::WaitStopped()
+{
+  ScopeLock protect(mutex);
+  StandbyThread::WaitStopped();
+}
+
+void
+TerrainLoader::AppendLine(PrefetchList &list,
+                          const GeoPoint &a, const GeoPoint &b, fixed step)
+{
+  assert(positive(step));
+
+  const unsigned n = std::max(uround(a.Distance(b) / step), 1u);
+  for (unsigned i = 1; i <= n && !list.full(); ++i)
+    list.append(a.Interpolate(b, fixed(i) / n));
+}
+
+void
+TerrainLoader::LoadAndPublish()
+{
+  RasterMap &map = terrain.map;
+
+  {
+    /* decoding modifies only private buffers, readers may continue
+       to use the tiles which are already loaded */
+    RasterTerrain::Lease lease(terrain);
+    map.LoadTiles();
+  }
+
+  RasterTerrain::ExclusiveLease lease(terrain);
+  map.PublishTiles();
+}
+
+bool
+TerrainLoader::LoadView(const GeoPoint &location, fixed radius)
+{
+  {
+    RasterTerrain::ExclusiveLease lease(terrain);
+    if (!terrain.map.PollTiles(location, radius))
+      return terrain.map.IsDirty();
+  }
+
+  LoadAndPublish();
+
+  if (loaded)
+    loaded();
+
+  RasterTerrain::Lease lease(terrain);
+  return lease->IsDirty();
+}
+
+bool
+TerrainLoader::LoadPrefetch(const GeoPoint &location, fixed radius)
+{
+  {
+    RasterTerrain::ExclusiveLease lease(terrain);
+    if (!terrain.map.PollPrefetchTiles(location, radius))
+      return false;
+  }
+
+  LoadAndPublish();
+  return true;
+}
+
+void
+TerrainLoader::Tick()
+{
+  while (!IsStopped()) {
+    if (view_pending) {
+      const GeoPoint location = view_center;
+      const fixed radius = view_radius;
+      view_pending = false;
+      dirty = true;
+
+      mutex.Unlock();
+      const bool more = LoadView(location, radius);
+      mutex.Lock();
+
+      dirty = more;
+      if (more)
+        /* continue with the next batch */
+        view_pending = true;
+    } else if (!dirty && prefetch_position < prefetch.size()) {
+      const GeoPoint location = prefetch[prefetch_position];
+      const fixed radius = prefetch_radius;
+
+      mutex.Unlock();
+      const bool more = LoadPrefetch(location, radius);
+      mutex.Lock();
+
+      /* stay at this location until it is complete, unless
+         SetPrefetch() has replaced the list meanwhile */
+      if (!more && prefetch_position < prefetch.size() &&
+          prefetch[prefetch_position] == location)
+        ++prefetch_position;
+    } else
+      break;
+  }
+}
@@ -0,0 +1,138 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_LOADER_HPP
+#define XCSOAR_TERRAIN_LOADER_HPP
+
+#include "Thread/StandbyThread.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Util/StaticArray.hpp"
+#include "Math/fixed.hpp"
+
+#include <functional>
+
+class RasterTerrain;
+
+/**
+ * Loads terrain tiles in a background thread.  The tiles are decoded
+ * while holding only a shared lock on the #RasterTerrain; the
+ * exclusive lock is held only for a short time to select the tiles
+ * and to publish them, therefore rendering and calculations are not
+ * blocked by libjasper.
+ *
+ * After all tiles of the view have been loaded, tiles around the
+ * locations passed to SetPrefetch() are loaded in advance.
+ *
+ * The "loaded" callback is invoked (in the loader thread) after new
+ * tiles of the view have been published, so the caller can redraw.
+ */
+class TerrainLoader final : private StandbyThread {
+public:
+  typedef StaticArray<GeoPoint, 32> PrefetchList;
+
+private:
+  RasterTerrain &terrain;
+
+  const std::function<void()> loaded;
+
+  GeoPoint view_center;
+  fixed view_radius;
+
+  /**
+   * Shall the tiles around #view_center be loaded?
+   */
+  bool view_pending;
+
+  /**
+   * Are there still tiles missing around #view_center?  Prefetching
+   * is postponed until this is cleared.
+   */
+  bool dirty;
+
+  PrefetchList prefetch;
+  fixed prefetch_radius;
+
+  /**
+   * The index of the next #prefetch location to be loaded.
+   */
+  unsigned prefetch_position;
+
+public:
+  TerrainLoader(RasterTerrain &_terrain, std::function<void()> _loaded);
+
+  /**
+   * Load the tiles around the specified location.  This method
+   * returns immediately.
+   */
+  void SetView(const GeoPoint &center, fixed radius);
+
+  /**
+   * Load the tiles around the specified locations when the thread is
+   * idle, replacing the previous list.  The locations should be
+   * ordered by priority.
+   */
+  void SetPrefetch(const PrefetchList &locations, fixed radius);
+
+  /**
+   * Are there still tiles missing in the current view?
+   */
+  bool IsDirty();
+
+  void StopAsync();
+  void WaitStopped();
+
+  /**
+   * Append locations along the straight line from #a (exclusive) to
+   * #b (inclusive), spaced at most #step apart, until the list is
+   * full.
+   */
+  static void AppendLine(PrefetchList &list,
+                         const GeoPoint &a, const GeoPoint &b, fixed step);
+
+private:
+  /**
+   * Load one batch of tiles for the view.
+   *
+   * @return true if there are still tiles missing
+   */
+  bool LoadView(const GeoPoint &location, fixed radius);
+
+  /**
+   * Load one batch of tiles around a prefetch location.
+   *
+   * @return true if tiles were loaded, and more may be needed
+   */
+  bool LoadPrefetch(const GeoPoint &location, fixed radius);
+
+  /**
+   * Decode the tiles selected by RasterMap::PollTiles() or
+   * RasterMap::PollPrefetchTiles() and publish them.
+   */
+  void LoadAndPublish();
+
+protected:
+  /* virtual methods from class StandbyThread */
+  virtual void Tick() override;
+};
+
+#endif
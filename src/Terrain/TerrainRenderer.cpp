@@ -313,10 +313,12 @@ static_assert(ARRAY_SIZE(terrain_colors) == TerrainRendererSettings::NUM_RAMPS,
 TerrainRenderer::TerrainRenderer(const RasterTerrain *_terrain)
   :terrain(_terrain),
    last_sun_azimuth(Angle::Zero()),
-   last_color_ramp(NULL)
+   last_color_ramp(NULL),
+   worker_pool(WorkerPool::GetDefaultThreadCount())
 {
   assert(terrain != NULL);
   settings.SetDefaults();
+  raster_renderer.SetWorkerPool(&worker_pool);
 }
 
 void
@@ -362,19 +364,24 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     return;
 
 #else
-  if (compare_projection.Compare(map_projection) &&
-      terrain_serial == terrain->GetSerial() &&
-      sunazimuth.CompareRoughly(last_sun_azimuth))
+  const bool unchanged = terrain_serial == terrain->GetSerial() &&
+    sunazimuth.CompareRoughly(last_sun_azimuth);
+
+  if (unchanged && compare_projection.Compare(map_projection))
     /* no change since previous frame */
     return;
 
+  /* if only the projection has changed, try to scroll the existing
+     image */
+  const bool scroll = unchanged && compare_projection.IsDefined() &&
+    settings == last_settings;
+
   compare_projection = CompareProjection(map_projection);
+  last_settings = settings;
 #endif
 
   terrain_serial = terrain->GetSerial();
 
-  last_sun_azimuth = sunazimuth;
-
   const bool do_water = true;
   const unsigned height_scale = 4;
   const int interp_levels = 2;
@@ -391,14 +398,25 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     last_color_ramp = color_ramp;
   }
 
+  bool scrolled = false;
+
   {
     RasterTerrain::Lease map(*terrain);
-    raster_renderer.ScanMap(map, map_projection);
+#ifndef ENABLE_OPENGL
+    scrolled = scroll && raster_renderer.ScrollMap(map, map_projection);
+    if (!scrolled)
+#endif
+      raster_renderer.ScanMap(map, map_projection);
   }
 
+  /* the exposed parts of a scrolled image are shaded like the rest of
+     it */
+  if (!scrolled)
+    last_sun_azimuth = sunazimuth;
+
   raster_renderer.GenerateImage(do_shading, height_scale,
                                 settings.contrast, settings.brightness,
-                                sunazimuth,
+                                last_sun_azimuth,
 				do_contour);
 }
 
@@ -28,6 +28,7 @@ Copyright_License {
 #include "Util/NonCopyable.hpp"
 #include "Util/Serial.hpp"
 #include "Terrain/TerrainSettings.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #ifndef ENABLE_OPENGL
 #include "Projection/CompareProjection.hpp"
@@ -48,12 +49,23 @@ protected:
 
 #ifndef ENABLE_OPENGL
   CompareProjection compare_projection;
+
+  /**
+   * The settings the current image was generated with.  The image
+   * may only be scrolled if they have not changed.
+   */
+  TerrainRendererSettings last_settings;
 #endif
 
   Angle last_sun_azimuth;
 
   const ColorRamp *last_color_ramp;
 
+  /**
+   * Shades the terrain image in horizontal bands.
+   */
+  WorkerPool worker_pool;
+
   RasterRenderer raster_renderer;
 
 public:
@@ -201,6 +201,12 @@ WeatherTerrainRenderer::Generate(const WindowProjection &projection,
     last_color_ramp = color_ramp;
   }
 
+#ifndef ENABLE_OPENGL
+  /* TerrainRenderer::Generate() must not reuse or scroll this
+     image */
+  compare_projection.Clear();
+#endif
+
   raster_renderer.ScanMap(*map, projection);
 
   raster_renderer.GenerateImage(do_shading, height_scale,
@@ -0,0 +1,158 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/WorkerPool.hpp"
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#endif
+
+#include <assert.h>
+
+WorkerPool::WorkerPool(unsigned _n_threads)
+  :n_threads(0),
+   function(nullptr), n_items(0), next_item(0), pending_items(0),
+   stop(false)
+{
+#ifdef HAVE_POSIX
+  if (_n_threads > MAX_THREADS)
+    _n_threads = MAX_THREADS;
+
+  for (unsigned i = 0; i < _n_threads; ++i) {
+    Worker *worker = new Worker(*this);
+    if (!worker->Start()) {
+      delete worker;
+      break;
+    }
+
+    threads[n_threads++] = worker;
+  }
+#endif
+}
+
+WorkerPool::~WorkerPool()
+{
+  assert(function == nullptr);
+
+  mutex.Lock();
+  stop = true;
+#ifdef HAVE_POSIX
+  work_cond.Broadcast();
+#endif
+  mutex.Unlock();
+
+  for (unsigned i = 0; i < n_threads; ++i) {
+    threads[i]->Join();
+    delete threads[i];
+  }
+}
+
+unsigned
+WorkerPool::GetDefaultThreadCount()
+{
+#if defined(HAVE_POSIX) && defined(_SC_NPROCESSORS_ONLN)
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n <= 1)
+    return 0;
+
+  return n - 1 < (long)MAX_THREADS
+    ? (unsigned)(n - 1)
+    : MAX_THREADS;
+#else
+  return 0;
+#endif
+}
+
+void
+WorkerPool::Run(unsigned n, const Function &f)
+{
+  if (n_threads == 0 || n <= 1) {
+    for (unsigned i = 0; i < n; ++i)
+      f(i);
+    return;
+  }
+
+#ifdef HAVE_POSIX
+  mutex.Lock();
+  assert(function == nullptr);
+
+  function = &f;
+  n_items = n;
+  next_item = 0;
+  pending_items = n;
+  work_cond.Broadcast();
+
+  /* help the workers while there are unclaimed items */
+  while (RunItem()) {}
+
+  /* wait for the items that are still being processed by the
+     workers */
+  while (pending_items > 0)
+    done_cond.Wait(mutex);
+
+  function = nullptr;
+  mutex.Unlock();
+#endif
+}
+
+bool
+WorkerPool::RunItem()
+{
+  assert(mutex.IsLockedByCurrent());
+
+  if (function == nullptr || next_item >= n_items)
+    return false;
+
+  const Function &f = *function;
+  const unsigned i = next_item++;
+
+  mutex.Unlock();
+  f(i);
+  mutex.Lock();
+
+  assert(pending_items > 0);
+#ifdef HAVE_POSIX
+  if (--pending_items == 0)
+    done_cond.Broadcast();
+#else
+  --pending_items;
+#endif
+
+  return true;
+}
+
+void
+WorkerPool::WorkerRun()
+{
+  mutex.Lock();
+
+  while (!stop) {
+    if (!RunItem()) {
+#ifdef HAVE_POSIX
+      work_cond.Wait(mutex);
+#endif
+    }
+  }
+
+  mutex.Unlock();
+}
@@ -0,0 +1,158 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_WORKER_POOL_HPP
+#define XCSOAR_THREAD_WORKER_POOL_HPP
+
+#include "Compiler.h"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#ifdef HAVE_POSIX
+#include "Thread/Cond.hpp"
+#endif
+
+#include <functional>
+
+/**
+ * A fixed set of threads which processes batches of independent work
+ * items in parallel.  Run() returns after the whole batch has been
+ * processed.  The calling thread takes part in the work, therefore a
+ * pool without threads degenerates into a plain loop.
+ *
+ * Only one thread may call Run() at a time.
+ */
+class WorkerPool {
+public:
+  /**
+   * Called with the index of the work item to be processed.
+   */
+  typedef std::function<void(unsigned)> Function;
+
+  static constexpr unsigned MAX_THREADS = 8;
+
+private:
+  class Worker : public Thread {
+    WorkerPool &pool;
+
+  public:
+    explicit Worker(WorkerPool &_pool):pool(_pool) {}
+
+  protected:
+    /* virtual methods from class Thread */
+    virtual void Run() {
+      pool.WorkerRun();
+    }
+  };
+
+  Worker *threads[MAX_THREADS];
+  unsigned n_threads;
+
+  /**
+   * Protects all attributes below.
+   */
+  Mutex mutex;
+
+#ifdef HAVE_POSIX
+  /**
+   * Signalled when a new batch is available or the pool is being
+   * stopped.
+   */
+  Cond work_cond;
+
+  /**
+   * Signalled when the last item of a batch has been processed.
+   */
+  Cond done_cond;
+#endif
+
+  /**
+   * The function of the current batch, or nullptr if there is no
+   * batch.
+   */
+  const Function *function;
+
+  /**
+   * The number of items in the current batch.
+   */
+  unsigned n_items;
+
+  /**
+   * The index of the next item which has not been claimed yet.
+   */
+  unsigned next_item;
+
+  /**
+   * The number of items which have not been finished yet.
+   */
+  unsigned pending_items;
+
+  bool stop;
+
+public:
+  /**
+   * Starts the specified number of threads (clipped to
+   * #MAX_THREADS).  Zero is allowed and makes Run() sequential.
+   */
+  explicit WorkerPool(unsigned n_threads);
+
+  /**
+   * Stops and joins all threads.
+   */
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &other) = delete;
+  WorkerPool &operator=(const WorkerPool &other) = delete;
+
+  unsigned GetThreadCount() const {
+    return n_threads;
+  }
+
+  /**
+   * Invoke the function for each index in the range [0, n).  The
+   * calls are distributed among the pool's threads and the calling
+   * thread; there is no guarantee about the order.  Returns after all
+   * calls have returned.
+   */
+  void Run(unsigned n, const Function &f);
+
+  /**
+   * Returns a reasonable pool size for this machine: the number of
+   * online processors minus one (the calling thread), clipped to
+   * #MAX_THREADS.
+   */
+  gcc_pure
+  static unsigned GetDefaultThreadCount();
+
+private:
+  /**
+   * Claim and process one item of the current batch.  The mutex must
+   * be locked; it is released while the item is being processed.
+   *
+   * @return false if there was no unclaimed item
+   */
+  bool RunItem();
+
+  void WorkerRun();
+};
+
+#endif
@@ -38,13 +38,14 @@ TopographyFile::TopographyFile(struct zzip_dir *_dir, const char *filename,
                                int _label_field,
                                ResourceId _icon, ResourceId _big_icon,
                                unsigned _pen_width)
-  :dir(_dir), first(NULL),
+  :dir(_dir), first(NULL), next_first(NULL),
    label_field(_label_field), icon(_icon), big_icon(_big_icon),
    pen_width(_pen_width),
    color(_color), scale_threshold(_threshold),
    label_threshold(_label_threshold),
    important_label_threshold(_important_label_threshold),
-   cache_bounds(GeoBounds::Invalid())
+   cache_bounds(GeoBounds::Invalid()),
+   next_bounds(GeoBounds::Invalid())
 {
   if (msShapefileOpen(&file, "rb", dir, filename, 0) == -1)
     return;
@@ -56,6 +57,8 @@ TopographyFile::TopographyFile(struct zzip_dir *_dir, const char *filename,
 
   shapes.ResizeDiscard(file.numshapes);
   std::fill(shapes.begin(), shapes.end(), ShapeList(NULL));
+  next_shapes.ResizeDiscard(file.numshapes);
+  std::fill(next_shapes.begin(), next_shapes.end(), ShapeList(NULL));
 
   if (dir != NULL)
     ++dir->refcount;
@@ -80,12 +83,18 @@ TopographyFile::~TopographyFile()
 void
 TopographyFile::ClearCache()
 {
-  for (auto i = shapes.begin(), end = shapes.end(); i != end; ++i) {
+  auto n = next_shapes.begin();
+  for (auto i = shapes.begin(), end = shapes.end(); i != end; ++i, ++n) {
+    if (n->shape != i->shape)
+      /* not published yet */
+      delete n->shape;
+    n->shape = NULL;
+
     delete i->shape;
     i->shape = NULL;
   }
 
-  first = NULL;
+  first = next_first = NULL;
 }
 
 gcc_pure
@@ -100,60 +109,99 @@ ConvertRect(const GeoBounds &br)
   return dest;
 }
 
-bool
-TopographyFile::Update(const WindowProjection &map_projection)
+GeoBounds
+TopographyFile::GetUpdateBounds(const WindowProjection &map_projection) const
 {
   if (IsEmpty())
-    return false;
+    return GeoBounds::Invalid();
 
   if (map_projection.GetMapScale() > scale_threshold)
     /* not visible, don't update cache now */
-    return false;
+    return GeoBounds::Invalid();
 
   const GeoBounds screenRect =
     map_projection.GetScreenBounds();
   if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect))
     /* the cache is still fresh */
-    return false;
+    return GeoBounds::Invalid();
 
-  cache_bounds = map_projection.GetScreenBounds().Scale(fixed(2));
+  return screenRect.Scale(fixed(2));
+}
 
-  rectObj deg_bounds = ConvertRect(cache_bounds);
+void
+TopographyFile::LoadShapes(const GeoBounds &bounds)
+{
+  assert(!IsEmpty());
+  assert(bounds.IsValid());
+
+  next_bounds = bounds;
+
+  rectObj deg_bounds = ConvertRect(bounds);
 
   // Test which shapes are inside the given bounds and save the
   // status to file.status
   msShapefileWhichShapes(&file, dir, deg_bounds, 0);
 
-  // If not a single shape is inside the bounds
-  if (!file.status) {
-    // ... clear the whole buffer
-    ClearCache();
-    return false;
-  }
-
   // Iterate through the shapefile entries
-  const ShapeList **current = &first;
-  auto it = shapes.begin();
-  for (int i = 0; i < file.numshapes; ++i, ++it) {
-    if (!msGetBit(file.status, i)) {
-      // If the shape is outside the bounds
-      // delete the shape from the cache
-      delete it->shape;
-      it->shape = NULL;
-    } else {
-      // is inside the bounds
-      if (it->shape == NULL)
-        // shape isn't cached yet -> cache the shape
-        it->shape = new XShape(&file, i, label_field);
-      // update list pointer
-      *current = it;
-      current = &it->next;
-    }
+  const ShapeList **current = &next_first;
+  auto it = next_shapes.begin();
+  auto old = shapes.begin();
+  for (int i = 0; i < file.numshapes; ++i, ++it, ++old) {
+    assert(it->shape == NULL);
+
+    if (file.status == NULL || !msGetBit(file.status, i))
+      // the shape is outside the bounds
+      continue;
+
+    // is inside the bounds; use the cached shape if there is one
+    it->shape = old->shape != NULL
+      ? old->shape
+      : new XShape(&file, i, label_field);
+
+    // update list pointer
+    *current = it;
+    current = &it->next;
   }
   // end of list marker
   *current = NULL;
+}
+
+void
+TopographyFile::PublishShapes()
+{
+  assert(next_bounds.IsValid());
+
+  // delete the shapes which are outside the new bounds
+  auto it = next_shapes.begin();
+  for (auto old = shapes.begin(), end = shapes.end();
+       old != end; ++old, ++it)
+    if (old->shape != it->shape)
+      delete old->shape;
+
+  /* the move operator of AllocatedArray swaps the buffers; the list
+     pointers remain valid */
+  shapes = std::move(next_shapes);
+  first = next_first;
+  cache_bounds = next_bounds;
+
+  // the old list is empty now, ready for the next LoadShapes() call
+  for (auto &i : next_shapes)
+    i.shape = NULL;
+  next_first = NULL;
+  next_bounds = GeoBounds::Invalid();
 
   ++serial;
+}
+
+bool
+TopographyFile::Update(const WindowProjection &map_projection)
+{
+  const GeoBounds bounds = GetUpdateBounds(map_projection);
+  if (!bounds.IsValid())
+    return false;
+
+  LoadShapes(bounds);
+  PublishShapes();
   return true;
 }
 
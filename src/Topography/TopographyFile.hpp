@@ -62,6 +62,14 @@ class TopographyFile : private NonCopyable {
   AllocatedArray<ShapeList> shapes;
   const ShapeList *first;
 
+  /**
+   * The shape list being built by LoadShapes(), to be swapped with
+   * #shapes by PublishShapes().  Shapes which are in both lists are
+   * shared.
+   */
+  AllocatedArray<ShapeList> next_shapes;
+  const ShapeList *next_first;
+
   int label_field;
 
   ResourceId icon, big_icon;
@@ -95,6 +103,11 @@ class TopographyFile : private NonCopyable {
    */
   GeoBounds cache_bounds;
 
+  /**
+   * The scope of #next_shapes.
+   */
+  GeoBounds next_bounds;
+
 public:
   class const_iterator {
     friend class TopographyFile;
@@ -224,6 +237,36 @@ public:
 #endif
 
   /**
+   * Check whether the shape cache covers the given projection.
+   *
+   * @return the bounds which shall be passed to LoadShapes(), or
+   * GeoBounds::Invalid() if the cache is still fresh or the file is
+   * not visible at this scale
+   */
+  gcc_pure
+  GeoBounds GetUpdateBounds(const WindowProjection &map_projection) const;
+
+  /**
+   * Build a new shape list for the given bounds, reusing the shapes
+   * which are already cached.  The current list is not modified,
+   * therefore this may run in a background thread while other
+   * threads iterate over this object.  It must be followed by
+   * PublishShapes() before it is called again.
+   */
+  void LoadShapes(const GeoBounds &bounds);
+
+  /**
+   * Replace the current shape list with the one built by
+   * LoadShapes(), free the shapes which are not used anymore and
+   * increment the serial.  The caller must ensure that nobody
+   * iterates over this object and that LoadShapes() is not running.
+   */
+  void PublishShapes();
+
+  /**
+   * Synchronous version of GetUpdateBounds(), LoadShapes() and
+   * PublishShapes().
+   *
    * @return true if new data from the topography file has been loaded
    */
   bool Update(const WindowProjection &map_projection);
@@ -98,22 +98,73 @@ unsigned
 TopographyStore::ScanVisibility(const WindowProjection &m_projection,
                               unsigned max_update)
 {
-  // check if any needs to have cache updates because wasnt
-  // visible previously when bounds moved
-
-  // we will make sure we update at least one cache per call
-  // to make sure eventually everything gets refreshed
-  unsigned num_updated = 0;
-  for (auto it = files.begin(), end = files.end(); it != end; ++it) {
-    if ((*it)->Update(m_projection)) {
+  ScopeLock protect(mutex);
+
+  unsigned num_updated = 0, num_pending = 0;
+  bool queued = false;
+  for (unsigned i = 0; i < files.size(); ++i) {
+    LoadJob &job = jobs[i];
+
+    if (job.state == LoadState::READY && num_updated < max_update) {
+      /* swap in the new shape list; the renderers run in this
+         thread and will notice the new serial */
+      files[i]->PublishShapes();
+      job.state = LoadState::IDLE;
       ++num_updated;
-      if (num_updated >= max_update)
-        break;
+    }
+
+    if (job.state != LoadState::IDLE) {
+      /* the thread is still busy with this file */
+      ++num_pending;
+      continue;
+    }
+
+    // check if any needs to have cache updates because wasnt
+    // visible previously when bounds moved
+    const GeoBounds bounds = files[i]->GetUpdateBounds(m_projection);
+    if (bounds.IsValid()) {
+      job.state = LoadState::QUEUED;
+      job.bounds = bounds;
+      queued = true;
+      ++num_pending;
     }
   }
 
+  /* if the thread is busy, it will pick up the new jobs before it
+     returns from Tick() */
+  if (queued && !IsBusy())
+    Trigger();
+
   serial += num_updated;
-  return num_updated;
+
+  /* report the pending files, too: the caller must keep calling this
+     method to publish them when the thread is finished */
+  return num_updated + num_pending;
+}
+
+void
+TopographyStore::Tick()
+{
+  while (!IsStopped()) {
+    unsigned i = 0;
+    while (i < jobs.size() && jobs[i].state != LoadState::QUEUED)
+      ++i;
+
+    if (i == jobs.size())
+      break;
+
+    LoadJob &job = jobs[i];
+    TopographyFile &file = *files[i];
+    const GeoBounds bounds = job.bounds;
+    job.state = LoadState::LOADING;
+
+    /* the renderers may use the current shape list meanwhile */
+    mutex.Unlock();
+    file.LoadShapes(bounds);
+    mutex.Lock();
+
+    job.state = LoadState::READY;
+  }
 }
 
 void
@@ -280,9 +331,11 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
     if (file->IsEmpty())
       // If the shape file could not be read -> skip this line/file
       delete file;
-    else
+    else {
       // .. otherwise append it to our list of shape files
       files.append(file);
+      jobs.append(LoadJob());
+    }
 
     // Update progress bar
     operation.SetProgressPosition((reader.Tell() * 100) / filesize);
@@ -292,8 +345,15 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
 void
 TopographyStore::Reset()
 {
+  {
+    /* the thread may be using one of the files */
+    ScopeLock protect(mutex);
+    StandbyThread::Stop();
+  }
+
   for (auto it = files.begin(), end = files.end(); it != end; ++it)
     delete *it;
 
   files.clear();
+  jobs.clear();
 }
@@ -26,8 +26,11 @@ Copyright_License {
 
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hpp"
+#include "Thread/StandbyThread.hpp"
+#include "Geo/GeoBounds.hpp"
 
 #include <tchar.h>
+#include <stdint.h>
 
 class WindowProjection;
 class TopographyFile;
@@ -37,8 +40,12 @@ struct zzip_dir;
 
 /**
  * Class used to manage and render vector topography layers
+ *
+ * The shapes of the visible area are loaded in a background thread;
+ * the renderers keep using the previous shape list until
+ * ScanVisibility() swaps in the new one.
  */
-class TopographyStore : private NonCopyable {
+class TopographyStore : private NonCopyable, private StandbyThread {
 public:
   /** maximum number of topography layers */
   static constexpr unsigned MAXTOPOGRAPHY = 30;
@@ -46,6 +53,45 @@ public:
 private:
   StaticArray<TopographyFile *, MAXTOPOGRAPHY> files;
 
+  enum class LoadState : uint8_t {
+    /**
+     * No new shape list has been requested.
+     */
+    IDLE,
+
+    /**
+     * The file is waiting for the thread.
+     */
+    QUEUED,
+
+    /**
+     * The thread is building a new shape list.
+     */
+    LOADING,
+
+    /**
+     * The new shape list is ready for TopographyFile::PublishShapes().
+     */
+    READY,
+  };
+
+  struct LoadJob {
+    LoadState state;
+
+    /**
+     * The bounds to be loaded by the thread.
+     */
+    GeoBounds bounds;
+
+    LoadJob():state(LoadState::IDLE), bounds(GeoBounds::Invalid()) {}
+  };
+
+  /**
+   * The background loader state of each item in #files.  Protected
+   * by StandbyThread::mutex.
+   */
+  StaticArray<LoadJob, MAXTOPOGRAPHY> jobs;
+
   /**
    * This number is incremented each time this object is modified.
    */
@@ -72,9 +118,15 @@ public:
   }
 
   /**
+   * Publish the shape lists which have been loaded in background, and
+   * request new ones for the files whose cache does not cover the
+   * given projection anymore.  Must be called in the thread which
+   * renders the topography.
+   *
    * @param max_update the maximum number of files updated in this
    * call
-   * @return the number of files which were updated
+   * @return the number of files which were updated or are still
+   * being loaded; 0 means that all shape lists are up to date
    */
   unsigned ScanVisibility(const WindowProjection &m_projection,
                           unsigned max_update=1024);
@@ -88,6 +140,10 @@ public:
   void Load(OperationEnvironment &operation, NLineReader &reader,
             const TCHAR *directory, struct zzip_dir *zdir = NULL);
   void Reset();
+
+protected:
+  /* virtual methods from class StandbyThread */
+  virtual void Tick() override;
 };
 
 #endif
@@ -32,6 +32,8 @@
 
 #include "AllocatedArray.hpp"
 
+#include <utility>
+
 #include <assert.h>
 
 /**
@@ -135,6 +137,16 @@ public:
     height = _height;
   }
 
+  /**
+   * Exchange the contents of two grids without copying the values.
+   */
+  void Swap(AllocatedGrid &other) {
+    /* the move operator of AllocatedArray swaps the buffers */
+    array = std::move(other.array);
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+  }
+
   /**
    * Resize the grid, preserving as many old values as fit into the
    * new dimensions, and fill newly allocated array slots.
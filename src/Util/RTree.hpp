@@ -0,0 +1,817 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_RTREE_HPP
+#define XCSOAR_RTREE_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+/**
+ * An R-tree implementation.  It stores objects with a rectangular
+ * extent (bounding boxes) and provides quick searches for objects
+ * overlapping a rectangle and for the nearest object.
+ *
+ * A large number of objects should be loaded at once with Load(),
+ * which builds a densely packed tree with the "Sort-Tile-Recursive"
+ * algorithm.  Objects may be added and removed individually at any
+ * time; this keeps the tree valid, but less optimal than a bulk load.
+ *
+ * The Accessor class must provide the methods GetMinX(), GetMinY(),
+ * GetMaxX() and GetMaxY() which return the bounds of an object.
+ *
+ * @see http://en.wikipedia.org/wiki/R-tree
+ */
+template<typename T, typename Accessor, unsigned MAX_ENTRIES = 16>
+class RTree : private NonCopyable {
+  static_assert(MAX_ENTRIES >= 4, "MAX_ENTRIES too small");
+
+  /**
+   * A node which has less entries than this is dissolved by
+   * Remove(), and its objects are inserted again.
+   */
+  static constexpr unsigned MIN_ENTRIES = MAX_ENTRIES / 4;
+
+public:
+  typedef int position_type;
+
+  /**
+   * The type of squared distances.  It is 64 bit wide, because the
+   * square of a 32 bit coordinate difference does not fit into 32
+   * bits.
+   */
+  typedef uint64_t distance_type;
+
+  /**
+   * Calculate the square of this number.
+   */
+  constexpr
+  static distance_type Square(unsigned x) {
+    return distance_type(x) * x;
+  }
+
+  /**
+   * An rectangle on the plane that is parallel to the X and Y axes.
+   * The bounds are inclusive.
+   */
+  struct Rectangle {
+    position_type min_x, min_y, max_x, max_y;
+
+    /**
+     * Non-initialising contructor.
+     */
+    Rectangle() = default;
+
+    constexpr
+    Rectangle(position_type _min_x, position_type _min_y,
+              position_type _max_x, position_type _max_y)
+      :min_x(_min_x), min_y(_min_y), max_x(_max_x), max_y(_max_y) {}
+
+    constexpr
+    unsigned GetWidth() const {
+      return max_x - min_x;
+    }
+
+    constexpr
+    unsigned GetHeight() const {
+      return max_y - min_y;
+    }
+
+    constexpr
+    distance_type GetArea() const {
+      return distance_type(GetWidth()) * GetHeight();
+    }
+
+    /**
+     * Returns twice the horizontal center; it does not overflow.
+     */
+    constexpr
+    int64_t GetDoubleCenterX() const {
+      return int64_t(min_x) + max_x;
+    }
+
+    /**
+     * Returns twice the vertical center; it does not overflow.
+     */
+    constexpr
+    int64_t GetDoubleCenterY() const {
+      return int64_t(min_y) + max_y;
+    }
+
+    constexpr
+    bool Overlaps(const Rectangle &other) const {
+      return min_x <= other.max_x && max_x >= other.min_x &&
+        min_y <= other.max_y && max_y >= other.min_y;
+    }
+
+    constexpr
+    bool Contains(const Rectangle &other) const {
+      return min_x <= other.min_x && max_x >= other.max_x &&
+        min_y <= other.min_y && max_y >= other.max_y;
+    }
+
+    /**
+     * Extend the bounds of this rectangle so the specified rectangle
+     * is inside.
+     */
+    void Merge(const Rectangle &other) {
+      min_x = std::min(min_x, other.min_x);
+      min_y = std::min(min_y, other.min_y);
+      max_x = std::max(max_x, other.max_x);
+      max_y = std::max(max_y, other.max_y);
+    }
+
+    /**
+     * By how much would the area grow if the specified rectangle was
+     * merged into this one?
+     */
+    gcc_pure
+    distance_type GetEnlargement(const Rectangle &other) const {
+      Rectangle merged = *this;
+      merged.Merge(other);
+      return merged.GetArea() - GetArea();
+    }
+
+    constexpr
+    unsigned HorizontalDistanceTo(const Rectangle &other) const {
+      return other.max_x < min_x
+        ? min_x - other.max_x
+        : (other.min_x > max_x
+           ? other.min_x - max_x
+           : 0);
+    }
+
+    constexpr
+    unsigned VerticalDistanceTo(const Rectangle &other) const {
+      return other.max_y < min_y
+        ? min_y - other.max_y
+        : (other.min_y > max_y
+           ? other.min_y - max_y
+           : 0);
+    }
+
+    /**
+     * Calculate the minimum square distance of this rectangle to the
+     * specified one.  Returns 0 when they overlap.
+     */
+    constexpr
+    distance_type SquareDistanceTo(const Rectangle &other) const {
+      return Square(HorizontalDistanceTo(other)) +
+        Square(VerticalDistanceTo(other));
+    }
+  };
+
+  /**
+   * Function wrapper for the Accessor.
+   */
+  gcc_pure
+  static Rectangle GetBounds(const T &value) {
+    const Accessor accessor = Accessor();
+    return Rectangle(accessor.GetMinX(value), accessor.GetMinY(value),
+                     accessor.GetMaxX(value), accessor.GetMaxY(value));
+  }
+
+protected:
+  struct Node {
+    Node *parent;
+
+    /**
+     * All leaf nodes are in a doubly linked list, which is used for
+     * iterating over all objects.
+     */
+    Node *previous, *next;
+
+    Rectangle bounds;
+
+    /**
+     * The distance from the leaf nodes; 0 means this is a leaf node.
+     */
+    unsigned level;
+
+    /**
+     * The child nodes; only used if this is not a leaf node.
+     */
+    std::vector<Node *> children;
+
+    /**
+     * The objects; only used if this is a leaf node.
+     */
+    std::vector<T> values;
+
+    explicit Node(unsigned _level)
+      :parent(nullptr), previous(nullptr), next(nullptr), level(_level) {}
+
+    constexpr
+    bool IsLeaf() const {
+      return level == 0;
+    }
+
+    gcc_pure
+    unsigned GetCount() const {
+      return IsLeaf() ? values.size() : children.size();
+    }
+
+    /**
+     * Recalculate the bounds from the entries.  Must not be called
+     * on an empty node.
+     */
+    void UpdateBounds() {
+      assert(GetCount() > 0);
+
+      if (IsLeaf()) {
+        bounds = GetBounds(values.front());
+        for (const auto &value : values)
+          bounds.Merge(GetBounds(value));
+      } else {
+        bounds = children.front()->bounds;
+        for (const Node *child : children)
+          bounds.Merge(child->bounds);
+      }
+    }
+  };
+
+  static Rectangle GetEntryBounds(const T &value) {
+    return GetBounds(value);
+  }
+
+  static const Rectangle &GetEntryBounds(const Node *node) {
+    return node->bounds;
+  }
+
+  Node *root;
+
+  /**
+   * The head of the leaf node list.
+   */
+  Node *first_leaf;
+
+  /**
+   * The number of objects in this tree.
+   */
+  unsigned count;
+
+public:
+  RTree():root(nullptr), first_leaf(nullptr), count(0) {}
+
+  ~RTree() {
+    Clear();
+  }
+
+protected:
+  /**
+   * Insert a leaf node into the linked list, after the specified
+   * one, or at the front if #after is nullptr.
+   */
+  void LinkLeaf(Node *leaf, Node *after) {
+    assert(leaf->IsLeaf());
+
+    leaf->previous = after;
+    if (after != nullptr) {
+      leaf->next = after->next;
+      after->next = leaf;
+    } else {
+      leaf->next = first_leaf;
+      first_leaf = leaf;
+    }
+
+    if (leaf->next != nullptr)
+      leaf->next->previous = leaf;
+  }
+
+  void UnlinkLeaf(Node *leaf) {
+    assert(leaf->IsLeaf());
+
+    if (leaf->previous != nullptr)
+      leaf->previous->next = leaf->next;
+    else
+      first_leaf = leaf->next;
+
+    if (leaf->next != nullptr)
+      leaf->next->previous = leaf->previous;
+  }
+
+  /**
+   * Free the specified node and all of its descendants.  Their
+   * objects are moved to the given vector, unless it is nullptr.
+   */
+  void DeleteNode(Node *node, std::vector<T> *orphans) {
+    if (node->IsLeaf()) {
+      UnlinkLeaf(node);
+
+      if (orphans != nullptr)
+        for (auto &value : node->values)
+          orphans->push_back(std::move(value));
+    } else {
+      for (Node *child : node->children)
+        DeleteNode(child, orphans);
+    }
+
+    delete node;
+  }
+
+  /**
+   * Sort the entries with the "Sort-Tile-Recursive" method: they
+   * are sorted into vertical slices, and each slice is sorted
+   * vertically.  Consecutive runs of #MAX_ENTRIES entries are then
+   * spatially close to each other.
+   */
+  template<typename E>
+  static void SortTileRecursive(E *begin, E *end) {
+    const unsigned n = end - begin;
+    const unsigned n_nodes = (n + MAX_ENTRIES - 1) / MAX_ENTRIES;
+    const unsigned n_slices = (unsigned)ceil(sqrt(double(n_nodes)));
+    const unsigned slice_size = n_slices * MAX_ENTRIES;
+
+    std::sort(begin, end, [](const E &a, const E &b) {
+        return GetEntryBounds(a).GetDoubleCenterX() <
+          GetEntryBounds(b).GetDoubleCenterX();
+      });
+
+    for (E *i = begin; i < end; i += slice_size)
+      std::sort(i, std::min(i + slice_size, end),
+                [](const E &a, const E &b) {
+                  return GetEntryBounds(a).GetDoubleCenterY() <
+                    GetEntryBounds(b).GetDoubleCenterY();
+                });
+  }
+
+  /**
+   * Sort the entries along the longer axis of the given rectangle
+   * and move the upper half to the (empty) vector #dest.
+   */
+  template<typename E>
+  static void SplitEntries(const Rectangle &bounds,
+                           std::vector<E> &src, std::vector<E> &dest) {
+    assert(dest.empty());
+
+    if (bounds.GetWidth() >= bounds.GetHeight())
+      std::sort(src.begin(), src.end(), [](const E &a, const E &b) {
+          return GetEntryBounds(a).GetDoubleCenterX() <
+            GetEntryBounds(b).GetDoubleCenterX();
+        });
+    else
+      std::sort(src.begin(), src.end(), [](const E &a, const E &b) {
+          return GetEntryBounds(a).GetDoubleCenterY() <
+            GetEntryBounds(b).GetDoubleCenterY();
+        });
+
+    const auto middle = src.begin() + src.size() / 2;
+    dest.insert(dest.end(), std::make_move_iterator(middle),
+                std::make_move_iterator(src.end()));
+    src.erase(middle, src.end());
+  }
+
+  /**
+   * Split an overflowing node into two, and add the new one to the
+   * parent (which may overflow then as well).
+   */
+  void Split(Node *node) {
+    assert(node->GetCount() > MAX_ENTRIES);
+
+    Node *sibling = new Node(node->level);
+
+    if (node->IsLeaf()) {
+      SplitEntries(node->bounds, node->values, sibling->values);
+      LinkLeaf(sibling, node);
+    } else {
+      SplitEntries(node->bounds, node->children, sibling->children);
+      for (Node *child : sibling->children)
+        child->parent = sibling;
+    }
+
+    node->UpdateBounds();
+    sibling->UpdateBounds();
+
+    Node *parent = node->parent;
+    if (parent == nullptr) {
+      /* the root was split: grow the tree */
+      assert(node == root);
+
+      parent = root = new Node(node->level + 1);
+      parent->children.push_back(node);
+      node->parent = parent;
+      parent->bounds = node->bounds;
+    }
+
+    parent->children.push_back(sibling);
+    sibling->parent = parent;
+    parent->bounds.Merge(sibling->bounds);
+
+    if (parent->GetCount() > MAX_ENTRIES)
+      Split(parent);
+  }
+
+  /**
+   * Find the leaf node which needs the least enlargement to include
+   * the specified rectangle.
+   */
+  gcc_pure
+  Node *ChooseLeaf(const Rectangle &bounds) const {
+    Node *node = root;
+    while (!node->IsLeaf()) {
+      Node *best = nullptr;
+      distance_type best_enlargement = 0, best_area = 0;
+
+      for (Node *child : node->children) {
+        const distance_type enlargement =
+          child->bounds.GetEnlargement(bounds);
+        const distance_type area = child->bounds.GetArea();
+        if (best == nullptr || enlargement < best_enlargement ||
+            (enlargement == best_enlargement && area < best_area)) {
+          best = child;
+          best_enlargement = enlargement;
+          best_area = area;
+        }
+      }
+
+      node = best;
+    }
+
+    return node;
+  }
+
+  /**
+   * Find the leaf node containing an object which is equal to the
+   * specified one.
+   *
+   * @return the leaf node and the index of the object, or nullptr
+   */
+  gcc_pure
+  std::pair<Node *, unsigned> FindLeaf(Node *node, const Rectangle &bounds,
+                                       const T &value) const {
+    if (node->IsLeaf()) {
+      for (unsigned i = 0, n = node->values.size(); i < n; ++i)
+        if (node->values[i] == value)
+          return std::make_pair(node, i);
+    } else {
+      for (Node *child : node->children) {
+        if (!child->bounds.Contains(bounds))
+          continue;
+
+        auto result = FindLeaf(child, bounds, value);
+        if (result.first != nullptr)
+          return result;
+      }
+    }
+
+    return std::make_pair((Node *)nullptr, 0u);
+  }
+
+  /**
+   * Called after an object has been removed from the specified leaf
+   * node.  Dissolves nodes which have too few entries, updates the
+   * bounds of all ancestors and inserts the orphaned objects again.
+   */
+  void Condense(Node *node) {
+    std::vector<T> orphans;
+
+    while (node != root) {
+      Node *parent = node->parent;
+
+      if (node->GetCount() < MIN_ENTRIES) {
+        auto &siblings = parent->children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+        DeleteNode(node, &orphans);
+      } else
+        node->UpdateBounds();
+
+      node = parent;
+    }
+
+    if (root->GetCount() == 0) {
+      DeleteNode(root, nullptr);
+      root = nullptr;
+    } else {
+      root->UpdateBounds();
+
+      /* shrink the tree if the root has only one child left */
+      while (!root->IsLeaf() && root->children.size() == 1) {
+        Node *child = root->children.front();
+        root->children.clear();
+        delete root;
+
+        root = child;
+        root->parent = nullptr;
+      }
+    }
+
+    count -= orphans.size();
+    for (auto &value : orphans)
+      Add(std::move(value));
+  }
+
+  template<class V>
+  static void VisitOverlapping(const Node &node, const Rectangle &bounds,
+                               V &visitor) {
+    if (node.IsLeaf()) {
+      for (const auto &value : node.values)
+        if (GetBounds(value).Overlaps(bounds))
+          visitor(value);
+    } else {
+      for (const Node *child : node.children)
+        if (child->bounds.Overlaps(bounds))
+          VisitOverlapping(*child, bounds, visitor);
+    }
+  }
+
+  template<class P>
+  static void FindNearestIf(const Node &node, const Rectangle &bounds,
+                            const P &predicate,
+                            const T *&best, distance_type &best_distance) {
+    if (node.IsLeaf()) {
+      for (const auto &value : node.values) {
+        const distance_type distance =
+          GetBounds(value).SquareDistanceTo(bounds);
+        if (distance <= best_distance &&
+            (best == nullptr || distance < best_distance) &&
+            predicate(value)) {
+          best = &value;
+          best_distance = distance;
+        }
+      }
+
+      return;
+    }
+
+    /* visit the closest children first, to narrow the search range
+       quickly */
+    std::pair<distance_type, const Node *> sorted[MAX_ENTRIES];
+    unsigned n = 0;
+    for (const Node *child : node.children) {
+      const distance_type distance = child->bounds.SquareDistanceTo(bounds);
+      if (distance <= best_distance)
+        sorted[n++] = std::make_pair(distance, child);
+    }
+
+    std::sort(sorted, sorted + n,
+              [](const std::pair<distance_type, const Node *> &a,
+                 const std::pair<distance_type, const Node *> &b) {
+                return a.first < b.first;
+              });
+
+    for (unsigned i = 0; i < n && sorted[i].first <= best_distance; ++i)
+      FindNearestIf(*sorted[i].second, bounds, predicate,
+                    best, best_distance);
+  }
+
+public:
+  /**
+   * Does this RTree contain at least one object?
+   */
+  constexpr
+  bool IsEmpty() const {
+    return root == nullptr;
+  }
+
+  gcc_pure
+  unsigned size() const {
+    return count;
+  }
+
+  /**
+   * Remove all objects.
+   */
+  void Clear() {
+    if (root != nullptr) {
+      DeleteNode(root, nullptr);
+      root = nullptr;
+    }
+
+    assert(first_leaf == nullptr);
+    count = 0;
+  }
+
+  void clear() {
+    Clear();
+  }
+
+  /**
+   * Replace the contents of this tree with the specified objects,
+   * building a densely packed tree.
+   */
+  template<typename I>
+  void Load(I first, I last) {
+    Clear();
+
+    std::vector<T> values(first, last);
+    if (values.empty())
+      return;
+
+    count = values.size();
+
+    SortTileRecursive(values.data(), values.data() + values.size());
+
+    std::vector<Node *> nodes;
+    Node *last_leaf = nullptr;
+    for (auto i = values.begin(), end = values.end(); i != end;) {
+      const auto chunk_end = end - i > MAX_ENTRIES ? i + MAX_ENTRIES : end;
+
+      Node *leaf = new Node(0);
+      leaf->values.assign(std::make_move_iterator(i),
+                          std::make_move_iterator(chunk_end));
+      leaf->UpdateBounds();
+      LinkLeaf(leaf, last_leaf);
+      last_leaf = leaf;
+      nodes.push_back(leaf);
+
+      i = chunk_end;
+    }
+
+    for (unsigned level = 1; nodes.size() > 1; ++level) {
+      SortTileRecursive(nodes.data(), nodes.data() + nodes.size());
+
+      std::vector<Node *> parents;
+      for (auto i = nodes.begin(), end = nodes.end(); i != end;) {
+        const auto chunk_end = end - i > MAX_ENTRIES ? i + MAX_ENTRIES : end;
+
+        Node *parent = new Node(level);
+        parent->children.assign(i, chunk_end);
+        for (Node *child : parent->children)
+          child->parent = parent;
+        parent->UpdateBounds();
+        parents.push_back(parent);
+
+        i = chunk_end;
+      }
+
+      nodes.swap(parents);
+    }
+
+    root = nodes.front();
+  }
+
+  /**
+   * Add an object to the tree.
+   */
+  void Add(T value) {
+    const Rectangle bounds = GetBounds(value);
+
+    if (root == nullptr) {
+      root = new Node(0);
+      root->bounds = bounds;
+      LinkLeaf(root, nullptr);
+    }
+
+    Node *leaf = ChooseLeaf(bounds);
+    leaf->values.push_back(std::move(value));
+    ++count;
+
+    for (Node *node = leaf; node != nullptr; node = node->parent)
+      node->bounds.Merge(bounds);
+
+    if (leaf->GetCount() > MAX_ENTRIES)
+      Split(leaf);
+  }
+
+  template<typename U>
+  void insert(U &&value) {
+    Add(std::forward<U>(value));
+  }
+
+  /**
+   * Remove an object which is equal to the specified one.
+   *
+   * @return true if the object was found and removed
+   */
+  bool Remove(const T &value) {
+    if (root == nullptr)
+      return false;
+
+    const Rectangle bounds = GetBounds(value);
+    if (!root->bounds.Contains(bounds))
+      return false;
+
+    const auto found = FindLeaf(root, bounds, value);
+    Node *leaf = found.first;
+    if (leaf == nullptr)
+      return false;
+
+    leaf->values.erase(leaf->values.begin() + found.second);
+    --count;
+
+    Condense(leaf);
+    return true;
+  }
+
+  /**
+   * Invoke the visitor for each object whose bounds overlap the
+   * specified rectangle.
+   */
+  template<class V>
+  void VisitOverlapping(const Rectangle &bounds, V &visitor) const {
+    if (root != nullptr)
+      VisitOverlapping(*root, bounds, visitor);
+  }
+
+  /**
+   * Find the object whose bounds are closest to the specified
+   * rectangle and match the predicate.
+   *
+   * @param range the maximum distance
+   * @return the object or nullptr if there is none within range
+   */
+  template<class P>
+  gcc_pure
+  const T *FindNearestIf(const Rectangle &bounds, unsigned range,
+                         const P &predicate) const {
+    const T *best = nullptr;
+    distance_type best_distance = Square(range);
+
+    if (root != nullptr)
+      FindNearestIf(*root, bounds, predicate, best, best_distance);
+
+    return best;
+  }
+
+  class const_iterator {
+    friend class RTree;
+
+    const Node *leaf;
+    unsigned index;
+
+    constexpr
+    const_iterator(const Node *_leaf)
+      :leaf(_leaf), index(0) {}
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef ptrdiff_t difference_type;
+    typedef const T value_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+
+    constexpr
+    bool operator==(const const_iterator &other) const {
+      return leaf == other.leaf && index == other.index;
+    }
+
+    constexpr
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+    const_iterator &operator++() {
+      assert(leaf != nullptr);
+
+      if (++index == leaf->values.size()) {
+        leaf = leaf->next;
+        index = 0;
+      }
+
+      return *this;
+    }
+
+    reference operator*() const {
+      assert(leaf != nullptr);
+
+      return leaf->values[index];
+    }
+
+    pointer operator->() const {
+      assert(leaf != nullptr);
+
+      return &leaf->values[index];
+    }
+  };
+
+  gcc_pure
+  const_iterator begin() const {
+    return const_iterator(first_leaf);
+  }
+
+  gcc_pure
+  const_iterator end() const {
+    return const_iterator(nullptr);
+  }
+};
+
+#endif
@@ -186,7 +186,7 @@ SettingsLeave(const UISettings &old_ui_settings)
       glide_computer->ClearAirspaces();
 
     airspace_database.Clear();
-    ReadAirspace(airspace_database, terrain,
+    ReadAirspace(airspace_database, terrain, file_cache,
                  CommonInterface::GetComputerSettings().pressure,
                  operation);
   }
@@ -32,6 +32,7 @@ Copyright_License {
 #include "Waypoint/WaypointWriter.hpp"
 #include "Operation/Operation.hpp"
 #include "WaypointFileType.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #include <windef.h> /* for MAX_PATH */
 
@@ -82,7 +83,8 @@ WaypointGlue::IsWritable()
 
 static bool
 LoadWaypointFile(Waypoints &waypoints, const TCHAR *path, int file_num,
-                 const RasterTerrain *terrain, OperationEnvironment &operation)
+                 const RasterTerrain *terrain, WorkerPool &worker_pool,
+                 OperationEnvironment &operation)
 {
   WaypointReader reader(path, file_num);
   if (reader.Error()) {
@@ -92,6 +94,7 @@ LoadWaypointFile(Waypoints &waypoints, const TCHAR *path, int file_num,
 
   // parse the file
   reader.SetTerrain(terrain);
+  reader.SetWorkerPool(&worker_pool);
   if (!reader.Parse(waypoints, operation)) {
     LogFormat(_T("Failed to parse waypoint file: %s"), path);
     return false;
@@ -113,19 +116,24 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
   // Delete old waypoints
   way_points.Clear();
 
+  WorkerPool worker_pool(WorkerPool::GetDefaultThreadCount());
+
   TCHAR path[MAX_PATH];
 
   // ### FIRST FILE ###
   if (Profile::GetPath(ProfileKeys::WaypointFile, path))
-    found |= LoadWaypointFile(way_points, path, 1, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 1, terrain, worker_pool,
+                              operation);
 
   // ### SECOND FILE ###
   if (Profile::GetPath(ProfileKeys::AdditionalWaypointFile, path))
-    found |= LoadWaypointFile(way_points, path, 2, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 2, terrain, worker_pool,
+                              operation);
 
   // ### WATCHED WAYPOINT/THIRD FILE ###
   if (Profile::GetPath(ProfileKeys::WatchedWaypointFile, path))
-    found |= LoadWaypointFile(way_points, path, 3, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 3, terrain, worker_pool,
+                              operation);
 
   // ### MAP/FOURTH FILE ###
 
@@ -134,10 +142,12 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
     TCHAR *tail = path + _tcslen(path);
 
     _tcscpy(tail, _T("/waypoints.xcw"));
-    found |= LoadWaypointFile(way_points, path, 0, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 0, terrain, worker_pool,
+                              operation);
 
     _tcscpy(tail, _T("/waypoints.cup"));
-    found |= LoadWaypointFile(way_points, path, 0, terrain, operation);
+    found |= LoadWaypointFile(way_points, path, 0, terrain, worker_pool,
+                              operation);
   }
 
   // Optimise the waypoint list after attaching new waypoints
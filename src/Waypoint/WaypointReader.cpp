@@ -56,6 +56,13 @@ WaypointReader::SetTerrain(const RasterTerrain* _terrain)
     reader->SetTerrain(_terrain);
 }
 
+void
+WaypointReader::SetWorkerPool(WorkerPool *worker_pool)
+{
+  if (reader != NULL)
+    reader->SetWorkerPool(worker_pool);
+}
+
 void
 WaypointReader::Open(const TCHAR* filename, int the_filenum)
 {
@@ -34,6 +34,7 @@ Copyright_License {
 class Waypoints;
 class RasterTerrain;
 class OperationEnvironment;
+class WorkerPool;
 
 class WaypointReader
 {
@@ -82,6 +83,14 @@ public:
   /** Sets the terrain that should be used for waypoint elevation detection */
   void SetTerrain(const RasterTerrain* _terrain);
 
+  /**
+   * Parse the file in parallel on the given #WorkerPool, if the file
+   * format supports it.
+   *
+   * @see WaypointReaderBase::SetWorkerPool()
+   */
+  void SetWorkerPool(WorkerPool *worker_pool);
+
   /**
    * Parses the waypoint file into the given Waypoints instance
    * @param way_points A Waypoints instance that will hold the parsed waypoints
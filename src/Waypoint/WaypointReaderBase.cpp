@@ -24,9 +24,14 @@ Copyright_License {
 #include "WaypointReaderBase.hpp"
 
 #include "Terrain/RasterTerrain.hpp"
-#include "Waypoint/Waypoint.hpp"
+#include "Waypoint/Waypoints.hpp"
 #include "Operation/Operation.hpp"
 #include "IO/LineReader.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "Util/tstring.hpp"
+#include "Math/fixed.hpp"
+
+#include <algorithm>
 
 #include <assert.h>
 
@@ -34,7 +39,8 @@ WaypointReaderBase::WaypointReaderBase(const int _file_num,
                            bool _compressed):
   file_num(_file_num),
   terrain(NULL),
-  compressed(_compressed)
+  compressed(_compressed),
+  worker_pool(nullptr)
 {
 }
 
@@ -136,44 +142,178 @@ WaypointReaderBase::ExtractParameters(const TCHAR *src, TCHAR *dst,
   return i;
 }
 
+void
+WaypointReaderBase::WaypointVector::MoveAppend(WaypointVector &other)
+{
+  const unsigned offset = size();
+
+  reserve(offset + other.size());
+  for (auto &wp : other)
+    push_back(std::move(wp));
+
+  for (unsigned i : other.missing_elevation)
+    missing_elevation.push_back(offset + i);
+
+  other.clear();
+}
+
 bool
 WaypointReaderBase::CheckAltitude(Waypoint &new_waypoint,
-                                  const RasterTerrain *terrain)
+                                  WaypointVector &way_points) const
 {
   if (terrain == NULL)
     return false;
 
-  // Load waypoint altitude from terrain
-  const short t_alt = terrain->GetTerrainHeight(new_waypoint.location);
-  if (RasterBuffer::IsSpecial(t_alt))
-    new_waypoint.elevation = fixed(0);
-  else
-    // TERRAIN_VALID
-    new_waypoint.elevation = (fixed)t_alt;
-
+  /* the caller appends the waypoint next, so this will be its
+     index */
+  way_points.missing_elevation.push_back(way_points.size());
+  new_waypoint.elevation = fixed(0);
   return true;
 }
 
-bool
-WaypointReaderBase::CheckAltitude(Waypoint &new_waypoint) const
+/**
+ * Sort key which groups nearby locations: a grid of 1/4 degree
+ * cells, row by row.  This is finer than a terrain tile, so
+ * consecutive lookups mostly hit the same tile.
+ */
+static std::pair<int, int>
+GetGridCell(const GeoPoint &location)
 {
-  return CheckAltitude(new_waypoint, terrain);
+  return std::make_pair(iround(location.latitude.Degrees() * 4),
+                        iround(location.longitude.Degrees() * 4));
 }
 
 void
-WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
-                          OperationEnvironment &operation)
+WaypointReaderBase::LookupElevations(WaypointVector &way_points) const
+{
+  auto &missing = way_points.missing_elevation;
+  if (missing.empty())
+    return;
+
+  assert(terrain != NULL);
+
+  std::sort(missing.begin(), missing.end(),
+            [&way_points](unsigned a, unsigned b) {
+              return GetGridCell(way_points[a].location) <
+                GetGridCell(way_points[b].location);
+            });
+
+  const unsigned n = missing.size();
+  std::vector<GeoPoint> locations;
+  locations.reserve(n);
+  for (unsigned i : missing)
+    locations.push_back(way_points[i].location);
+
+  std::vector<short> heights(n);
+
+  {
+    RasterTerrain::Lease map(*terrain);
+    map->GetHeights(locations.data(), heights.data(), n);
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    const short t_alt = heights[i];
+    way_points[missing[i]].elevation = RasterBuffer::IsSpecial(t_alt)
+      ? fixed(0)
+      // TERRAIN_VALID
+      : (fixed)t_alt;
+  }
+
+  missing.clear();
+}
+
+static void
+AppendWaypoints(Waypoints &way_points,
+                WaypointReaderBase::WaypointVector &parsed)
+{
+  for (auto &wp : parsed)
+    way_points.Append(std::move(wp));
+
+  parsed.clear();
+}
+
+void
+WaypointReaderBase::ParseSequential(Waypoints &way_points, TLineReader &reader,
+                                    OperationEnvironment &operation)
 {
   const long filesize = std::max(reader.GetSize(), 1l);
   operation.SetProgressRange(100);
 
+  WaypointVector parsed;
+
   // Read through the lines of the file
   TCHAR *line;
   for (unsigned i = 0; (line = reader.ReadLine()) != NULL; i++) {
+    if (IsEndOfWaypoints(line, i))
+      break;
+
     // and parse them
-    ParseLine(line, i, way_points);
+    ParseLine(line, i, parsed);
+
+    if ((i & 0x3f) == 0)
+      operation.SetProgressPosition(reader.Tell() * 100 / filesize);
+  }
+
+  LookupElevations(parsed);
+  AppendWaypoints(way_points, parsed);
+}
+
+void
+WaypointReaderBase::ParseParallel(Waypoints &way_points, TLineReader &reader,
+                                  OperationEnvironment &operation)
+{
+  const long filesize = std::max(reader.GetSize(), 1l);
+  operation.SetProgressRange(100);
+
+  std::vector<tstring> lines;
+
+  TCHAR *line;
+  for (unsigned i = 0; (line = reader.ReadLine()) != NULL; i++) {
+    if (IsEndOfWaypoints(line, i))
+      break;
+
+    lines.emplace_back(line);
 
     if ((i & 0x3f) == 0)
       operation.SetProgressPosition(reader.Tell() * 100 / filesize);
   }
+
+  if (lines.empty())
+    return;
+
+  /* the first line may be a header which configures the reader, so
+     it must be parsed before all others */
+  WaypointVector parsed;
+  ParseLine(lines.front().c_str(), 0, parsed);
+
+  static constexpr unsigned CHUNK_SIZE = 256;
+  const unsigned n_lines = lines.size();
+  const unsigned n_chunks = (n_lines - 1 + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  std::vector<WaypointVector> chunks(n_chunks);
+
+  worker_pool->Run(n_chunks, [this, &lines, &chunks, n_lines](unsigned chunk) {
+      const unsigned begin = 1 + chunk * CHUNK_SIZE;
+      const unsigned end = std::min(n_lines, begin + unsigned(CHUNK_SIZE));
+      for (unsigned i = begin; i < end; ++i)
+        ParseLine(lines[i].c_str(), i, chunks[chunk]);
+    });
+
+  for (auto &chunk : chunks)
+    parsed.MoveAppend(chunk);
+
+  LookupElevations(parsed);
+  AppendWaypoints(way_points, parsed);
+}
+
+void
+WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
+                          OperationEnvironment &operation)
+{
+  /* buffering the file only pays off if there are threads which can
+     share the work */
+  if (worker_pool != nullptr && worker_pool->GetThreadCount() > 0 &&
+      IsParallelSafe())
+    ParseParallel(way_points, reader, operation);
+  else
+    ParseSequential(way_points, reader, operation);
 }
@@ -25,14 +25,18 @@ Copyright_License {
 #ifndef WAYPOINTFILE_HPP
 #define WAYPOINTFILE_HPP
 
+#include "Waypoint/Waypoint.hpp"
+
+#include <vector>
+
 #include <tchar.h>
 #include <stddef.h>
 
-struct Waypoint;
 class Waypoints;
 class RasterTerrain;
 class TLineReader;
 class OperationEnvironment;
+class WorkerPool;
 
 class WaypointReaderBase 
 {
@@ -41,6 +45,35 @@ protected:
   const RasterTerrain* terrain;
   bool compressed;
 
+  /**
+   * If set, the lines are parsed in parallel on this pool (if the
+   * reader supports it).
+   */
+  WorkerPool *worker_pool;
+
+public:
+  /**
+   * The waypoints parsed from a range of lines, before they are
+   * appended to the #Waypoints container.
+   */
+  struct WaypointVector : std::vector<Waypoint> {
+    /**
+     * Indices of the waypoints whose elevation is missing in the file
+     * and will be looked up in the terrain after parsing.
+     */
+    std::vector<unsigned> missing_elevation;
+
+    void clear() {
+      std::vector<Waypoint>::clear();
+      missing_elevation.clear();
+    }
+
+    /**
+     * Move all waypoints of the other list to the end of this one.
+     */
+    void MoveAppend(WaypointVector &other);
+  };
+
 protected:
   WaypointReaderBase(const int _file_num,
                bool _compressed = false);
@@ -61,21 +94,69 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Parse the file in parallel on the given #WorkerPool, if the
+   * reader supports it (see IsParallelSafe()).  The file is read into
+   * memory first, then it is parsed in chunks, and the waypoints are
+   * appended in file order.  Pass nullptr to parse sequentially (the
+   * default).
+   */
+  void SetWorkerPool(WorkerPool *_worker_pool) {
+    worker_pool = _worker_pool;
+  }
+
 protected:
-  static bool CheckAltitude(Waypoint &new_waypoint, const RasterTerrain *terrain);
-  bool CheckAltitude(Waypoint &new_waypoint) const;
+  /**
+   * Called by ParseLine() for a waypoint without elevation, right
+   * before it is appended to the list.  The elevation is not looked
+   * up immediately: all such waypoints are collected and resolved in
+   * one batch after parsing (see LookupElevations()).
+   *
+   * @return false if there is no terrain to obtain the elevation
+   * from, and the waypoint should be discarded
+   */
+  bool CheckAltitude(Waypoint &new_waypoint, WaypointVector &way_points) const;
 
   /**
    * Parse a file line
    * @param line The line to parse
    * @param linenum The line number in the file
-   * @param way_points The waypoint list to fill
-   * @param terrain RasterTerrain (for automatic waypoint height)
+   * @param way_points The list which the new waypoints are appended to
    * @return True if the line was parsed correctly or ignored, False if
    * parsing error occured
    */
   virtual bool ParseLine(const TCHAR* line, unsigned linenum,
-                         Waypoints &way_points) = 0;
+                         WaypointVector &way_points) = 0;
+
+  /**
+   * Does this line end the waypoint list?  It and all following lines
+   * are not passed to ParseLine().
+   */
+  virtual bool IsEndOfWaypoints(const TCHAR *line, unsigned linenum) const {
+    return false;
+  }
+
+  /**
+   * May ParseLine() be called concurrently for all lines except the
+   * first one?  That requires that it modifies the reader's state
+   * only while parsing the first line.
+   */
+  virtual bool IsParallelSafe() const {
+    return false;
+  }
+
+private:
+  /**
+   * Look up the elevations of all waypoints in the "missing_elevation"
+   * list in the terrain, with one terrain lock and sorted by location
+   * so each terrain tile is visited only once or a few times.
+   */
+  void LookupElevations(WaypointVector &way_points) const;
+
+  void ParseSequential(Waypoints &way_points, TLineReader &reader,
+                       OperationEnvironment &operation);
+  void ParseParallel(Waypoints &way_points, TLineReader &reader,
+                     OperationEnvironment &operation);
 
 public:
   // Helper functions
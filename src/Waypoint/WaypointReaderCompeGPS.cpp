@@ -142,7 +142,7 @@ ParseAltitude(const TCHAR *&src, fixed &dest)
 
 bool
 WaypointReaderCompeGPS::ParseLine(const TCHAR* line, const unsigned linenum,
-                                  Waypoints &waypoints)
+                                  WaypointVector &waypoints)
 {
   /*
    * G  WGS 84
@@ -221,7 +221,7 @@ WaypointReaderCompeGPS::ParseLine(const TCHAR* line, const unsigned linenum,
 
   // Parse altitude
   if (!ParseAltitude(line, waypoint.elevation) &&
-      !CheckAltitude(waypoint))
+      !CheckAltitude(waypoint, waypoints))
     return false;
 
   // Skip whitespace
@@ -231,7 +231,7 @@ WaypointReaderCompeGPS::ParseLine(const TCHAR* line, const unsigned linenum,
   // Parse waypoint name
   waypoint.comment.assign(line);
 
-  waypoints.Append(std::move(waypoint));
+  waypoints.push_back(std::move(waypoint));
   return true;
 }
 
@@ -40,7 +40,7 @@ public:
 
 protected:
   bool ParseLine(const TCHAR* line, const unsigned linenum,
-                 Waypoints &way_points);
+                 WaypointVector &way_points);
 };
 
 #endif
@@ -146,7 +146,7 @@ ParseString(const TCHAR *src, tstring &dest, unsigned len = 0)
 
 bool
 WaypointReaderFS::ParseLine(const TCHAR* line, const unsigned linenum,
-                              Waypoints &way_points)
+                              WaypointVector &way_points)
 {
   //$FormatGEO
   //ACONCAGU  S 32 39 12.00    W 070 00 42.00  6962  Aconcagua
@@ -193,14 +193,14 @@ WaypointReaderFS::ParseLine(const TCHAR* line, const unsigned linenum,
     return false;
 
   if (!ParseAltitude(line + (is_utm ? 32 : 41), new_waypoint.elevation) &&
-      !CheckAltitude(new_waypoint))
+      !CheckAltitude(new_waypoint, way_points))
     return false;
 
   // Description (Characters 35-44)
   if (len > (is_utm ? 38 : 47))
     ParseString(line + (is_utm ? 38 : 47), new_waypoint.comment);
 
-  way_points.Append(std::move(new_waypoint));
+  way_points.push_back(std::move(new_waypoint));
   return true;
 }
 
@@ -67,7 +67,7 @@ ParseString(const TCHAR *src, tstring &dest)
 
 bool
 WaypointReaderOzi::ParseLine(const TCHAR* line, const unsigned linenum,
-                              Waypoints &way_points)
+                              WaypointVector &way_points)
 {
   if (line[0] == '\0')
     return true;
@@ -114,13 +114,13 @@ WaypointReaderOzi::ParseLine(const TCHAR* line, const unsigned linenum,
 
   if (ParseNumber(params[14], value) && value != -777)
     new_waypoint.elevation = Units::ToSysUnit(fixed(value), Unit::FEET);
-  else if (!CheckAltitude(new_waypoint))
+  else if (!CheckAltitude(new_waypoint, way_points))
     return false;
 
   // Description (Characters 35-44)
   ParseString(params[11], new_waypoint.comment);
 
-  way_points.Append(std::move(new_waypoint));
+  way_points.push_back(std::move(new_waypoint));
   return true;
 }
 
@@ -158,9 +158,18 @@ ParseStyle(const TCHAR* src, Waypoint::Type &type)
   return true;
 }
 
+bool
+WaypointReaderSeeYou::IsEndOfWaypoints(const TCHAR *line,
+                                       unsigned linenum) const
+{
+  // The first line is the field order line, or a waypoint
+  return linenum > 0 &&
+    StringStartsWith(line, _T("-----Related Tasks-----"));
+}
+
 bool
 WaypointReaderSeeYou::ParseLine(const TCHAR* line, const unsigned linenum,
-                              Waypoints &waypoints)
+                              WaypointVector &waypoints)
 {
   enum {
     iName = 0,
@@ -174,9 +183,6 @@ WaypointReaderSeeYou::ParseLine(const TCHAR* line, const unsigned linenum,
     iDescription = 10,
   };
 
-  if (linenum == 0)
-    ignore_following = false;
-
   // If (end-of-file or comment)
   if (StringIsEmpty(line) ||
       StringStartsWith(line, _T("**")) ||
@@ -194,12 +200,6 @@ WaypointReaderSeeYou::ParseLine(const TCHAR* line, const unsigned linenum,
   if (linenum == 0 && line[0] != _T('\"'))
     return true;
 
-  // If task marker is reached ignore all following lines
-  if (_tcsstr(line, _T("-----Related Tasks-----")) == line)
-    ignore_following = true;
-  if (ignore_following)
-    return true;
-
   // Get fields
   const TCHAR *params[20];
   size_t n_params = ExtractParameters(line, ctemp, params,
@@ -235,7 +235,7 @@ WaypointReaderSeeYou::ParseLine(const TCHAR* line, const unsigned linenum,
   /// @todo configurable behaviour
   if ((iElevation >= n_params ||
       !ParseAltitude(params[iElevation], new_waypoint.elevation)) &&
-      !CheckAltitude(new_waypoint))
+      !CheckAltitude(new_waypoint, waypoints))
     return false;
 
   // Style (e.g. 5)
@@ -281,6 +281,6 @@ WaypointReaderSeeYou::ParseLine(const TCHAR* line, const unsigned linenum,
     new_waypoint.comment = params[iDescription];
   }
 
-  waypoints.Append(std::move(new_waypoint));
+  waypoints.push_back(std::move(new_waypoint));
   return true;
 }
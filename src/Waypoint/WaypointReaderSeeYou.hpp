@@ -30,8 +30,6 @@ Copyright_License {
 class WaypointReaderSeeYou: 
   public WaypointReaderBase 
 {
-  bool ignore_following;
-
 public:
   WaypointReaderSeeYou(const int _file_num,
                      bool _compressed = false)
@@ -44,7 +42,16 @@ protected:
    * @see http://data.naviter.si/docs/cup_format.pdf
    */
   bool ParseLine(const TCHAR* line, const unsigned linenum,
-                 Waypoints &way_points);
+                 WaypointVector &way_points);
+
+  /**
+   * The task section which follows the waypoints is ignored.
+   */
+  bool IsEndOfWaypoints(const TCHAR *line, unsigned linenum) const;
+
+  bool IsParallelSafe() const {
+    return true;
+  }
 };
 
 #endif
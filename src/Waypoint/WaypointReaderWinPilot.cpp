@@ -187,12 +187,11 @@ ParseFlags(const TCHAR* src, Waypoint &dest)
 
 bool
 WaypointReaderWinPilot::ParseLine(const TCHAR* line, const unsigned linenum,
-                                Waypoints &waypoints)
+                                WaypointVector &waypoints)
 {
   TCHAR ctemp[4096];
   const TCHAR *params[20];
   static constexpr unsigned int max_params = ARRAY_SIZE(params);
-  static bool welt2000_format = false;
   size_t n_params;
 
   if (linenum == 0)
@@ -243,7 +242,7 @@ WaypointReaderWinPilot::ParseLine(const TCHAR* line, const unsigned linenum,
   // Altitude (e.g. 458M)
   /// @todo configurable behaviour
   if (!ParseAltitude(params[3], new_waypoint.elevation) &&
-      !CheckAltitude(new_waypoint))
+      !CheckAltitude(new_waypoint, waypoints))
     return false;
 
   if (n_params > 6) {
@@ -256,6 +255,6 @@ WaypointReaderWinPilot::ParseLine(const TCHAR* line, const unsigned linenum,
   // Waypoint Flags (e.g. AT)
   ParseFlags(params[4], new_waypoint);
 
-  waypoints.Append(std::move(new_waypoint));
+  waypoints.push_back(std::move(new_waypoint));
   return true;
 }
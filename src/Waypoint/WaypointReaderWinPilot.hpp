@@ -33,14 +33,24 @@ Copyright_License {
 class WaypointReaderWinPilot: 
   public WaypointReaderBase 
 {
+  /**
+   * Was the file written by Welt2000?  This is detected in the first
+   * line.
+   */
+  bool welt2000_format;
+
 public:
   WaypointReaderWinPilot(const int _file_num,
                        bool _compressed = false)
-    :WaypointReaderBase(_file_num, _compressed) {}
+    :WaypointReaderBase(_file_num, _compressed), welt2000_format(false) {}
 
 protected:
   bool ParseLine(const TCHAR* line, const unsigned linenum,
-                 Waypoints &way_points);
+                 WaypointVector &way_points);
+
+  bool IsParallelSafe() const {
+    return true;
+  }
 };
 
 #endif
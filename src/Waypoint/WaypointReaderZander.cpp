@@ -148,7 +148,7 @@ ParseFlagsFromDescription(const TCHAR* src, Waypoint &dest)
 
 bool
 WaypointReaderZander::ParseLine(const TCHAR* line, const unsigned linenum,
-                              Waypoints &way_points)
+                              WaypointVector &way_points)
 {
   // If (end-of-file or comment)
   if (line[0] == '\0' ||
@@ -186,7 +186,7 @@ WaypointReaderZander::ParseLine(const TCHAR* line, const unsigned linenum,
   // Altitude (Characters 30-34 // e.g. 1561 (in meters))
   /// @todo configurable behaviour
   if (!ParseAltitude(line + 30, new_waypoint.elevation) &&
-      !CheckAltitude(new_waypoint))
+      !CheckAltitude(new_waypoint, way_points))
     return false;
 
   // Description (Characters 35-44)
@@ -198,6 +198,6 @@ WaypointReaderZander::ParseLine(const TCHAR* line, const unsigned linenum,
     if (len < 36 || !ParseFlagsFromDescription(line + 35, new_waypoint))
       new_waypoint.flags.turn_point = true;
 
-  way_points.Append(std::move(new_waypoint));
+  way_points.push_back(std::move(new_waypoint));
   return true;
 }
@@ -0,0 +1,182 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compare the R-tree in the Airspaces class with the kd-tree which
+ * was used before, on a real airspace file.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspaceVisitor.hpp"
+#include "Geo/Flat/BoundingBoxDistance.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+
+#include <kdtree++/kdtree.hpp>
+
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Function object used by kd-tree to index coordinates */
+struct kd_get_bounds {
+  typedef int result_type;
+
+  int operator()(const FlatBoundingBox &d, const unsigned k) const {
+    switch(k) {
+    case 0:
+      return d.GetLowerLeft().longitude;
+    case 1:
+      return d.GetLowerLeft().latitude;
+    case 2:
+      return d.GetUpperRight().longitude;
+    case 3:
+      return d.GetUpperRight().latitude;
+    };
+    return 0;
+  };
+};
+
+/** Distance metric function object used by kd-tree */
+struct kd_distance {
+  typedef BBDist distance_type;
+
+  distance_type operator()(const int a, const int b, const size_t dim) const {
+    return BBDist(dim, std::max((dim < 2) ? (b - a) : (a - b), 0));
+  }
+};
+
+typedef KDTree::KDTree<4, Airspace, kd_get_bounds, kd_distance> KDAirspaceTree;
+
+struct Counter {
+  unsigned count;
+
+  Counter():count(0) {}
+
+  void operator()(const Airspace &as) {
+    ++count;
+  }
+};
+
+class CountingVisitor : public AirspaceVisitor {
+public:
+  unsigned count;
+
+  CountingVisitor():count(0) {}
+
+  virtual void Visit(const AbstractAirspace &as) override {
+    ++count;
+  }
+};
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "PATH");
+  const char *path = args.ExpectNext();
+  args.ExpectEnd();
+
+  FileLineReader reader(path, ConvertLineReader::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open input file\n");
+    return 1;
+  }
+
+  Airspaces airspaces;
+  AirspaceParser parser(airspaces);
+
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse input file\n");
+    return 1;
+  }
+
+  uint64_t start = MonotonicClockUS();
+  airspaces.Optimise();
+  const uint64_t rtree_build = MonotonicClockUS() - start;
+
+  const TaskProjection &projection = airspaces.GetProjection();
+
+  std::vector<GeoPoint> centers;
+  start = MonotonicClockUS();
+  KDAirspaceTree kd_tree;
+  for (const Airspace &as : airspaces) {
+    kd_tree.insert(as);
+    centers.push_back(as.GetAirspace()->GetCenter());
+  }
+  kd_tree.optimise();
+  const uint64_t kd_build = MonotonicClockUS() - start;
+
+  printf("%u airspaces\n", airspaces.GetSize());
+  printf("build: kd-tree %.3f ms, Airspaces::Optimise() %.3f ms\n",
+         kd_build / 1000., rtree_build / 1000.);
+
+  if (centers.empty())
+    return 0;
+
+  /* random query locations around the airspaces */
+  const unsigned n_queries = 100000;
+  std::vector<GeoPoint> locations;
+  for (unsigned i = 0; i < n_queries; ++i) {
+    GeoPoint location = centers[rand() % centers.size()];
+    location.longitude += Angle::Degrees((rand() % 2001 - 1000) / 5000.);
+    location.latitude += Angle::Degrees((rand() % 2001 - 1000) / 5000.);
+    locations.push_back(location);
+  }
+
+  const fixed range(20000);
+
+  for (unsigned i = 0; i < 2; ++i) {
+    const fixed query_range = i == 0 ? fixed(0) : range;
+
+    unsigned kd_count = 0;
+    start = MonotonicClockUS();
+    for (const GeoPoint &location : locations) {
+      const Airspace bb_target(location, projection);
+      const int projected_range =
+        projection.ProjectRangeInteger(location, query_range);
+      Counter counter;
+      kd_tree.visit_within_range(bb_target, -projected_range, counter);
+      kd_count += counter.count;
+    }
+    const uint64_t kd_time = MonotonicClockUS() - start;
+
+    unsigned rtree_count = 0;
+    start = MonotonicClockUS();
+    for (const GeoPoint &location : locations) {
+      CountingVisitor visitor;
+      airspaces.VisitWithinRange(location, query_range, visitor);
+      rtree_count += visitor.count;
+    }
+    const uint64_t rtree_time = MonotonicClockUS() - start;
+
+    printf("range %um: kd-tree %.3f ms (%u found), R-tree %.3f ms (%u found)\n",
+           (unsigned)query_range, kd_time / 1000., kd_count,
+           rtree_time / 1000., rtree_count);
+  }
+
+  return 0;
+}
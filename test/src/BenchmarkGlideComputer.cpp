@@ -0,0 +1,449 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Replay a flight through the GlideComputer with waypoints, airspace,
+ * terrain and a task loaded, and report how much time and memory
+ * each expensive part of ProcessGPS() and ProcessIdle() costs per
+ * call.
+ *
+ * Pass "-" instead of a file name to leave out that data set.
+ */
+
+#include "Computer/GlideComputer.hpp"
+#include "Computer/GlideComputerInterface.hpp"
+#include "Computer/Profiler.hpp"
+#include "Computer/Settings.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Task/TaskFile.hpp"
+#include "Engine/Task/TaskManager.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Waypoint/WaypointReader.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Terrain/RasterTerrain.hpp"
+#include "IO/FileLineReader.hpp"
+#include "OS/ConvertPathName.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "Compatibility/path.h"
+#include "Operation/Operation.hpp"
+#include "DebugReplay.hpp"
+
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tchar.h>
+
+/* fake symbols: */
+
+#include "Computer/ConditionMonitor/ConditionMonitors.hpp"
+#include "Input/InputQueue.hpp"
+#include "Logger/Logger.hpp"
+
+void
+ConditionMonitorsUpdate(const NMEAInfo &basic, const DerivedInfo &calculated,
+                        const ComputerSettings &settings)
+{
+}
+
+bool InputEvents::processGlideComputer(unsigned) { return false; }
+
+void Logger::LogStartEvent(const NMEAInfo &gps_info) {}
+void Logger::LogFinishEvent(const NMEAInfo &gps_info) {}
+void Logger::LogPoint(const NMEAInfo &gps_info) {}
+
+/* done with fake symbols. */
+
+/* count all heap allocations; other threads (e.g. the WorkerPool)
+   allocate, too, and only the totals matter, so relaxed atomics are
+   good enough */
+
+static std::atomic<unsigned long> n_allocations;
+static std::atomic<unsigned long> allocated_bytes;
+
+void *
+operator new(size_t size)
+{
+  n_allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+  void *p = malloc(size != 0 ? size : 1);
+  if (p == nullptr)
+    /* exceptions are disabled */
+    abort();
+
+  return p;
+}
+
+void *
+operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+/* not inlined, or GCC sees operator new() paired with free() and
+   warns (-Wmismatched-new-delete) */
+
+gcc_noinline
+void
+operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+gcc_noinline
+void
+operator delete[](void *p) noexcept
+{
+  free(p);
+}
+
+/**
+ * Call ProcessIdle() after this many fixes, like RunAnalysis does.
+ */
+static constexpr unsigned IDLE_INTERVAL = 8;
+
+/**
+ * The time histogram has power-of-two buckets: bucket 0 counts calls
+ * below 1 microsecond, bucket i counts calls below 2^i microseconds,
+ * and the last one everything slower.
+ */
+static constexpr unsigned N_BUCKETS = 24;
+
+struct Statistics {
+  const char *name;
+
+  unsigned long calls;
+  uint64_t total_us, max_us;
+  unsigned long allocations, bytes;
+  unsigned long histogram[N_BUCKETS];
+
+  uint64_t start_us;
+  unsigned long start_allocations, start_bytes;
+
+  explicit Statistics(const char *_name)
+    :name(_name), calls(0), total_us(0), max_us(0),
+     allocations(0), bytes(0) {
+    std::fill_n(histogram, N_BUCKETS, 0ul);
+  }
+
+  void Begin() {
+    start_allocations = n_allocations.load(std::memory_order_relaxed);
+    start_bytes = allocated_bytes.load(std::memory_order_relaxed);
+    start_us = MonotonicClockUS();
+  }
+
+  void End() {
+    const uint64_t us = MonotonicClockUS() - start_us;
+
+    ++calls;
+    total_us += us;
+    if (us > max_us)
+      max_us = us;
+
+    unsigned bucket = 0;
+    while (bucket < N_BUCKETS - 1 && us >= (uint64_t(1) << bucket))
+      ++bucket;
+    ++histogram[bucket];
+
+    allocations += n_allocations.load(std::memory_order_relaxed)
+      - start_allocations;
+    bytes += allocated_bytes.load(std::memory_order_relaxed) - start_bytes;
+  }
+
+  /**
+   * Returns the upper bound of the bucket which contains the given
+   * fraction of the calls.
+   */
+  gcc_pure
+  uint64_t Percentile(double fraction) const {
+    const unsigned long limit = (unsigned long)(calls * fraction);
+    unsigned long sum = 0;
+    for (unsigned i = 0; i < N_BUCKETS; ++i) {
+      sum += histogram[i];
+      if (sum > limit)
+        return uint64_t(1) << i;
+    }
+
+    return max_us;
+  }
+
+  void Print() const {
+    if (calls == 0) {
+      printf("%-10s no calls\n", name);
+      return;
+    }
+
+    printf("%-10s %8lu %10.3f %8.1f %8lu %8lu %8lu %10.1f %10.0f\n",
+           name, calls, total_us / 1000., double(total_us) / calls,
+           (unsigned long)Percentile(0.5), (unsigned long)Percentile(0.95),
+           (unsigned long)max_us,
+           double(allocations) / calls, double(bytes) / calls);
+  }
+
+  void PrintHistogram() const {
+    if (calls == 0)
+      return;
+
+    printf("%-10s", name);
+    for (unsigned i = 0; i < N_BUCKETS; ++i)
+      if (histogram[i] > 0)
+        printf(" <%luus:%lu", 1ul << i, histogram[i]);
+    printf("\n");
+  }
+};
+
+class BenchmarkProfiler final : public ComputerProfiler {
+public:
+  Statistics sections[unsigned(Section::COUNT)] = {
+    Statistics("task"),
+    Statistics("task idle"),
+    Statistics("route"),
+    Statistics("contest"),
+    Statistics("warnings"),
+    Statistics("wind"),
+  };
+
+  Statistics gps = Statistics("ProcessGPS");
+  Statistics idle = Statistics("ProcessIdle");
+
+  virtual void BeginSection(Section section) override {
+    sections[unsigned(section)].Begin();
+  }
+
+  virtual void EndSection(Section section) override {
+    sections[unsigned(section)].End();
+  }
+
+  void Print() const {
+    printf("%-10s %8s %10s %8s %8s %8s %8s %10s %10s\n",
+           "", "calls", "total/ms", "mean/us", "p50/us", "p95/us", "max/us",
+           "allocs", "bytes");
+    gps.Print();
+    idle.Print();
+    for (const auto &i : sections)
+      i.Print();
+
+    printf("\nhistograms:\n");
+    gps.PrintHistogram();
+    idle.PrintHistogram();
+    for (const auto &i : sections)
+      i.PrintHistogram();
+  }
+};
+
+static bool
+LoadWaypoints(const char *_path, Waypoints &waypoints)
+{
+  PathName path(_path);
+  WaypointReader parser(path, 0);
+  if (parser.Error()) {
+    fprintf(stderr, "Failed to open %s\n", _path);
+    return false;
+  }
+
+  NullOperationEnvironment operation;
+  if (!parser.Parse(waypoints, operation)) {
+    fprintf(stderr, "Failed to parse %s\n", _path);
+    return false;
+  }
+
+  waypoints.Optimise();
+  return true;
+}
+
+static bool
+LoadAirspaces(const char *path, Airspaces &airspaces)
+{
+  FileLineReader reader(path, ConvertLineReader::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return false;
+  }
+
+  AirspaceParser parser(airspaces);
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse %s\n", path);
+    return false;
+  }
+
+  airspaces.Optimise();
+  return true;
+}
+
+static RasterTerrain *
+LoadTerrain(const char *_path)
+{
+  PathName path(_path);
+
+  TCHAR jp2_path[4096];
+  _tcscpy(jp2_path, path);
+  _tcscat(jp2_path, _T(DIR_SEPARATOR_S) _T("terrain.jp2"));
+
+  TCHAR j2w_path[4096];
+  _tcscpy(j2w_path, path);
+  _tcscat(j2w_path, _T(DIR_SEPARATOR_S) _T("terrain.j2w"));
+
+  NullOperationEnvironment operation;
+  RasterTerrain *terrain = new RasterTerrain(jp2_path, j2w_path, nullptr,
+                                             operation);
+  const bool defined = RasterTerrain::Lease(*terrain)->IsDefined();
+  if (!defined) {
+    fprintf(stderr, "Failed to load %s\n", _path);
+    delete terrain;
+    return nullptr;
+  }
+
+  return terrain;
+}
+
+/**
+ * Load the terrain tiles around the aircraft, which is done by the
+ * draw thread in the real program.  This is not part of the
+ * measurement.
+ */
+static void
+UpdateTerrain(RasterTerrain &terrain, const GeoPoint &location)
+{
+  RasterTerrain::ExclusiveLease lease(terrain);
+  do {
+    lease->SetViewCenter(location, fixed(50000));
+  } while (lease->IsDirty());
+}
+
+static bool
+IsSkipped(const char *path)
+{
+  return strcmp(path, "-") == 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv, "WAYPOINTS AIRSPACE MAP TASK [DRIVER] FILE");
+  const char *waypoints_path = args.ExpectNext();
+  const char *airspace_path = args.ExpectNext();
+  const char *map_path = args.ExpectNext();
+  const char *task_path = args.ExpectNext();
+
+  DebugReplay *replay = CreateDebugReplay(args);
+  if (replay == nullptr)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  Waypoints waypoints;
+  if (!IsSkipped(waypoints_path) && !LoadWaypoints(waypoints_path, waypoints))
+    return EXIT_FAILURE;
+
+  Airspaces airspaces;
+  if (!IsSkipped(airspace_path) && !LoadAirspaces(airspace_path, airspaces))
+    return EXIT_FAILURE;
+
+  RasterTerrain *terrain = nullptr;
+  if (!IsSkipped(map_path)) {
+    terrain = LoadTerrain(map_path);
+    if (terrain == nullptr)
+      return EXIT_FAILURE;
+  }
+
+  ComputerSettings settings;
+  settings.SetDefaults();
+  settings.polar.glide_polar_task = GlidePolar(fixed(1));
+
+  /* enable the optional calculations, to measure them as well */
+  settings.task.route_planner.mode = RoutePlannerConfig::Mode::BOTH;
+  settings.task.route_planner.reach_calc_mode =
+    RoutePlannerConfig::ReachMode::TURNING;
+
+  TaskManager task_manager(settings.task, waypoints);
+  task_manager.SetGlidePolar(settings.polar.glide_polar_task);
+
+  GlideComputerTaskEvents task_events;
+  task_manager.SetTaskEvents(task_events);
+
+  ProtectedTaskManager protected_task_manager(task_manager, settings.task);
+
+  if (!IsSkipped(task_path)) {
+    OrderedTask *task = TaskFile::GetTask(PathName(task_path), settings.task,
+                                          &waypoints, 0);
+    if (task == nullptr) {
+      fprintf(stderr, "Failed to load %s\n", task_path);
+      return EXIT_FAILURE;
+    }
+
+    protected_task_manager.TaskCommit(*task);
+    delete task;
+  }
+
+  GlideComputer glide_computer(waypoints, airspaces,
+                               protected_task_manager, task_events);
+  glide_computer.ReadComputerSettings(settings);
+  glide_computer.SetTerrain(terrain);
+  glide_computer.Initialise();
+
+  BenchmarkProfiler profiler;
+  glide_computer.SetProfiler(&profiler);
+
+  unsigned n_fixes = 0, i = 0;
+  GeoPoint terrain_center = GeoPoint::Invalid();
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+
+    if (terrain != nullptr && basic.location_available &&
+        (!terrain_center.IsValid() ||
+         terrain_center.Distance(basic.location) > fixed(10000))) {
+      terrain_center = basic.location;
+      UpdateTerrain(*terrain, terrain_center);
+    }
+
+    glide_computer.ReadBlackboard(basic);
+
+    profiler.gps.Begin();
+    glide_computer.ProcessGPS();
+    profiler.gps.End();
+
+    if (++i == IDLE_INTERVAL) {
+      i = 0;
+      profiler.idle.Begin();
+      glide_computer.ProcessIdle();
+      profiler.idle.End();
+    }
+
+    ++n_fixes;
+  }
+
+  glide_computer.SetProfiler(nullptr);
+  delete replay;
+
+  printf("%u fixes\n\n", n_fixes);
+  profiler.Print();
+
+  delete terrain;
+  return EXIT_SUCCESS;
+}
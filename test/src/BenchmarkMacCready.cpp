@@ -0,0 +1,82 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compare MacCready::Solve() with MacCreadyBatch on a set of glides
+ * similar to the landables which are evaluated by the abort task.
+ */
+
+#include "GlideSolvers/MacCreadyBatch.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlideState.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/GlideResult.hpp"
+#include "OS/Clock.hpp"
+
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+
+  const GlidePolar polar(fixed(1.5));
+  const SpeedVector wind(Angle::Degrees(240), fixed(8));
+
+  /* random landables within 100 km, the aircraft at 1500m */
+  const unsigned n_tasks = 500;
+  std::vector<GlideState> tasks;
+  for (unsigned i = 0; i < n_tasks; ++i)
+    tasks.emplace_back(GeoVector(fixed(rand() % 100000),
+                                 Angle::Degrees(rand() % 360)),
+                       fixed(rand() % 800), fixed(1500), wind);
+
+  std::vector<GlideResult> results(n_tasks);
+  const MacCreadyBatch batch(settings, polar);
+
+  const unsigned n_iterations = 2000;
+  fixed sum_scalar = fixed(0), sum_batch = fixed(0);
+
+  uint64_t start = MonotonicClockUS();
+  for (unsigned j = 0; j < n_iterations; ++j)
+    for (unsigned i = 0; i < n_tasks; ++i)
+      sum_scalar += MacCready::Solve(settings, polar,
+                                     tasks[i]).altitude_difference;
+  const uint64_t scalar_time = MonotonicClockUS() - start;
+
+  start = MonotonicClockUS();
+  for (unsigned j = 0; j < n_iterations; ++j) {
+    batch.Solve(tasks.data(), results.data(), n_tasks);
+    for (unsigned i = 0; i < n_tasks; ++i)
+      sum_batch += results[i].altitude_difference;
+  }
+  const uint64_t batch_time = MonotonicClockUS() - start;
+
+  printf("%u glides: MacCready::Solve() %.3f ms, MacCreadyBatch %.3f ms\n",
+         n_tasks * n_iterations, scalar_time / 1000., batch_time / 1000.);
+
+  /* prevent gcc from optimizing the loops away */
+  return sum_scalar == sum_batch ? 0 : 1;
+}
@@ -23,10 +23,54 @@ Copyright_License {
 
 #include "Terrain/RasterTerrain.hpp"
 
+#include <stdlib.h>
+
+/* a map without any tiles; the heights are made up by GetHeight() */
+
+void
+RasterTileCache::Reset()
+{
+}
+
+void
+DecodedTileCache::Close()
+{
+}
+
+RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
+                     FileCache *cache, OperationEnvironment &operation)
+  :path(NULL)
+{
+}
+
+RasterMap::~RasterMap()
+{
+}
+
+/**
+ * A landscape which varies with the location, with a few lakes, and
+ * without data south of 60 degrees south.
+ */
 short
 RasterMap::GetHeight(const GeoPoint &location) const
 {
-  return RasterBuffer::TERRAIN_INVALID;
+  if (location.latitude < Angle::Degrees(-60))
+    return RasterBuffer::TERRAIN_INVALID;
+
+  const int x = iround(location.longitude.Degrees() * 10);
+  const int y = iround(location.latitude.Degrees() * 10);
+  const short h = abs(x * 7 + y * 13) % 3000;
+  return h < 100
+    ? RasterBuffer::TERRAIN_WATER_THRESHOLD
+    : h;
+}
+
+void
+RasterMap::GetHeights(const GeoPoint *locations, short *heights,
+                      unsigned n) const
+{
+  for (unsigned i = 0; i < n; ++i)
+    heights[i] = GetHeight(locations[i]);
 }
 
 GeoPoint
@@ -38,8 +38,9 @@ Copyright_License {
 
 int main(int argc, char **argv)
 {
-  Args args(argc, argv, "PATH");
+  Args args(argc, argv, "PATH [TILECACHE]");
   const char *map_path = args.ExpectNext();
+  const char *tile_cache_path = args.IsEmpty() ? NULL : args.GetNext();
   args.ExpectEnd();
 
   char jp2_path[4096];
@@ -57,6 +58,12 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  if (tile_cache_path != NULL &&
+      !rtc.OpenDecodedTiles(PathName(tile_cache_path), PathName(map_path))) {
+    fprintf(stderr, "OpenDecodedTiles failed\n");
+    return EXIT_FAILURE;
+  }
+
   GeoBounds bounds = rtc.GetBounds();
   printf("bounds = %f|%f - %f|%f\n",
          (double)bounds.GetWest().Degrees(),
@@ -25,6 +25,7 @@
 #include "Printing.hpp"
 #include "OS/Args.hpp"
 #include "DebugReplay.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #include <assert.h>
 #include <stdio.h>
@@ -162,6 +163,10 @@ int main(int argc, char **argv)
 
   args.ExpectEnd();
 
+  WorkerPool worker_pool(WorkerPool::GetDefaultThreadCount());
+  olc_plus.SetWorkerPool(&worker_pool);
+  xcontest.SetWorkerPool(&worker_pool);
+
   int result = TestOLC(*replay);
   delete replay;
   return result;
@@ -0,0 +1,131 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Task/Unordered/AlternateTask.hpp"
+#include "Task/TaskBehaviour.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "TestUtil.hpp"
+
+static const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+
+static void
+AddLandables(Waypoints &waypoints)
+{
+  for (unsigned i = 0; i < 300; ++i) {
+    const GeoVector vector(fixed(500 + 300 * i), Angle::Degrees(i * 37));
+
+    Waypoint waypoint(vector.EndPoint(center));
+    waypoint.type = i % 3 == 0
+      ? Waypoint::Type::AIRFIELD
+      : Waypoint::Type::OUTLANDING;
+    waypoint.elevation = fixed((i * 7) % 400);
+    waypoint.name = _T("Landable");
+    waypoints.Append(std::move(waypoint));
+  }
+
+  waypoints.Optimise();
+}
+
+static bool
+SameAlternates(const AlternateTask &a, const AlternateTask &b)
+{
+  if (a.TaskSize() != b.TaskSize() ||
+      a.GetActiveIndex() != b.GetActiveIndex() ||
+      a.HasReachableLandable() != b.HasReachableLandable())
+    return false;
+
+  for (unsigned i = 0; i < a.TaskSize(); ++i)
+    if (a.GetAlternate(i).GetWaypoint().id !=
+        b.GetAlternate(i).GetWaypoint().id)
+      return false;
+
+  const AlternateList &x = a.GetAlternates(), &y = b.GetAlternates();
+  if (x.size() != y.size())
+    return false;
+
+  for (unsigned i = 0; i < x.size(); ++i)
+    if (x[i].waypoint.id != y[i].waypoint.id ||
+        x[i].solution.altitude_difference != y[i].solution.altitude_difference ||
+        x[i].solution.time_elapsed != y[i].solution.time_elapsed)
+      return false;
+
+  return true;
+}
+
+/**
+ * The abort task must find the same alternates, whether the
+ * candidates are solved sequentially or on a #WorkerPool.
+ */
+static void
+TestParallel(const Waypoints &waypoints, fixed altitude, fixed mc,
+             fixed wind_speed)
+{
+  TaskBehaviour behaviour;
+  behaviour.SetDefaults();
+
+  AircraftState state;
+  state.Reset();
+  state.location = center;
+  state.altitude = altitude;
+  state.wind = SpeedVector(Angle::Degrees(250), wind_speed);
+  state.time = fixed(1000);
+
+  const GlidePolar polar(mc);
+  const GeoPoint destination =
+    GeoVector(fixed(50000), Angle::Degrees(90)).EndPoint(center);
+
+  AlternateTask sequential(behaviour, waypoints);
+  sequential.SetActive(false);
+  sequential.SetTaskDestination(destination);
+  sequential.Update(state, state, polar);
+
+  WorkerPool pool(2);
+  AlternateTask parallel(behaviour, waypoints);
+  parallel.SetActive(false);
+  parallel.SetWorkerPool(&pool);
+  parallel.SetTaskDestination(destination);
+  parallel.Update(state, state, polar);
+
+  ok1(sequential.TaskSize() > 0);
+  ok1(SameAlternates(sequential, parallel));
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(2 * 4);
+
+  Waypoints waypoints;
+  AddLandables(waypoints);
+
+  TestParallel(waypoints, fixed(1500), fixed(0), fixed(0));
+  TestParallel(waypoints, fixed(1500), fixed(2), fixed(10));
+  TestParallel(waypoints, fixed(600), fixed(1), fixed(5));
+  TestParallel(waypoints, fixed(3000), fixed(3), fixed(20));
+
+  return exit_status();
+}
@@ -0,0 +1,153 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/AirspaceCache.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "TestUtil.hpp"
+
+#include <tchar.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static bool
+ParseFile(const TCHAR *path, Airspaces &airspaces)
+{
+  FileLineReader reader(path, ConvertLineReader::AUTO);
+  if (reader.error())
+    return false;
+
+  AirspaceParser parser(airspaces);
+  NullOperationEnvironment operation;
+  return parser.Parse(reader, operation);
+}
+
+static bool
+Equals(const AirspaceAltitude &a, const AirspaceAltitude &b)
+{
+  return a.reference == b.reference && a.altitude == b.altitude &&
+    a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain;
+}
+
+static bool
+Equals(const AbstractAirspace &a, const AbstractAirspace &b)
+{
+  if (a.GetShape() != b.GetShape() ||
+      a.GetType() != b.GetType() ||
+      !a.GetDays().equals(b.GetDays()) ||
+      !Equals(a.GetBase(), b.GetBase()) ||
+      !Equals(a.GetTop(), b.GetTop()) ||
+      a.GetRadioText() != b.GetRadioText() ||
+      _tcscmp(a.GetName(), b.GetName()) != 0)
+    return false;
+
+  if (a.GetShape() == AbstractAirspace::Shape::CIRCLE)
+    return ((const AirspaceCircle &)a).GetRadius() ==
+      ((const AirspaceCircle &)b).GetRadius();
+
+  const SearchPointVector &pa = a.GetPoints(), &pb = b.GetPoints();
+  if (pa.size() != pb.size())
+    return false;
+
+  for (unsigned i = 0; i < pa.size(); ++i)
+    if (pa[i].GetLocation() != pb[i].GetLocation())
+      return false;
+
+  return true;
+}
+
+static void
+TestRoundTrip(const TCHAR *path)
+{
+  Airspaces original;
+  if (!ok1(ParseFile(path, original))) {
+    skip(3, 0, "Failed to parse input file");
+    return;
+  }
+
+  FILE *file = tmpfile();
+  ok1(SaveAirspaceCache(file, original));
+  rewind(file);
+
+  Airspaces loaded;
+  ok1(LoadAirspaceCache(file, loaded));
+  fclose(file);
+
+  const auto &a = original.GetPending(), &b = loaded.GetPending();
+  bool equal = a.size() == b.size();
+  for (unsigned i = 0; equal && i < a.size(); ++i)
+    equal = Equals(*a[i], *b[i]);
+
+  ok1(equal);
+}
+
+static void
+TestPartial()
+{
+  Airspaces original;
+  ParseFile(_T("test/data/airspace/openair.txt"), original);
+  const unsigned n = original.GetPending().size();
+  ParseFile(_T("test/data/airspace/tnp.sua"), original);
+
+  /* only the airspaces of the second file are saved */
+  FILE *file = tmpfile();
+  ok1(SaveAirspaceCache(file, original, n));
+  const long size = ftell(file);
+  rewind(file);
+
+  Airspaces loaded;
+  ok1(LoadAirspaceCache(file, loaded));
+  ok1(loaded.GetPending().size() + n == original.GetPending().size());
+  ok1(Equals(*loaded.GetPending().front(), *original.GetPending()[n]));
+  fclose(file);
+
+  /* a truncated file is rejected completely */
+  file = tmpfile();
+  SaveAirspaceCache(file, original, n);
+  fflush(file);
+  ok1(ftruncate(fileno(file), size - 1) == 0);
+  rewind(file);
+
+  Airspaces truncated;
+  ok1(!LoadAirspaceCache(file, truncated));
+  ok1(truncated.GetPending().empty());
+  fclose(file);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(3 * 4 + 7);
+
+  TestRoundTrip(_T("test/data/airspace/openair.txt"));
+  TestRoundTrip(_T("test/data/airspace/tnp.sua"));
+  TestRoundTrip(_T("test/data/AirspaceAus-DAA.txt"));
+  TestPartial();
+
+  return exit_status();
+}
@@ -30,6 +30,7 @@ Copyright_License {
 #include "Util/Macros.hpp"
 #include "IO/FileLineReader.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "TestUtil.hpp"
 
 #include <tchar.h>
@@ -275,12 +276,89 @@ TestTNP()
   }
 }
 
+static bool
+ParsePending(const TCHAR *path, Airspaces &airspaces, WorkerPool *pool)
+{
+  FileLineReader reader(path, ConvertLineReader::AUTO);
+  if (reader.error())
+    return false;
+
+  AirspaceParser parser(airspaces);
+  parser.SetWorkerPool(pool);
+  NullOperationEnvironment operation;
+  return parser.Parse(reader, operation);
+}
+
+static bool
+Equals(const AirspaceAltitude &a, const AirspaceAltitude &b)
+{
+  return a.reference == b.reference && a.altitude == b.altitude &&
+    a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain;
+}
+
+static bool
+Equals(const AbstractAirspace &a, const AbstractAirspace &b)
+{
+  if (a.GetShape() != b.GetShape() ||
+      a.GetType() != b.GetType() ||
+      !a.GetDays().equals(b.GetDays()) ||
+      !Equals(a.GetBase(), b.GetBase()) ||
+      !Equals(a.GetTop(), b.GetTop()) ||
+      a.GetRadioText() != b.GetRadioText() ||
+      _tcscmp(a.GetName(), b.GetName()) != 0)
+    return false;
+
+  if (a.GetShape() == AbstractAirspace::Shape::CIRCLE) {
+    const AirspaceCircle &ca = (const AirspaceCircle &)a;
+    const AirspaceCircle &cb = (const AirspaceCircle &)b;
+    return ca.GetRadius() == cb.GetRadius() &&
+      ca.GetCenter() == cb.GetCenter();
+  }
+
+  const SearchPointVector &pa = a.GetPoints(), &pb = b.GetPoints();
+  if (pa.size() != pb.size())
+    return false;
+
+  for (unsigned i = 0; i < pa.size(); ++i)
+    if (pa[i].GetLocation() != pb[i].GetLocation())
+      return false;
+
+  return true;
+}
+
+/**
+ * Parse the file with and without a #WorkerPool; both must yield the
+ * same airspaces in the same order.
+ */
+static void
+TestPooled(const TCHAR *path)
+{
+  Airspaces sequential, pooled;
+  ok1(ParsePending(path, sequential, nullptr));
+
+  WorkerPool pool(3);
+  ok1(ParsePending(path, pooled, &pool));
+
+  const auto &a = sequential.GetPending(), &b = pooled.GetPending();
+  ok1(!a.empty() && a.size() == b.size());
+
+  bool equal = a.size() == b.size();
+  for (unsigned i = 0; equal && i < a.size(); ++i)
+    equal = Equals(*a[i], *b[i]);
+
+  ok1(equal);
+}
+
 int main(int argc, char **argv)
 {
-  plan_tests(104);
+  plan_tests(104 + 2 * 4);
 
   TestOpenAir();
   TestTNP();
 
+  TestPooled(_T("test/data/airspace/openair.txt"));
+  TestPooled(_T("test/data/airspace/tnp.sua"));
+
   return exit_status();
 }
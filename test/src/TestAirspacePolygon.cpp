@@ -0,0 +1,216 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/AirspacePolygon.hpp"
+#include "Airspace/AirspaceIntersectSort.hpp"
+#include "Airspace/AirspaceIntersectionVector.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <stdlib.h>
+
+static const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+
+gcc_pure
+static fixed
+Random(fixed min, fixed max)
+{
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+/**
+ * A concave polygon with random vertices around #center.
+ */
+static std::vector<GeoPoint>
+MakeStar(unsigned n)
+{
+  std::vector<GeoPoint> points;
+  for (unsigned i = 0; i < n; ++i) {
+    const Angle a = Angle::FullCircle() * i / n;
+    const fixed r = Random(fixed(0.05), fixed(0.6));
+    points.emplace_back(center.longitude + Angle::Degrees(r * a.cos()),
+                        center.latitude + Angle::Degrees(r * a.sin()));
+  }
+
+  return points;
+}
+
+/**
+ * A comb with long teeth pointing north; its edges span many bands.
+ */
+static std::vector<GeoPoint>
+MakeComb(unsigned n_teeth)
+{
+  std::vector<GeoPoint> points;
+  for (unsigned i = 0; i < n_teeth; ++i) {
+    const Angle left = center.longitude + Angle::Degrees(fixed(0.02) * i);
+    const Angle right = left + Angle::Degrees(0.01);
+    points.emplace_back(left, center.latitude + Angle::Degrees(0.1));
+    points.emplace_back(left, center.latitude + Angle::Degrees(0.5));
+    points.emplace_back(right, center.latitude + Angle::Degrees(0.5));
+    points.emplace_back(right, center.latitude + Angle::Degrees(0.1));
+  }
+
+  const Angle east = center.longitude + Angle::Degrees(fixed(0.02) * n_teeth);
+  points.emplace_back(east, center.latitude + Angle::Degrees(0.1));
+  points.emplace_back(east, center.latitude);
+  points.emplace_back(center.longitude, center.latitude);
+  return points;
+}
+
+/**
+ * The linear search which is used for polygons without an index.
+ */
+static AirspaceIntersectionVector
+LinearIntersects(const AirspacePolygon &airspace,
+                 const GeoPoint &start, const GeoPoint &end,
+                 const TaskProjection &projection)
+{
+  const FlatRay ray(projection.ProjectInteger(start),
+                    projection.ProjectInteger(end));
+
+  AirspaceIntersectSort sorter(start, airspace);
+
+  const SearchPointVector &border = airspace.GetPoints();
+  for (auto it = border.begin(); it + 1 != border.end(); ++it) {
+    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+    fixed t = ray.DistinctIntersection(r_seg);
+    if (!negative(t))
+      sorter.add(t, projection.Unproject(ray.Parametric(t)));
+  }
+
+  return sorter.all();
+}
+
+gcc_pure
+static bool
+Equals(const AirspaceIntersectionVector &a,
+       const AirspaceIntersectionVector &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (unsigned i = 0; i < a.size(); ++i)
+    if (a[i].first != b[i].first || a[i].second != b[i].second)
+      return false;
+
+  return true;
+}
+
+/**
+ * Compare the indexed Inside() and Intersects() with a search of all
+ * border edges.  Besides random locations, the query points include
+ * the vertices, points on the edges and points on the band
+ * boundaries of the index.
+ */
+static void
+TestPolygon(const std::vector<GeoPoint> &points)
+{
+  AirspacePolygon airspace(points);
+
+  TaskProjection projection;
+  projection.Reset(points.front());
+  for (const GeoPoint &p : points)
+    projection.Scan(p);
+  projection.Update();
+  airspace.GetBoundingBox(projection);
+
+  const SearchPointVector &border = airspace.GetPoints();
+  const GeoBounds bounds = border.CalculateGeoBounds();
+  const Angle west = bounds.GetWest(), east = bounds.GetEast();
+  const Angle south = bounds.GetSouth(), north = bounds.GetNorth();
+  const Angle margin_x = (east - west) / 10, margin_y = (north - south) / 10;
+
+  std::vector<GeoPoint> queries;
+  for (unsigned i = 0; i < 2000; ++i)
+    queries.emplace_back(Angle::Native(Random((west - margin_x).Native(),
+                                              (east + margin_x).Native())),
+                         Angle::Native(Random((south - margin_y).Native(),
+                                              (north + margin_y).Native())));
+
+  for (auto it = border.begin(); it + 1 != border.end(); ++it) {
+    const GeoPoint &a = it->GetLocation(), &b = (it + 1)->GetLocation();
+    queries.push_back(a);
+    queries.push_back(a.Interpolate(b, fixed(0.5)));
+    queries.push_back(a.Interpolate(b, Random(fixed(0), fixed(1))));
+  }
+
+  /* see EdgeBandIndex::Build() */
+  const unsigned n_bands = std::max(unsigned(border.size() - 1) / 4, 1u);
+  for (unsigned i = 0; i <= n_bands; ++i) {
+    const Angle latitude = south + (north - south) * i / n_bands;
+    queries.emplace_back(west, latitude);
+    queries.emplace_back(Angle::Native(Random(west.Native(), east.Native())),
+                         latitude);
+  }
+
+  bool inside_equal = true;
+  for (const GeoPoint &p : queries)
+    if (airspace.Inside(p) != border.IsInside(p))
+      inside_equal = false;
+
+  ok1(inside_equal);
+
+  bool intersects_equal = true;
+  const auto Check = [&](const GeoPoint &start, const GeoPoint &end) {
+    if (!Equals(airspace.Intersects(start, end, projection),
+                LinearIntersects(airspace, start, end, projection)))
+      intersects_equal = false;
+  };
+
+  const unsigned n_queries = queries.size();
+  const unsigned step = std::max(n_queries / 500, 1u);
+  for (unsigned i = 0; i < n_queries; i += step)
+    Check(queries[i], queries[(i * 7919) % n_queries]);
+
+  /* rays along the edges and along the band boundaries */
+  for (unsigned i = 0; i + 1 < border.size(); i += step)
+    Check(border[i].GetLocation(), border[i + 1].GetLocation());
+
+  for (unsigned i = 0; i <= n_bands; ++i) {
+    const Angle latitude = south + (north - south) * i / n_bands;
+    Check(GeoPoint(west - margin_x, latitude),
+          GeoPoint(east + margin_x, latitude));
+  }
+
+  ok1(intersects_equal);
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(8);
+
+  srand(42);
+
+  TestPolygon(MakeStar(32));
+  TestPolygon(MakeStar(500));
+  TestPolygon(MakeStar(1000));
+  TestPolygon(MakeComb(64));
+
+  return exit_status();
+}
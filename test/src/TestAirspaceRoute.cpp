@@ -0,0 +1,140 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Route/AirspaceRoute.hpp"
+#include "Route/Config.hpp"
+#include "Airspace/AirspaceCircle.hpp"
+#include "Airspace/Predicate/AirspacePredicate.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "TestUtil.hpp"
+
+static const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+
+static void
+SetupAirspaces(Airspaces &airspaces)
+{
+  AirspaceAltitude base, top;
+  base.reference = top.reference = AltitudeReference::MSL;
+  base.altitude = fixed(0);
+  top.altitude = fixed(5000);
+
+  AbstractAirspace *as = new AirspaceCircle(center, fixed(5000));
+  as->SetProperties(_T("test"), AirspaceClass::CLASSC, base, top);
+  airspaces.Add(as);
+  airspaces.Optimise();
+}
+
+static void
+InitRoute(AirspaceRoute &route)
+{
+  const GlidePolar polar(fixed(1));
+  GlideSettings settings;
+  settings.SetDefaults();
+  route.UpdatePolar(settings, polar, polar,
+                    SpeedVector(Angle::Zero(), fixed(0)));
+}
+
+gcc_pure
+static fixed
+GetLength(const Route &route)
+{
+  fixed length = fixed(0);
+  for (auto i = route.begin(), end = route.end(); i + 1 != end; ++i)
+    length += i->Distance(*(i + 1));
+  return length;
+}
+
+/**
+ * Does the route keep clear of the airspace?  The flat projection
+ * used by the route planner has a resolution of about 100m, so allow
+ * a small margin.
+ */
+gcc_pure
+static bool
+IsClear(const Route &route)
+{
+  for (auto i = route.begin(), end = route.end(); i + 1 != end; ++i)
+    for (unsigned j = 0; j <= 10; ++j)
+      if (i->Interpolate(*(i + 1), fixed(j) / 10).Distance(center) <
+          fixed(4800))
+        return false;
+  return true;
+}
+
+/**
+ * Move the aircraft (the destination of the search) a little at a
+ * time.  A route planner which may reuse its previous solution must
+ * find routes which are as good as those of a new route planner.
+ */
+static void
+TestMovingDestination(const Airspaces &airspaces)
+{
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.mode = RoutePlannerConfig::Mode::AIRSPACE;
+
+  const AGeoPoint origin(GeoVector(fixed(10000), Angle::Degrees(270))
+                         .EndPoint(center), RoughAltitude(2000));
+
+  AirspaceRoute route;
+  InitRoute(route);
+
+  for (unsigned i = 0; i < 10; ++i) {
+    const AGeoPoint destination(GeoVector(fixed(10000 - 200 * i),
+                                          Angle::Degrees(80))
+                                .EndPoint(center), RoughAltitude(2000));
+
+    route.Synchronise(airspaces, AirspacePredicate::always_true,
+                      origin, destination);
+    ok1(route.Solve(origin, destination, config));
+
+    AirspaceRoute fresh;
+    InitRoute(fresh);
+    fresh.Synchronise(airspaces, AirspacePredicate::always_true,
+                      origin, destination);
+    ok1(fresh.Solve(origin, destination, config));
+
+    const Route &a = route.GetSolution(), &b = fresh.GetSolution();
+    ok1(a.size() >= 3);
+    ok1(a.front().Distance(origin) < fixed(1) &&
+        a.back().Distance(destination) < fixed(1));
+    ok1(IsClear(a));
+    ok1(fabs(GetLength(a) - GetLength(b)) < GetLength(b) / 100);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(10 * 6);
+
+  Airspaces airspaces;
+  SetupAirspaces(airspaces);
+
+  TestMovingDestination(airspaces);
+
+  return exit_status();
+}
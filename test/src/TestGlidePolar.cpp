@@ -22,8 +22,11 @@
 
 #include "TestUtil.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/GlideResult.hpp"
+#include "Navigation/Aircraft.hpp"
 #include "Units/System.hpp"
 
+#include <algorithm>
 #include <cstdio>
 
 class GlidePolarTest
@@ -39,6 +42,9 @@ private:
   void TestBallast();
   void TestBugs();
   void TestMC();
+  void TestSpeedToFly();
+
+  fixed MaxSpeedToFlyError(bool block_stf) const;
 };
 
 void
@@ -163,6 +169,75 @@ GlidePolarTest::TestMC()
   ok1(equals(polar.GetVBestLD(), 25.830434162));
 }
 
+/**
+ * Returns the largest difference between the tabulated speed to fly
+ * and the one found by the direct search, over a range of MacCready
+ * settings and netto vario values.
+ */
+fixed
+GlidePolarTest::MaxSpeedToFlyError(bool block_stf) const
+{
+  GlidePolar gp = polar;
+
+  AircraftState state;
+  state.g_load = fixed(1);
+
+  GlideResult solution;
+  solution.Reset();
+
+  fixed max_error(0);
+  for (unsigned i = 0; i <= 50; ++i) {
+    gp.SetMC(fixed(i) / 10);
+
+    for (int j = -30; j <= 30; ++j) {
+      state.netto_vario = fixed(j) / 10;
+
+      const fixed m = gp.mc + (block_stf ? fixed(0) : -state.netto_vario);
+      const fixed v = gp.SpeedToFly(state, solution, block_stf);
+      const fixed v_solve = std::max(gp.Vmin,
+                                     gp.SolveSpeedToFly(m, fixed(0),
+                                                        gp.Vmax));
+      if (!block_stf && state.netto_vario > gp.mc + gp.Smin)
+        continue;
+
+      max_error = std::max(max_error, fabs(v - v_solve));
+    }
+  }
+
+  return max_error;
+}
+
+void
+GlidePolarTest::TestSpeedToFly()
+{
+  polar.SetMC(fixed(0));
+  polar.Update();
+
+  // still air speed to fly of a parabolic polar: V = sqrt((c + m) / a)
+  for (unsigned i = 0; i <= 4; ++i) {
+    const fixed m = fixed(i) + fixed(0.3);
+    const fixed v = polar.LookupSpeedToFly(m);
+    const fixed v_exact = std::min(polar.Vmax,
+                                   sqrt((polar.polar.c + m) / polar.polar.a));
+    ok1(fabs(v - v_exact) < fixed(0.02));
+  }
+
+  ok1(MaxSpeedToFlyError(true) < fixed(0.02));
+  ok1(MaxSpeedToFlyError(false) < fixed(0.02));
+
+  // outside of the table, the direct search is used
+  ok1(negative(polar.LookupSpeedToFly(-polar.Smin - fixed(0.1))));
+  ok1(negative(polar.LookupSpeedToFly(fixed(20))));
+
+  // the table follows bugs and ballast
+  polar.SetBugs(fixed(0.8));
+  polar.SetBallastLitres(fixed(80));
+  ok1(MaxSpeedToFlyError(false) < fixed(0.02));
+
+  polar.SetBallast(fixed(0));
+  polar.SetBugs(fixed(1));
+}
+
 void
 GlidePolarTest::Run()
 {
@@ -171,11 +246,12 @@ GlidePolarTest::Run()
   TestBallast();
   TestBugs();
   TestMC();
+  TestSpeedToFly();
 }
 
 int main(int argc, char **argv)
 {
-  plan_tests(46);
+  plan_tests(56);
 
   GlidePolarTest test;
   test.Run();
@@ -0,0 +1,131 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "GlideSolvers/MacCreadyBatch.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlideState.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/GlideResult.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <algorithm>
+
+static void
+AddTasks(std::vector<GlideState> &tasks, const SpeedVector wind)
+{
+  for (unsigned distance = 0; distance <= 150000; distance += 7500)
+    for (int height = -1000; height <= 2000; height += 150)
+      for (unsigned bearing = 0; bearing < 360; bearing += 45)
+        tasks.emplace_back(GeoVector(fixed(distance),
+                                     Angle::Degrees(bearing)),
+                           fixed(300), fixed(300 + height), wind);
+}
+
+/**
+ * Compare two values.  The compiler may reorder the floating point
+ * operations of the scalar and the batch solver differently (with
+ * -ffast-math), so allow for rounding errors.
+ */
+gcc_const
+static bool
+Close(fixed a, fixed b)
+{
+  return fabs(a - b) <= fixed(1e-6) * std::max(fixed(1), fabs(a));
+}
+
+gcc_pure
+static bool
+Equals(const GlideResult &a, const GlideResult &b)
+{
+  if (a.validity != b.validity)
+    return false;
+
+  if (!a.IsOk())
+    return true;
+
+  return Close(a.vector.distance, b.vector.distance) &&
+    a.vector.bearing == b.vector.bearing &&
+    a.v_opt == b.v_opt &&
+    a.head_wind == b.head_wind &&
+    Close(a.min_arrival_altitude, b.min_arrival_altitude) &&
+    Close(a.pure_glide_height, b.pure_glide_height) &&
+    Close(a.pure_glide_altitude_difference,
+          b.pure_glide_altitude_difference) &&
+    Close(a.height_climb, b.height_climb) &&
+    Close(a.height_glide, b.height_glide) &&
+    Close(a.time_elapsed, b.time_elapsed) &&
+    Close(a.time_virtual, b.time_virtual) &&
+    Close(a.altitude_difference, b.altitude_difference) &&
+    Close(a.effective_wind_speed, b.effective_wind_speed) &&
+    a.effective_wind_angle == b.effective_wind_angle;
+}
+
+/**
+ * The batch solver must return the results of the scalar solver.
+ */
+static void
+TestBatch(fixed mc, fixed cruise_efficiency, const SpeedVector wind)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+
+  GlidePolar polar(mc);
+  polar.SetCruiseEfficiency(cruise_efficiency);
+
+  std::vector<GlideState> tasks;
+  AddTasks(tasks, wind);
+
+  std::vector<GlideResult> results(tasks.size());
+  MacCreadyBatch(settings, polar).Solve(tasks.data(), results.data(),
+                                        tasks.size());
+
+  unsigned n_ok = 0, n_different = 0;
+  for (unsigned i = 0; i < tasks.size(); ++i) {
+    const GlideResult expected = MacCready::Solve(settings, polar, tasks[i]);
+    if (expected.IsOk())
+      ++n_ok;
+    if (!Equals(expected, results[i]))
+      ++n_different;
+  }
+
+  ok1(n_ok > 0);
+  ok1(n_different == 0);
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(2 * 8);
+
+  TestBatch(fixed(0), fixed(1), SpeedVector::Zero());
+  TestBatch(fixed(1), fixed(1), SpeedVector::Zero());
+  TestBatch(fixed(2), fixed(0.8), SpeedVector::Zero());
+  TestBatch(fixed(1), fixed(1), SpeedVector(Angle::Degrees(30), fixed(8)));
+  TestBatch(fixed(3), fixed(1.1), SpeedVector(Angle::Degrees(200), fixed(15)));
+  TestBatch(fixed(0), fixed(1), SpeedVector(Angle::Degrees(90), fixed(12)));
+  TestBatch(fixed(2), fixed(1), SpeedVector(Angle::Degrees(300), fixed(40)));
+  TestBatch(fixed(5), fixed(1), SpeedVector(Angle::Degrees(0), fixed(25)));
+
+  return exit_status();
+}
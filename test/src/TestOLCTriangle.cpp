@@ -0,0 +1,128 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Contest/Solvers/OLCTriangle.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IO/FileLineReader.hpp"
+#include "TestUtil.hpp"
+
+#include <stdio.h>
+
+/**
+ * Gives access to the flat distance of the best triangle, which is
+ * exact and therefore suitable for comparing two solvers.
+ */
+class TestTriangle : public OLCTriangle {
+public:
+  TestTriangle(const Trace &trace, bool is_fai)
+    :OLCTriangle(trace, is_fai, false) {}
+
+  unsigned GetBestFlatDistance() const {
+    return best_d;
+  }
+};
+
+/**
+ * Replay the flight and compare the incremental solver with a full
+ * solve from scratch after each new trace point.
+ */
+static bool
+TestReplay(const char *filename, bool is_fai)
+{
+  FileLineReaderA reader(filename);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open %s\n", filename);
+    return false;
+  }
+
+  /* a small trace, so it gets thinned often; only after thinning,
+     the average time and distance deltas are known, which allow the
+     solver to take the incremental path when few points have been
+     added */
+  Trace trace(0, Trace::null_time, 128);
+
+  TestTriangle incremental(trace, is_fai);
+  incremental.SetIncremental(true);
+
+  incremental.Reset();
+
+  TestTriangle full(trace, is_fai);
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  unsigned n_compared = 0, n_triangles = 0;
+  bool success = true;
+
+  char *line;
+  while ((line = reader.ReadLine()) != NULL) {
+    IGCFix fix;
+    if (!IGCParseFix(line, extensions, fix) || !fix.gps_valid)
+      continue;
+
+    const TracePoint point(fix.location, fix.time.GetSecondOfDay(),
+                           fixed(fix.gps_altitude), fixed(0), 0);
+    const unsigned old_size = trace.size();
+    trace.push_back(point);
+    if (trace.size() == old_size || trace.size() < 3)
+      continue;
+
+    incremental.Solve(false);
+
+    full.Reset();
+    full.Solve(true);
+
+    ++n_compared;
+    if (full.GetBestFlatDistance() > 0)
+      ++n_triangles;
+
+    if (incremental.GetBestFlatDistance() != full.GetBestFlatDistance()) {
+      fprintf(stderr, "%s: mismatch after %u points: %u != %u\n",
+              filename, trace.size(),
+              incremental.GetBestFlatDistance(),
+              full.GetBestFlatDistance());
+      success = false;
+    }
+  }
+
+  printf("# %s: %u points compared, %u with a triangle\n",
+         filename, n_compared, n_triangles);
+
+  /* make sure the test has actually seen some triangles */
+  return success && n_triangles > 0;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(4);
+
+  ok1(TestReplay("test/data/0asljd01.igc", false));
+  ok1(TestReplay("test/data/0asljd01.igc", true));
+  ok1(TestReplay("test/data/9crx3101.igc", false));
+  ok1(TestReplay("test/data/9crx3101.igc", true));
+
+  return exit_status();
+}
@@ -0,0 +1,202 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Util/RTree.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <stdlib.h>
+
+struct Box {
+  unsigned id;
+  int min_x, min_y, max_x, max_y;
+
+  bool operator==(const Box &other) const {
+    return id == other.id;
+  }
+};
+
+struct BoxAccessor {
+  int GetMinX(const Box &box) const {
+    return box.min_x;
+  }
+
+  int GetMinY(const Box &box) const {
+    return box.min_y;
+  }
+
+  int GetMaxX(const Box &box) const {
+    return box.max_x;
+  }
+
+  int GetMaxY(const Box &box) const {
+    return box.max_y;
+  }
+};
+
+typedef RTree<Box, BoxAccessor> BoxTree;
+
+static unsigned next_id;
+
+static Box
+RandomBox()
+{
+  Box box;
+  box.id = next_id++;
+  box.min_x = rand() % 100000 - 50000;
+  box.min_y = rand() % 100000 - 50000;
+  box.max_x = box.min_x + rand() % 5000;
+  box.max_y = box.min_y + rand() % 5000;
+  return box;
+}
+
+static BoxTree::Rectangle
+RandomRectangle()
+{
+  const Box box = RandomBox();
+  return BoxTree::Rectangle(box.min_x, box.min_y, box.max_x, box.max_y);
+}
+
+struct CountVisitor {
+  unsigned count;
+  unsigned long long id_sum;
+
+  CountVisitor():count(0), id_sum(0) {}
+
+  void operator()(const Box &box) {
+    ++count;
+    id_sum += box.id;
+  }
+};
+
+struct IsOdd {
+  bool operator()(const Box &box) const {
+    return box.id % 2 == 1;
+  }
+};
+
+/**
+ * Compare all queries with a linear search over #boxes.
+ */
+static bool
+CheckQueries(const BoxTree &tree, const std::vector<Box> &boxes)
+{
+  if (tree.size() != boxes.size())
+    return false;
+
+  unsigned n = 0;
+  for (gcc_unused const Box &box : tree)
+    ++n;
+  if (n != boxes.size())
+    return false;
+
+  for (unsigned i = 0; i < 200; ++i) {
+    const BoxTree::Rectangle r = RandomRectangle();
+
+    CountVisitor expected, actual;
+    for (const Box &box : boxes)
+      if (BoxTree::GetBounds(box).Overlaps(r))
+        expected(box);
+
+    tree.VisitOverlapping(r, actual);
+    if (actual.count != expected.count || actual.id_sum != expected.id_sum)
+      return false;
+
+    const unsigned range = 10000;
+    BoxTree::distance_type expected_distance = BoxTree::Square(range);
+    bool expected_found = false;
+    for (const Box &box : boxes) {
+      const auto distance = BoxTree::GetBounds(box).SquareDistanceTo(r);
+      if (IsOdd()(box) && distance <= expected_distance) {
+        expected_distance = distance;
+        expected_found = true;
+      }
+    }
+
+    const Box *nearest = tree.FindNearestIf(r, range, IsOdd());
+    if (expected_found != (nearest != nullptr))
+      return false;
+
+    if (nearest != nullptr &&
+        (!IsOdd()(*nearest) ||
+         BoxTree::GetBounds(*nearest).SquareDistanceTo(r) != expected_distance))
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(6);
+
+  BoxTree tree;
+  ok1(tree.IsEmpty());
+
+  /* bulk load */
+  std::vector<Box> boxes;
+  for (unsigned i = 0; i < 2000; ++i)
+    boxes.push_back(RandomBox());
+
+  tree.Load(boxes.begin(), boxes.end());
+  ok1(CheckQueries(tree, boxes));
+
+  /* incremental insert */
+  for (unsigned i = 0; i < 1000; ++i) {
+    boxes.push_back(RandomBox());
+    tree.Add(boxes.back());
+  }
+
+  ok1(CheckQueries(tree, boxes));
+
+  /* remove */
+  bool removed = true;
+  for (unsigned i = 0; i < 1500 && removed; ++i) {
+    const unsigned j = rand() % boxes.size();
+    removed = tree.Remove(boxes[j]);
+    if (removed)
+      boxes.erase(boxes.begin() + j);
+  }
+
+  ok1(removed && CheckQueries(tree, boxes));
+
+  /* incremental insert into an empty tree */
+  BoxTree tree2;
+  std::vector<Box> boxes2;
+  for (unsigned i = 0; i < 500; ++i) {
+    boxes2.push_back(RandomBox());
+    tree2.Add(boxes2.back());
+  }
+
+  ok1(CheckQueries(tree2, boxes2));
+
+  while (!boxes2.empty()) {
+    if (!tree2.Remove(boxes2.back()))
+      break;
+    boxes2.pop_back();
+  }
+
+  ok1(tree2.IsEmpty());
+
+  return exit_status();
+}
@@ -0,0 +1,244 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterBuffer.hpp"
+#include "Terrain/BilinearBatch.hpp"
+#include "Util/Clamp.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static constexpr unsigned N = 1000;
+
+/**
+ * Compare BilinearInterpolate() with the portable formula, including
+ * extreme heights and fractions.
+ */
+static void
+TestKernel()
+{
+  static short a[N], b[N], c[N], d[N], ix[N], iy[N], result[N];
+
+  for (unsigned i = 0; i < N; ++i) {
+    a[i] = rand() - RAND_MAX / 2;
+    b[i] = i % 7 == 0 ? 32767 : rand() % 4000;
+    c[i] = i % 11 == 0 ? -32768 : rand() % 4000 - 2000;
+    d[i] = rand();
+    ix[i] = i % 5 == 0 ? 0 : rand() % 0x100;
+    iy[i] = i % 3 == 0 ? 0xff : rand() % 0x100;
+  }
+
+  /* an odd length to exercise the portable remainder */
+  BilinearInterpolate(a, b, c, d, ix, iy, result, N - 3);
+
+  bool equal = true;
+  for (unsigned i = 0; i < N - 3; ++i) {
+    const unsigned kx = 0x100 - ix[i], ky = 0x100 - iy[i];
+    const short expected = (a[i] * kx * ky + b[i] * ix[i] * ky +
+                            c[i] * kx * iy[i] + d[i] * ix[i] * iy[i]) >> 16;
+    if (result[i] != expected)
+      equal = false;
+  }
+
+  ok1(equal);
+}
+
+/**
+ * Compare the batch methods of #RasterBuffer with the single sample
+ * methods, including edges, special values and locations out of
+ * range.
+ */
+static void
+TestBuffer()
+{
+  RasterBuffer buffer(37, 23);
+  short *data = buffer.GetData();
+  for (unsigned i = 0; i < 37 * 23; ++i)
+    data[i] = i % 29 == 0
+      ? RasterBuffer::TERRAIN_WATER_THRESHOLD
+      : rand() % 3000 - 100;
+
+  static unsigned lx[N], ly[N];
+  static short single[N], batched[N];
+
+  for (unsigned i = 0; i < N; ++i) {
+    lx[i] = rand() % (40 << 8);
+    ly[i] = rand() % (25 << 8);
+
+    if (i % 13 == 0)
+      /* the last column */
+      lx[i] = (36 << 8) | (lx[i] & 0xff);
+
+    single[i] = buffer.GetInterpolated(lx[i], ly[i]);
+  }
+
+  BilinearBatch batch;
+  for (unsigned i = 0; i < N;) {
+    const unsigned start = i;
+    for (; i < N && !batch.IsFull(); ++i)
+      buffer.GetInterpolated(lx[i], ly[i], batch);
+    batch.Flush(batched + start);
+  }
+
+  bool equal = true;
+  for (unsigned i = 0; i < N; ++i)
+    if (batched[i] != single[i])
+      equal = false;
+
+  ok1(equal);
+}
+
+/**
+ * Compare RasterBuffer::ScanLine() with the single sample methods at
+ * the positions "a + (i * delta) / (size - 1)".
+ */
+static void
+TestScanLine(const RasterBuffer &buffer, bool interpolate, bool horizontal)
+{
+  static constexpr unsigned SIZE = 150;
+  short result[SIZE];
+
+  bool equal = true;
+  for (unsigned n = 0; n < 50; ++n) {
+    /* short lines are interpolated, long lines are not */
+    const unsigned range = interpolate ? (30 << 8) : buffer.GetFineWidth();
+    const unsigned ax = rand() % range, bx = rand() % range;
+    const unsigned ay = rand() % buffer.GetFineHeight();
+    const unsigned by = horizontal ? ay : rand() % buffer.GetFineHeight();
+    if (horizontal && !interpolate && bx > ax)
+      /* that is a different code path */
+      continue;
+
+    buffer.ScanLine(ax, ay, bx, by, result, SIZE, interpolate);
+
+    for (unsigned i = 0; i < SIZE; ++i) {
+      const unsigned x = ax + (int64_t)i * ((int)bx - (int)ax) / (SIZE - 1);
+      const unsigned y = ay + (int64_t)i * ((int)by - (int)ay) / (SIZE - 1);
+      const short expected = interpolate
+        ? buffer.GetInterpolated(x, y)
+        : buffer.Get(x >> 8, y >> 8);
+      if (result[i] != expected)
+        equal = false;
+    }
+  }
+
+  ok1(equal);
+}
+
+static void
+TestScanLine()
+{
+  RasterBuffer buffer(300, 200);
+  short *data = buffer.GetData();
+  for (unsigned i = 0; i < 300 * 200; ++i)
+    data[i] = i % 31 == 0
+      ? RasterBuffer::TERRAIN_WATER_THRESHOLD
+      : rand() % 3000 - 100;
+
+  TestScanLine(buffer, true, true);
+  TestScanLine(buffer, true, false);
+  TestScanLine(buffer, false, true);
+  TestScanLine(buffer, false, false);
+}
+
+/**
+ * Compare RasterBuffer::ScanSteps() with the single sample methods at
+ * the positions "(x, y) + i * (dx, dy)", and check that scanning a
+ * part of the line gives the same samples.
+ */
+static void
+TestScanSteps(const RasterBuffer &buffer, bool interpolate, bool horizontal)
+{
+  static constexpr unsigned SIZE = 150, FRACTION_BITS = 32;
+  static constexpr unsigned FINE_SHIFT = FRACTION_BITS - 8;
+  short result[SIZE], part[SIZE];
+
+  bool equal = true;
+  for (unsigned n = 0; n < 50; ++n) {
+    /* short steps are interpolated, long steps are not */
+    const unsigned range = interpolate ? (30 << 8) : buffer.GetFineWidth();
+    const unsigned ax = rand() % buffer.GetFineWidth();
+    const unsigned ay = rand() % buffer.GetFineHeight();
+    const unsigned bx = Clamp(int(ax + rand() % range - range / 2),
+                              0, int(buffer.GetFineWidth() - 1));
+    const unsigned by = horizontal ? ay : rand() % buffer.GetFineHeight();
+
+    const int64_t x = int64_t(ax) << FINE_SHIFT;
+    const int64_t y = int64_t(ay) << FINE_SHIFT;
+    const int64_t dx = ((int64_t(bx) << FINE_SHIFT) - x) / SIZE;
+    const int64_t dy = ((int64_t(by) << FINE_SHIFT) - y) / SIZE;
+
+    buffer.ScanSteps(x, y, dx, dy, FRACTION_BITS,
+                     result, SIZE, interpolate);
+
+    for (unsigned i = 0; i < SIZE; ++i) {
+      const unsigned sx = unsigned((x + i * dx) >> FINE_SHIFT);
+      const unsigned sy = unsigned((y + i * dy) >> FINE_SHIFT);
+      const short expected = interpolate
+        ? buffer.GetInterpolated(sx, sy)
+        : buffer.Get(sx >> 8, sy >> 8);
+      if (result[i] != expected)
+        equal = false;
+    }
+
+    const unsigned first = rand() % SIZE;
+    const unsigned size = 1 + rand() % (SIZE - first);
+    buffer.ScanSteps(x + first * dx, y + first * dy, dx, dy, FRACTION_BITS,
+                     part, size, interpolate);
+    if (!std::equal(part, part + size, result + first))
+      equal = false;
+  }
+
+  ok1(equal);
+}
+
+static void
+TestScanSteps()
+{
+  RasterBuffer buffer(300, 200);
+  short *data = buffer.GetData();
+  for (unsigned i = 0; i < 300 * 200; ++i)
+    data[i] = i % 31 == 0
+      ? RasterBuffer::TERRAIN_WATER_THRESHOLD
+      : rand() % 3000 - 100;
+
+  TestScanSteps(buffer, true, true);
+  TestScanSteps(buffer, true, false);
+  TestScanSteps(buffer, false, true);
+  TestScanSteps(buffer, false, false);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(10);
+
+  TestKernel();
+  TestBuffer();
+  TestScanLine();
+  TestScanSteps();
+
+  return exit_status();
+}
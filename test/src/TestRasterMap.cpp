@@ -0,0 +1,93 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterMap.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Operation/Operation.hpp"
+#include "Compatibility/path.h"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+/**
+ * The batched terrain lookups must return exactly the same heights
+ * as one lookup per location.
+ */
+static void
+TestHeights(const RasterMap &map)
+{
+  const GeoBounds bounds = map.GetBounds();
+  const GeoPoint center = bounds.GetCenter();
+
+  /* a spiral reaching beyond the map, so the batch contains both
+     consecutive locations in the same tile and jumps between tiles
+     (and locations without terrain) */
+  std::vector<GeoPoint> locations;
+  for (unsigned i = 0; i < 20000; ++i)
+    locations.push_back(GeoVector(fixed(i * 15),
+                                  Angle::Degrees(fixed(i) * 7.3))
+                        .EndPoint(center));
+
+  std::vector<short> heights(locations.size());
+  map.GetHeights(locations.data(), heights.data(), locations.size());
+
+  bool equal = true, valid = false;
+  for (unsigned i = 0; i < locations.size(); ++i) {
+    if (heights[i] != map.GetHeight(locations[i]))
+      equal = false;
+    if (!RasterBuffer::IsInvalid(heights[i]))
+      valid = true;
+  }
+
+  ok1(valid);
+  ok1(equal);
+
+  map.GetInterpolatedHeights(locations.data(), heights.data(),
+                             locations.size());
+
+  equal = true;
+  for (unsigned i = 0; i < locations.size(); ++i)
+    if (heights[i] != map.GetInterpolatedHeight(locations[i]))
+      equal = false;
+
+  ok1(equal);
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(3);
+
+  NullOperationEnvironment operation;
+  RasterMap map(_T("test/data/benalla9.xcm") _T(DIR_SEPARATOR_S) _T("terrain.jp2"),
+                _T("test/data/benalla9.xcm") _T(DIR_SEPARATOR_S) _T("terrain.j2w"),
+                NULL, operation);
+  do {
+    map.SetViewCenter(map.GetMapCenter(), fixed(100000));
+  } while (map.IsDirty());
+
+  TestHeights(map);
+
+  return exit_status();
+}
@@ -0,0 +1,221 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterRenderer.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Screen/Ramp.hpp"
+#include "Screen/RawBitmap.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "Operation/Operation.hpp"
+#include "Compatibility/path.h"
+#include "TestUtil.hpp"
+
+#include <string.h>
+
+static constexpr ColorRamp colors[NUM_COLOR_RAMP_LEVELS] = {
+  {0,           0x70, 0xc0, 0xa7},
+  {250,         0xca, 0xe7, 0xb9},
+  {500,         0xf4, 0xea, 0xaf},
+  {750,         0xdc, 0xb2, 0x82},
+  {1000,        0xca, 0x8e, 0x72},
+  {1250,        0xde, 0xc8, 0xbd},
+  {1500,        0xe3, 0xe4, 0xe9},
+  {1750,        0xdb, 0xd9, 0xef},
+  {2000,        0xce, 0xcd, 0xf5},
+  {2250,        0xc2, 0xc1, 0xfa},
+  {2500,        0xb7, 0xb9, 0xff},
+  {5000,        0xb7, 0xb9, 0xff},
+  {6000,        0xb7, 0xb9, 0xff}
+};
+
+static void
+Generate(RasterRenderer &renderer, const RasterMap &map,
+         const WindowProjection &projection, bool shading, bool contour)
+{
+  renderer.ColorTable(colors, true, 4, 5);
+  renderer.ScanMap(map, projection);
+  renderer.GenerateImage(shading, 4, 64, 128, Angle::Degrees(45), contour);
+}
+
+gcc_pure
+static bool
+SameImage(const RasterRenderer &a, const RasterRenderer &b)
+{
+  if (a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight())
+    return false;
+
+  for (unsigned y = 0; y < a.GetHeight(); ++y)
+    if (memcmp(a.GetImage().GetRow(y), b.GetImage().GetRow(y),
+               a.GetWidth() * sizeof(BGRColor)) != 0)
+      return false;
+
+  return true;
+}
+
+/**
+ * Shading the image in bands on a #WorkerPool must produce exactly
+ * the same image as the single-threaded row loop; this includes the
+ * contour lines, whose state is carried from one band to the next.
+ */
+static void
+TestParallel(const RasterMap &map, const WindowProjection &projection)
+{
+  for (unsigned i = 0; i < 4; ++i) {
+    const bool shading = i & 1, contour = i & 2;
+
+    RasterRenderer sequential;
+    Generate(sequential, map, projection, shading, contour);
+
+    for (unsigned n_threads = 1; n_threads <= 3; ++n_threads) {
+      WorkerPool pool(n_threads);
+      RasterRenderer parallel;
+      parallel.SetWorkerPool(&pool);
+      Generate(parallel, map, projection, shading, contour);
+
+      ok1(SameImage(sequential, parallel));
+    }
+  }
+}
+
+#ifndef ENABLE_OPENGL
+
+gcc_pure
+static bool
+SameHeights(const HeightMatrix &a, const HeightMatrix &b)
+{
+  return a.GetWidth() == b.GetWidth() && a.GetHeight() == b.GetHeight() &&
+    memcmp(a.GetData(), b.GetData(),
+           a.GetWidth() * a.GetHeight() * sizeof(*a.GetData())) == 0;
+}
+
+/**
+ * Pan the map by whole cells in all directions.  After each step,
+ * the scrolled height matrix and image must be exactly the same as a
+ * freshly generated one.
+ */
+static void
+TestScroll(const RasterMap &map, WindowProjection projection)
+{
+  static constexpr int steps[][2] = {
+    { 4, 0 }, { 0, -6 }, { -10, 8 }, { 2, 2 }, { -40, -30 }, { 0, 0 },
+  };
+
+  for (unsigned i = 0; i < 4; ++i) {
+    const bool shading = i & 1, contour = i & 2;
+
+    RasterRenderer scrolled;
+    Generate(scrolled, map, projection, shading, contour);
+
+    for (const auto &step : steps) {
+      const RasterPoint origin = projection.GetScreenOrigin();
+      projection.SetScreenOrigin(origin.x + step[0], origin.y + step[1]);
+      projection.UpdateScreenBounds();
+
+      ok1(scrolled.ScrollMap(map, projection));
+      scrolled.GenerateImage(shading, 4, 64, 128, Angle::Degrees(45),
+                             contour);
+
+      RasterRenderer fresh;
+      Generate(fresh, map, projection, shading, contour);
+
+      ok1(SameHeights(scrolled.GetHeightMatrix(), fresh.GetHeightMatrix()));
+      ok1(SameImage(scrolled, fresh));
+    }
+  }
+}
+
+#endif
+
+int main(int argc, char **argv)
+{
+#ifdef ENABLE_OPENGL
+  plan_tests(4 * 4 * 3);
+#else
+  plan_tests(4 * 4 * 3 + 2 * 2 * 4 * 6 * 3);
+#endif
+
+  NullOperationEnvironment operation;
+  RasterMap map(_T("test/data/benalla9.xcm") _T(DIR_SEPARATOR_S) _T("terrain.jp2"),
+                _T("test/data/benalla9.xcm") _T(DIR_SEPARATOR_S) _T("terrain.j2w"),
+                NULL, operation);
+  do {
+    map.SetViewCenter(map.GetMapCenter(), fixed(100000));
+  } while (map.IsDirty());
+
+  /* zoomed in, zoomed out, and partly outside of the map */
+  static constexpr struct {
+    double radius, longitude_offset, latitude_offset;
+  } views[] = {
+    { 3000, 0, 0 },
+    { 80000, 0, 0 },
+    { 80000, 1.8, 0 },
+    { 80000, 0, 1.2 },
+  };
+
+  for (const auto &view : views) {
+    GeoPoint center = map.GetMapCenter();
+    center.longitude += Angle::Degrees(view.longitude_offset);
+    center.latitude += Angle::Degrees(view.latitude_offset);
+
+    WindowProjection projection;
+    projection.SetScreenSize({321, 241});
+    projection.SetScaleFromRadius(fixed(view.radius));
+    projection.SetGeoLocation(center);
+    projection.SetScreenOrigin(160, 120);
+    projection.UpdateScreenBounds();
+
+    TestParallel(map, projection);
+  }
+
+#ifndef ENABLE_OPENGL
+  /* north up and rotated, inside the map and across its edge, where
+     the contour check skips whole runs of pixels */
+  static constexpr struct {
+    double radius, offset;
+  } scroll_views[] = {
+    { 10000, 0 },
+    { 80000, 0.9 },
+  };
+
+  for (const auto &view : scroll_views) {
+    GeoPoint center = map.GetMapCenter();
+    center.longitude += Angle::Degrees(view.offset);
+    center.latitude += Angle::Degrees(view.offset / 2);
+
+    for (unsigned angle = 0; angle < 60; angle += 30) {
+      WindowProjection projection;
+      projection.SetScreenSize({321, 241});
+      projection.SetScaleFromRadius(fixed(view.radius));
+      projection.SetGeoLocation(center);
+      projection.SetScreenOrigin(160, 120);
+      projection.SetScreenAngle(Angle::Degrees(angle));
+      projection.UpdateScreenBounds();
+
+      TestScroll(map, projection);
+    }
+  }
+#endif
+
+  return exit_status();
+}
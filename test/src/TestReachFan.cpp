@@ -0,0 +1,119 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Route/ReachFan.hpp"
+#include "Route/RoutePolars.hpp"
+#include "Route/Config.hpp"
+#include "Route/ReachResult.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "TestUtil.hpp"
+
+/**
+ * Count the test locations around the origin where the two reach
+ * trees disagree about being inside.
+ */
+static unsigned
+CountDifferences(const ReachFan &a, const ReachFan &b, const GeoPoint origin)
+{
+  unsigned n = 0;
+  for (unsigned bearing = 0; bearing < 360; bearing += 15) {
+    for (unsigned distance = 1000; distance <= 60000; distance += 1000) {
+      const GeoPoint p =
+        GeoVector(fixed(distance), Angle::Degrees(bearing)).EndPoint(origin);
+      if (a.IsInside(p) != b.IsInside(p))
+        ++n;
+    }
+  }
+
+  return n;
+}
+
+static bool
+SameArrival(const ReachFan &a, const ReachFan &b, const RoutePolars &rpolars,
+            const GeoPoint origin)
+{
+  for (unsigned bearing = 0; bearing < 360; bearing += 45) {
+    const AGeoPoint dest(GeoVector(fixed(10000), Angle::Degrees(bearing))
+                         .EndPoint(origin),
+                         RoughAltitude(0));
+
+    ReachResult ra, rb;
+    if (!a.FindPositiveArrival(dest, rpolars, ra) ||
+        !b.FindPositiveArrival(dest, rpolars, rb) ||
+        ra.direct != rb.direct ||
+        ra.terrain_valid != rb.terrain_valid ||
+        ra.terrain != rb.terrain)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * The turning reach calculated on a #WorkerPool must be exactly the
+ * same as the one calculated sequentially.
+ */
+static void
+TestParallel(const SpeedVector wind)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  const GlidePolar polar(fixed(1));
+
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+
+  RoutePolars rpolars;
+  rpolars.Initialise(settings, polar, wind);
+
+  const GeoPoint origin(Angle::Degrees(7), Angle::Degrees(45));
+  const AGeoPoint a0(origin, RoughAltitude(1500));
+  rpolars.SetConfig(config, a0.altitude);
+
+  ReachFan sequential;
+  ok1(sequential.Solve(a0, rpolars, NULL));
+
+  WorkerPool pool(2);
+  ReachFan parallel;
+  parallel.SetWorkerPool(&pool);
+  ok1(parallel.Solve(a0, rpolars, NULL));
+
+  ok1(CountDifferences(sequential, parallel, origin) == 0);
+  ok1(SameArrival(sequential, parallel, rpolars, origin));
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(2 * 4);
+
+  TestParallel(SpeedVector(Angle::Zero(), fixed(0)));
+  TestParallel(SpeedVector(Angle::Degrees(120), fixed(15)));
+
+  return exit_status();
+}
@@ -0,0 +1,113 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/SlopeShading.hpp"
+#include "Util/Clamp.hpp"
+#include "TestUtil.hpp"
+
+#include <math.h>
+#include <stdlib.h>
+
+static constexpr unsigned N = 1000;
+
+static short above[N], below[N], left[N], right[N];
+
+/**
+ * Fill the neighbour arrays with plausible terrain, steep cliffs and
+ * extreme values.
+ */
+static void
+FillHeights()
+{
+  for (unsigned i = 0; i < N; ++i) {
+    const short base = rand() % 3000;
+    above[i] = base + rand() % 200 - 100;
+    below[i] = base + rand() % 200 - 100;
+    left[i] = base + rand() % 200 - 100;
+    right[i] = base + rand() % 200 - 100;
+
+    if (i % 7 == 0)
+      above[i] = rand() % 9000;
+    if (i % 11 == 0)
+      right[i] = -32768;
+    if (i % 13 == 0)
+      below[i] = 32767;
+    if (i % 17 == 0)
+      left[i] = right[i];
+  }
+}
+
+/**
+ * Compare the batch version of SlopeShading::Calculate() with the
+ * single pixel version, for all neighbour distances which occur with
+ * the quantisation values accepted by #RasterRenderer.
+ */
+static bool
+TestLight(double azimuth, double elevation, int contrast)
+{
+  const int sx = (int)(255 * cos(elevation) * -sin(azimuth));
+  const int sy = (int)(255 * cos(elevation) * -cos(azimuth));
+  const int sz = (int)(255 * sin(elevation));
+
+  static short result[N];
+
+  bool equal = true;
+  for (unsigned q = 1; q <= 25; ++q) {
+    const unsigned height_slope_factor =
+      Clamp(unsigned(rand() % 1000), 1u, 8192u / (q * q));
+    const SlopeShading shading(sx, sy, sz, contrast, height_slope_factor);
+
+    /* p20 and p31 are smaller near the edges */
+    const unsigned p20 = 2 * q - rand() % q, p31 = 2 * q;
+
+    /* an odd length to exercise the portable remainder */
+    shading.Calculate(above, below, left, right, result, N - 3, p20, p31);
+
+    for (unsigned i = 0; i < N - 3; ++i)
+      if (result[i] != shading.Calculate(above[i], below[i],
+                                         left[i], right[i], p20, p31))
+        equal = false;
+  }
+
+  return equal;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(4);
+
+  FillHeights();
+
+  ok1(TestLight(0, M_PI / 4, 150));
+  ok1(TestLight(M_PI / 3, M_PI * 10 / 180, 255));
+  ok1(TestLight(M_PI * 5 / 4, M_PI / 2, 64));
+
+  bool equal = true;
+  for (unsigned i = 0; i < 50; ++i)
+    if (!TestLight(rand() * 2 * M_PI / RAND_MAX,
+                   (10 + rand() % 81) * M_PI / 180, rand() % 256))
+      equal = false;
+  ok1(equal);
+
+  return exit_status();
+}
@@ -0,0 +1,90 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "NMEA/ThermalBand.hpp"
+#include "TestUtil.hpp"
+
+static unsigned
+CountSamples(const ThermalBandInfo &band)
+{
+  unsigned n = 0;
+  for (unsigned i = 0; i < ThermalBandInfo::NUMTHERMALBUCKETS; ++i)
+    n += band.thermal_profile_n[i];
+  return n;
+}
+
+static void
+TestExpandEmpty()
+{
+  /* a cleared band has a zero ceiling; expanding it must not loop
+     forever */
+  ThermalBandInfo band;
+  band.Clear();
+  band.Add(fixed(1500), fixed(2));
+
+  ok1(band.max_thermal_height >= fixed(1500));
+  ok1(band.max_thermal_height < fixed(1501));
+  ok1(CountSamples(band) == 1);
+  ok1(band.thermal_profile_n[ThermalBandInfo::NUMTHERMALBUCKETS - 1] == 1);
+}
+
+static void
+TestExpandTiny()
+{
+  /* just above the terrain before takeoff, the ceiling is tiny */
+  ThermalBandInfo band;
+  band.Clear();
+  band.max_thermal_height = fixed(0.001);
+  band.Add(fixed(0.0005), fixed(0));
+  band.Add(fixed(800), fixed(1));
+
+  ok1(band.max_thermal_height >= fixed(800));
+  ok1(band.max_thermal_height < fixed(801));
+  ok1(CountSamples(band) == 2);
+  ok1(band.thermal_profile_n[0] == 1);
+}
+
+static void
+TestExpand()
+{
+  ThermalBandInfo band;
+  band.Clear();
+  band.max_thermal_height = fixed(1000);
+  for (unsigned i = 0; i < ThermalBandInfo::NUMTHERMALBUCKETS; ++i)
+    band.Add(fixed(i * 100 + 50), fixed(1));
+
+  /* the ceiling is raised in steps of the old bucket height */
+  band.Add(fixed(1450), fixed(1));
+  ok1(equals(band.max_thermal_height, 1500));
+  ok1(CountSamples(band) == ThermalBandInfo::NUMTHERMALBUCKETS + 1);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(10);
+
+  TestExpandEmpty();
+  TestExpandTiny();
+  TestExpand();
+
+  return exit_status();
+}
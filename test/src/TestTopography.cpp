@@ -0,0 +1,173 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Topography/TopographyStore.hpp"
+#include "Topography/TopographyFile.hpp"
+#include "Topography/XShape.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "IO/ZipLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "OS/Sleep.h"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <zzip/zzip.h>
+
+#include <string.h>
+
+/**
+ * The layers of test/data/benalla9.xcm, in the order of its
+ * topology.tpl.
+ */
+static constexpr struct {
+  const char *name;
+  double range;
+  int label_field;
+} layers[] = {
+  { "inwaterahydro_area.shp", 100, -1 },
+  { "watrcrslhydro_line.shp", 7, -1 },
+  { "builtupapop_area.shp", 15, 0 },
+  { "roadltrans_line.shp", 15, -1 },
+  { "railrdltrans_line.shp", 10, -1 },
+  { "mispopppop_point.shp", 5, 0 },
+};
+
+static constexpr unsigned NUM_STEPS = 20;
+
+static bool
+SameShape(const XShape &a, const XShape &b)
+{
+  if (a.get_type() != b.get_type() ||
+      a.get_number_of_lines() != b.get_number_of_lines() ||
+      memcmp(a.get_lines(), b.get_lines(),
+             a.get_number_of_lines() * sizeof(*a.get_lines())) != 0)
+    return false;
+
+  if (a.get_label() == NULL || b.get_label() == NULL)
+    return a.get_label() == b.get_label();
+
+  return _tcscmp(a.get_label(), b.get_label()) == 0;
+}
+
+/**
+ * Do both files contain the same shapes in the same order?
+ */
+static bool
+SameShapes(const TopographyFile &a, const TopographyFile &b)
+{
+  auto i = a.begin(), j = b.begin();
+  for (; i != a.end() && j != b.end(); ++i, ++j)
+    if (!SameShape(*i, *j))
+      return false;
+
+  return i == a.end() && j == b.end();
+}
+
+static bool
+IsEmpty(const TopographyFile &file)
+{
+  return file.begin() == file.end();
+}
+
+/**
+ * Call TopographyStore::ScanVisibility() until it reports that the
+ * background thread has finished and all shape lists are published.
+ */
+static bool
+WaitScanVisibility(TopographyStore &store, const WindowProjection &projection)
+{
+  for (unsigned i = 0; i < 10000; ++i) {
+    if (store.ScanVisibility(projection) == 0)
+      return true;
+
+    Sleep(1);
+  }
+
+  return false;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(NUM_STEPS * (1 + ARRAY_SIZE(layers)) + 3);
+
+  ZZIP_DIR *dir = zzip_dir_open("test/data/benalla9.xcm", NULL);
+  if (!ok1(dir != NULL))
+    return exit_status();
+
+  /* loaded in background by TopographyStore::ScanVisibility(), via
+     TopographyFile::LoadShapes() and PublishShapes() */
+  TopographyStore store;
+
+  {
+    ZipLineReaderA reader(dir, "topology.tpl");
+    NullOperationEnvironment operation;
+    store.Load(operation, reader, NULL, dir);
+  }
+
+  ok1(store.size() == ARRAY_SIZE(layers));
+
+  /* loaded synchronously with TopographyFile::Update() */
+  TopographyFile *files[ARRAY_SIZE(layers)];
+  for (unsigned i = 0; i < ARRAY_SIZE(layers); ++i) {
+    const fixed range(layers[i].range * 1000);
+    files[i] = new TopographyFile(dir, layers[i].name, range, range,
+                                  fixed(0), Color(0, 0, 0),
+                                  layers[i].label_field);
+  }
+
+  /* pan eastwards across Benalla; each step leaves the cached bounds
+     of some layers, but not of all */
+  WindowProjection projection;
+  projection.SetScreenSize({640, 480});
+  projection.SetScaleFromRadius(fixed(10000));
+  projection.SetScreenOrigin(320, 240);
+
+  bool found_shapes = false;
+  for (unsigned step = 0; step < NUM_STEPS; ++step) {
+    projection.SetGeoLocation(GeoPoint(Angle::Degrees(145.7 + step * 0.03),
+                                       Angle::Degrees(-36.55)));
+    projection.UpdateScreenBounds();
+
+    ok1(WaitScanVisibility(store, projection));
+
+    for (unsigned i = 0; i < ARRAY_SIZE(layers); ++i) {
+      files[i]->Update(projection);
+      found_shapes |= !IsEmpty(*files[i]);
+
+      if (i < store.size())
+        ok1(SameShapes(store[i], *files[i]));
+      else
+        ok1(false);
+    }
+  }
+
+  ok1(found_shapes);
+
+  for (auto *file : files)
+    delete file;
+
+  store.Reset();
+  zzip_dir_close(dir);
+
+  return exit_status();
+}
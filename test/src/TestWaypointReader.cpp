@@ -23,11 +23,12 @@
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
-#include "Terrain/RasterMap.hpp"
+#include "Terrain/RasterTerrain.hpp"
 #include "Units/System.hpp"
 #include "TestUtil.hpp"
 #include "Util/tstring.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #include <vector>
 
@@ -525,11 +526,110 @@ CreateOriginalWaypoints()
   return org_wp;
 }
 
+static void
+ParseWaypointFile(const TCHAR *filename, Waypoints &way_points,
+                  WorkerPool *worker_pool)
+{
+  WaypointReader f(filename, 0);
+  f.SetWorkerPool(worker_pool);
+
+  NullOperationEnvironment operation;
+  f.Parse(way_points, operation);
+  way_points.Optimise();
+}
+
+/**
+ * Parse the file sequentially and in parallel, and verify that the
+ * same waypoints are created in the same order.
+ */
+static void
+TestParallel(const TCHAR *filename)
+{
+  Waypoints sequential, parallel;
+  ParseWaypointFile(filename, sequential, nullptr);
+
+  WorkerPool worker_pool(2);
+  ParseWaypointFile(filename, parallel, &worker_pool);
+
+  ok1(!parallel.IsEmpty() && parallel.size() == sequential.size());
+
+  bool equal = true;
+  for (unsigned id = 1; id <= sequential.size(); ++id) {
+    const Waypoint *a = sequential.LookupId(id);
+    const Waypoint *b = parallel.LookupId(id);
+    if (a == NULL || b == NULL || a->name != b->name ||
+        a->location != b->location || a->elevation != b->elevation)
+      equal = false;
+  }
+
+  ok1(equal);
+}
+
+/**
+ * Parse a file where most waypoints have no elevation.  These are
+ * looked up in the terrain in one batch after parsing; each must get
+ * the same elevation as a lookup of its own, and the others must
+ * keep the elevation from the file.
+ */
+static void
+TestLookupElevations(const TCHAR *filename, const RasterTerrain &terrain,
+                     WorkerPool *worker_pool)
+{
+  /* without terrain, the waypoints without elevation are dropped */
+  Waypoints with_elevation;
+  ParseWaypointFile(filename, with_elevation, worker_pool);
+
+  Waypoints way_points;
+  {
+    WaypointReader f(filename, 0);
+    f.SetTerrain(&terrain);
+    f.SetWorkerPool(worker_pool);
+
+    NullOperationEnvironment operation;
+    ok1(f.Parse(way_points, operation));
+    way_points.Optimise();
+  }
+
+  ok1(!with_elevation.IsEmpty() &&
+      way_points.size() > with_elevation.size());
+
+  bool equal = true;
+  unsigned n_valid = 0, n_special = 0;
+  for (unsigned id = 1; id <= way_points.size(); ++id) {
+    const Waypoint *wp = way_points.LookupId(id);
+    if (wp == NULL) {
+      equal = false;
+      continue;
+    }
+
+    fixed expected;
+    const Waypoint *original = with_elevation.LookupName(wp->name);
+    if (original != NULL)
+      expected = original->elevation;
+    else {
+      const short h = terrain.GetTerrainHeight(wp->location);
+      if (RasterBuffer::IsSpecial(h)) {
+        expected = fixed(0);
+        ++n_special;
+      } else {
+        expected = fixed(h);
+        ++n_valid;
+      }
+    }
+
+    if (wp->elevation != expected)
+      equal = false;
+  }
+
+  ok1(n_valid > 0 && n_special > 0);
+  ok1(equal);
+}
+
 int main(int argc, char **argv)
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(315);
+  plan_tests(319 + 2 * 4);
 
   TestExtractParameters();
 
@@ -542,5 +642,17 @@ int main(int argc, char **argv)
   TestCompeGPS(org_wp);
   TestCompeGPS_UTM(org_wp);
 
+  TestParallel(_T("test/data/waypoints.dat"));
+  TestParallel(_T("test/data/waypoints.cup"));
+
+  NullOperationEnvironment operation;
+  const RasterTerrain terrain(_T(""), NULL, NULL, operation);
+  TestLookupElevations(_T("test/data/waypoints_no_elevation.dat"), terrain,
+                       nullptr);
+
+  WorkerPool worker_pool(2);
+  TestLookupElevations(_T("test/data/waypoints_no_elevation.dat"), terrain,
+                       &worker_pool);
+
   return exit_status();
 }
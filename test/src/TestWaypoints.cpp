@@ -300,7 +300,7 @@ main(int argc, char** argv)
   if (!ParseArgs(argc, argv))
     return 0;
 
-  plan_tests(52);
+  plan_tests(54);
 
   Waypoints waypoints;
   GeoPoint center(Angle::Degrees(51.4), Angle::Degrees(7.85));
@@ -326,6 +326,12 @@ main(int argc, char** argv)
   waypoints.Clear();
   ok1(waypoints.IsEmpty());
   ok1(waypoints.size() == 0);
+  ok1(waypoints.LookupId(1) == NULL);
+
+  // ids are allocated from 1 again
+  AddSpiralWaypoints(waypoints, center);
+  ok1(waypoints.LookupId(1) != NULL &&
+      waypoints.LookupId(1)->original_id == 0);
 
   return exit_status();
 }
@@ -0,0 +1,71 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2013 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "Thread/WorkerPool.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+
+static void
+TestPool(WorkerPool &pool, unsigned n)
+{
+  std::atomic<unsigned> count(0);
+  unsigned *results = new unsigned[n];
+  std::fill(results, results + n, 0u);
+
+  pool.Run(n, [&](unsigned i) {
+      ++count;
+      results[i] += i * 3;
+    });
+
+  ok1(count.load() == n);
+
+  bool all_once = true;
+  for (unsigned i = 0; i < n; ++i)
+    if (results[i] != i * 3)
+      all_once = false;
+
+  ok1(all_once);
+
+  delete[] results;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(12);
+
+  WorkerPool sequential(0);
+  ok1(sequential.GetThreadCount() == 0);
+  TestPool(sequential, 0);
+  TestPool(sequential, 17);
+
+  WorkerPool parallel(3);
+  ok1(parallel.GetThreadCount() == 3);
+  TestPool(parallel, 1);
+  TestPool(parallel, 1000);
+
+  /* the pool must be reusable for consecutive batches */
+  TestPool(parallel, 5);
+
+  return exit_status();
+}
@@ -51,9 +51,74 @@ ZeroFinderTest::f(const fixed x)
   return fixed(0);
 }
 
+/**
+ * A function with its zero (or its minimum) at #offset, which a test
+ * moves between searches.
+ */
+class ShiftedZeroFinder: public ZeroFinder
+{
+  const fixed offset;
+  const bool min;
+
+public:
+  unsigned evaluations;
+
+  ShiftedZeroFinder(fixed _offset, bool _min) :
+    ZeroFinder(fixed(0), fixed(10), fixed(0.0001)),
+    offset(_offset), min(_min), evaluations(0) {}
+
+  fixed f(const fixed x);
+
+  fixed Search() {
+    return min ? find_min(fixed(5)) : find_zero(fixed(5));
+  }
+};
+
+fixed
+ShiftedZeroFinder::f(const fixed x)
+{
+  ++evaluations;
+
+  if (min)
+    return exp(x - offset) - (x - offset);
+
+  return pow(fixed(2), x - offset) - fixed(1);
+}
+
+static void
+TestWarmStart(bool min)
+{
+  ZeroFinder::Cache cache;
+  unsigned cold_evaluations = 0;
+  bool accurate = true;
+
+  for (unsigned i = 0; i < 20; ++i) {
+    const fixed offset = fixed(3) + fixed(i) / 20;
+
+    ShiftedZeroFinder cold(offset, min);
+    accurate &= fabs(cold.Search() - offset) < fixed(0.001);
+    cold_evaluations += cold.evaluations;
+
+    ShiftedZeroFinder warm(offset, min);
+    warm.SetCache(cache);
+    accurate &= fabs(warm.Search() - offset) < fixed(0.001);
+  }
+
+  ok1(accurate);
+  ok1(cache.searches == 20);
+  ok1(cache.warm_starts == 19);
+  ok1(cache.evaluations < cold_evaluations);
+
+  // a jump outside the warm bracket falls back to the full search
+  ShiftedZeroFinder jump(fixed(8), min);
+  jump.SetCache(cache);
+  ok1(fabs(jump.Search() - fixed(8)) < fixed(0.001));
+  ok1(cache.warm_starts == 19);
+}
+
 int main(int argc, char **argv)
 {
-  plan_tests(18);
+  plan_tests(30);
 
   ZeroFinderTest zf(fixed(-100), fixed(100), 0);
   ok1(equals(zf.find_zero(fixed(-150)), fixed(-1)));
@@ -84,5 +149,8 @@ int main(int argc, char **argv)
   ok1(equals(zf4.find_min(fixed(1)), fixed_pi));
   ok1(equals(zf4.find_min(fixed(140)), fixed_pi));
 
+  TestWarmStart(false);
+  TestWarmStart(true);
+
   return exit_status();
 }